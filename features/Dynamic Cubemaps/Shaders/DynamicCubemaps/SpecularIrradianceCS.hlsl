@@ -5,66 +5,24 @@
 // Part of specular IBL split-sum approximation.
 
 static const float PI = 3.141592;
-static const float TwoPI = 2 * PI;
 static const float Epsilon = 0.00001;
 
 static const uint NumSamples = 16;
-static const float InvNumSamples = 1.0 / float(NumSamples);
 
 cbuffer SpecularMapFilterSettings : register(b0)
 {
-	float roughness;
+	uint faceOffset;  // first face of this dispatch, the work is spread over several frames
+	uint sampleMip;   // mip level of the samples to use in FilterSamples
 };
 
 TextureCube inputTexture : register(t0);
+// GGX importance samples precomputed on the CPU per mip level,
+// tangent space half vector in xyz and half of log2 of the sample solid angle in w
+StructuredBuffer<float4> FilterSamples : register(t1);
 RWTexture2DArray<float4> outputTexture : register(u0);
 
 SamplerState linear_wrap_sampler : register(s0);
 
-// Compute Van der Corput radical inverse
-// See: http://holger.dammertz.org/stuff/notes_HammersleyOnHemisphere.html
-float radicalInverse_VdC(uint bits)
-{
-	bits = (bits << 16u) | (bits >> 16u);
-	bits = ((bits & 0x55555555u) << 1u) | ((bits & 0xAAAAAAAAu) >> 1u);
-	bits = ((bits & 0x33333333u) << 2u) | ((bits & 0xCCCCCCCCu) >> 2u);
-	bits = ((bits & 0x0F0F0F0Fu) << 4u) | ((bits & 0xF0F0F0F0u) >> 4u);
-	bits = ((bits & 0x00FF00FFu) << 8u) | ((bits & 0xFF00FF00u) >> 8u);
-	return float(bits) * 2.3283064365386963e-10;  // / 0x100000000
-}
-
-// Sample i-th point from Hammersley point set of NumSamples points total.
-float2 sampleHammersley(uint i)
-{
-	return float2(i * InvNumSamples, radicalInverse_VdC(i));
-}
-
-// Importance sample GGX normal distribution function for a fixed roughness value.
-// This returns normalized half-vector between Li & Lo.
-// For derivation see: http://blog.tobias-franke.eu/2014/03/30/notes_on_importance_sampling.html
-float3 sampleGGX(float u1, float u2, float roughness)
-{
-	float alpha = roughness * roughness;
-
-	float cosTheta = sqrt((1.0 - u2) / (1.0 + (alpha * alpha - 1.0) * u2));
-	float sinTheta = sqrt(1.0 - cosTheta * cosTheta);  // Trig. identity
-	float phi = TwoPI * u1;
-
-	// Convert to Cartesian upon return.
-	return float3(sinTheta * cos(phi), sinTheta * sin(phi), cosTheta);
-}
-
-// GGX/Towbridge-Reitz normal distribution function.
-// Uses Disney's reparametrization of alpha = roughness^2.
-float ndfGGX(float cosLh, float roughness)
-{
-	float alpha = roughness * roughness;
-	float alphaSq = alpha * alpha;
-
-	float denom = (cosLh * cosLh) * (alphaSq - 1.0) + 1.0;
-	return alphaSq / (PI * denom * denom);
-}
-
 // Calculate normalized sampling direction vector based on current fragment coordinates.
 // This is essentially "inverse-sampling": we reconstruct what the sampling vector would be if we wanted it to "hit"
 // this particular fragment in a cubemap.
@@ -146,6 +104,7 @@ float3 Lin2sRGB(float3 color)
 	float wt = 4.0 * PI / (6 * inputWidth * inputHeight);
 
 	// Approximation: Assume zero viewing angle (isotropic reflections).
+	ThreadID.z += faceOffset;
 	float3 N = getSamplingVector(ThreadID);
 	float3 Lo = N;
 
@@ -158,8 +117,8 @@ float3 Lin2sRGB(float3 color)
 	// Convolve environment map using GGX NDF importance sampling.
 	// Weight by cosine term since Epic claims it generally improves quality.
 	for (uint i = 0; i < NumSamples; ++i) {
-		float2 u = sampleHammersley(i);
-		float3 Lh = tangentToWorld(sampleGGX(u.x, u.y, roughness), N, S, T);
+		float4 filterSample = FilterSamples[sampleMip * NumSamples + i];
+		float3 Lh = tangentToWorld(filterSample.xyz, N, S, T);
 
 		// Compute incident direction (Li) by reflecting viewing direction (Lo) around half-vector (Lh).
 		float3 Li = 2.0 * dot(Lo, Lh) * Lh - Lo;
@@ -168,18 +127,8 @@ float3 Lin2sRGB(float3 color)
 		if (cosLi > 0.0) {
 			// Use Mipmap Filtered Importance Sampling to improve convergence.
 			// See: https://developer.nvidia.com/gpugems/GPUGems3/gpugems3_ch20.html, section 20.4
-
-			float cosLh = max(dot(N, Lh), 0.0);
-
-			// GGX normal distribution function (D term) probability density function.
-			// Scaling by 1/4 is due to change of density in terms of Lh to Li (and since N=V, rest of the scaling factor cancels out).
-			float pdf = ndfGGX(cosLh, roughness) * 0.25;
-
-			// Solid angle associated with this sample.
-			float ws = 1.0 / (NumSamples * pdf);
-
-			// Mip level to sample from.
-			float mipLevel = max(0.5 * log2(ws / wt) + 1.0, 0.0);
+			// The sample solid angle only depends on roughness, so it is part of the precomputed samples.
+			float mipLevel = max(filterSample.w - 0.5 * log2(wt) + 1.0, 0.0);
 
 			color += sRGB2Lin(inputTexture.SampleLevel(linear_wrap_sampler, Li, mipLevel).rgb) * cosLi;
 			weight += cosLi;
@@ -2,6 +2,7 @@
 cbuffer GrassCollisionPerFrame : register(b5)
 {
 	float4 boundCentre[2];
+	float4 gridOrigin[2];  // xy eye relative origin, z cell size
 	float boundRadius;
 	bool EnableGrassCollision;
 	float RadiusMultiplier;
@@ -15,7 +16,11 @@ struct StructuredCollision
 	float radius;
 };
 
+static const uint GridSize = 16;  // must match CollisionGrid::GRID_SIZE
+
 StructuredBuffer<StructuredCollision> collisions : register(t0);
+StructuredBuffer<uint2> gridCells : register(t1);  // offset and count into gridIndices
+StructuredBuffer<uint> gridIndices : register(t2);
 
 float3 GetDisplacedPosition(float3 position, float alpha, uint eyeIndex = 0)
 {
@@ -31,10 +36,14 @@ float3 GetDisplacedPosition(float3 position, float alpha, uint eyeIndex = 0)
 	}
 
 	if (EnableGrassCollision) {
-		uint counter = 0;
-		uint collision_count, dummy;
-		collisions.GetDimensions(collision_count, dummy);
-		for (uint collision_index = 0; collision_index < collision_count; collision_index++) {
+		// only the collisions overlapping this vertex's grid cell can reach it
+		int2 cell = floor((worldPosition.xy - gridOrigin[eyeIndex].xy) / gridOrigin[eyeIndex].z);
+		uint2 range = 0;
+		if (all(cell >= 0) && all(cell < (int)GridSize)) {
+			range = gridCells[cell.y * GridSize + cell.x];
+		}
+		for (uint grid_index = range.x; grid_index < range.x + range.y; grid_index++) {
+			uint collision_index = gridIndices[grid_index];
 			StructuredCollision collision = collisions[collision_index];
 
 			float dist = distance(collision.centre[eyeIndex], worldPosition);
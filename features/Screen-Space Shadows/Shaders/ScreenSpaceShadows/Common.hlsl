@@ -18,6 +18,12 @@ cbuffer PerFrame : register(b0)
 	float BlurRadius;
 	float BlurDropoff;
 	bool Enabled;
+	uint RaymarchScale;         // traced pixels are 1 in RaymarchScale x RaymarchScale
+	bool TemporalAccumulation;
+	uint FusedFilter;                // only read on the CPU, keeps the layout of Settings
+	float4x4 ReprojectionMatrix[2];  // current view space to previous frame clip space
+	uint2 Jitter;                    // pixel of each RaymarchScale block traced this frame
+	float HistoryWeight;             // 0 when the history is discarded
 };
 RWTexture2D<float> OcclusionRW : register(u0);
 
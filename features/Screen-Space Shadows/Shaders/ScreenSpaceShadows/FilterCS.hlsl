@@ -61,31 +61,85 @@ static const float2 BlurOffsets[cKernelSize] = {
 	float2(6.0f, 6.0f)
 };
 
-float FilterCS(uint3 DTid, float2 TexCoord, float startDepth, uint a_eyeIndex = 0)
+#if defined(FUSED)
+#	define TILE_SIZE 16
+// Half resolution rows reached by the vertical kernel at the largest blur radius, plus one for the bilinear footprint
+#	define APRON 4
+
+// Horizontally filtered rows of the tile and its vertical apron
+groupshared float HorizontalTile[TILE_SIZE + APRON * 2][TILE_SIZE];
+#endif
+
+// Depth-aware upsample of the reduced resolution raymarch, weighting the four nearest traced pixels by their depth similarity
+float UpsampleOcclusion(float2 uv, float depth, float depthDrop, uint a_eyeIndex = 0)
+{
+	float2 lowPos = (uv * BufferDim - Jitter - 0.5) / RaymarchScale;
+	int2 basePos = (int2)floor(lowPos);
+	float2 blend = lowPos - basePos;
+
+	float occlusion = 0;
+	float weightSum = 0;
+	[unroll] for (int y = 0; y < 2; y++)
+	{
+		[unroll] for (int x = 0; x < 2; x++)
+		{
+			int2 lowPixel = max(basePos + int2(x, y), 0);
+			float2 sampleUV = (lowPixel * RaymarchScale + Jitter + 0.5) * RcpBufferDim;
+			float sampleDepth = InverseProjectUV(sampleUV, a_eyeIndex).z;
+
+			float weight = (x ? blend.x : 1 - blend.x) * (y ? blend.y : 1 - blend.y);
+			weight *= saturate(depthDrop - abs(depth - sampleDepth)) + 1e-3;
+
+			occlusion += OcclusionTexture.Load(int3(lowPixel, 0)).r * weight;
+			weightSum += weight;
+		}
+	}
+	return occlusion / weightSum;
+}
+
+// Bilinear fetch of the raymarch for a screen uv, the traced pixels sit in the top left 1 / RaymarchScale of the texture
+float SampleOcclusion(float2 uv)
 {
-#if defined(HORIZONTAL)
-	float2 OffsetMask = float2(1.0f, 0.0f);
-#elif defined(VERTICAL)
-	float2 OffsetMask = float2(0.0f, 1.0f);
+	return OcclusionTexture.SampleLevel(LinearSampler, (uv - (Jitter + 0.5 - RaymarchScale * 0.5) * RcpBufferDim) / RaymarchScale, 0).r;
+}
+
+// Input of the vertical axis: the horizontally filtered half resolution result
+float SampleHorizontal(float2 uv, int2 a_tileOrigin)
+{
+#if defined(FUSED)
+	// Same bilinear footprint as sampling the intermediate texture, the apron rows are already clamped to its edges
+	float rowPos = uv.y * BufferDim.y - 0.5 - (a_tileOrigin.y - APRON);
+	int row = clamp((int)floor(rowPos), 0, TILE_SIZE + APRON * 2 - 2);
+	uint column = (uint)(uv.x * BufferDim.x) - a_tileOrigin.x;
+	return lerp(HorizontalTile[row][column], HorizontalTile[row + 1][column], saturate(rowPos - row));
 #else
-#	error "Must define an axis!"
+	return OcclusionTexture.SampleLevel(LinearSampler, uv * 2, 0).r;
 #endif
+}
+
+float FilterCS(float2 TexCoord, float startDepth, bool horizontal, int2 a_tileOrigin = 0, uint a_eyeIndex = 0)
+{
+	float2 OffsetMask = horizontal ? float2(1.0f, 0.0f) : float2(0.0f, 1.0f);
 
 	float WeightSum = 0.114725602f;
-	float color1 = OcclusionTexture.SampleLevel(LinearSampler, TexCoord * 2, 0).r * WeightSum;
 
 	float depth1 = InverseProjectUVZ(TexCoord, startDepth, a_eyeIndex).z;
 
 	float depthDrop = depth1 * BlurDropoff;
 
+	float color1;
+	if (!horizontal)
+		color1 = SampleHorizontal(TexCoord, a_tileOrigin);
+	else if (RaymarchScale > 1)
+		color1 = UpsampleOcclusion(TexCoord * 2, depth1, depthDrop, a_eyeIndex);
+	else
+		color1 = OcclusionTexture.SampleLevel(LinearSampler, TexCoord * 2, 0).r;
+	color1 *= WeightSum;
+
 	[unroll] for (int i = 0; i < cKernelSize; i++)
 	{
-#if defined(HORIZONTAL)
-		float2 uv = TexCoord + (BlurOffsets[i] * OffsetMask * RcpBufferDim) * BlurRadius;
-#elif defined(VERTICAL)
-		float2 uv = TexCoord + (BlurOffsets[i] * OffsetMask * RcpBufferDim / 2) * BlurRadius;
-#endif
-		float4 color2 = OcclusionTexture.SampleLevel(LinearSampler, uv * 2, 0).r;
+		float2 uv = TexCoord + (BlurOffsets[i] * OffsetMask * RcpBufferDim * (horizontal ? 1.0f : 0.5f)) * BlurRadius;
+		float color2 = horizontal ? SampleOcclusion(uv * 2) : SampleHorizontal(uv, a_tileOrigin);
 		float depth2 = InverseProjectUV(uv * 2, a_eyeIndex).z;
 
 		// Depth-awareness
@@ -98,19 +152,59 @@ float FilterCS(uint3 DTid, float2 TexCoord, float startDepth, uint a_eyeIndex =
 	return color1;
 }
 
+#if defined(FUSED)
+// Both axes in one pass: the horizontal filter of the tile and its apron goes through group shared memory instead of an intermediate texture
+[numthreads(TILE_SIZE, TILE_SIZE, 1)] void main(uint3 DTid  // [pixels]
+												: SV_DispatchThreadID, uint3 GTid
+												: SV_GroupThreadID, uint3 Gid
+												: SV_GroupID) {
+	int2 tileOrigin = Gid.xy * TILE_SIZE;
+	int halfHeight = (int)(BufferDim.y * 0.5);
+
+#	ifdef VR
+	uint eyeIndex = (DTid.x * RcpBufferDim.x >= 0.5) ? 1 : 0;
+#	else
+	uint eyeIndex = 0;
+#	endif  // VR
+
+	for (uint row = GTid.y; row < TILE_SIZE + APRON * 2; row += TILE_SIZE) {
+		int2 pixel = int2(DTid.x, clamp(tileOrigin.y - APRON + (int)row, 0, halfHeight - 1));
+		float2 rowCoord = (pixel + 0.5) * RcpBufferDim;
+		float rowDepth = GetDepth(rowCoord * 2);
+		HorizontalTile[row][GTid.x] = rowDepth < 1 ? FilterCS(rowCoord, rowDepth, true, tileOrigin, eyeIndex) : 1;
+	}
+
+	GroupMemoryBarrierWithGroupSync();
+
+	float2 TexCoord = (DTid.xy + 0.5) * RcpBufferDim;  // convert to [0,1]
+
+	float startDepth = GetDepth(TexCoord * 2);
+	if (startDepth >= 1)
+		return;
+
+	OcclusionRW[DTid.xy] = FilterCS(TexCoord, startDepth, false, tileOrigin, eyeIndex);
+}
+#else
 [numthreads(32, 32, 1)] void main(uint3 DTid  // [pixels]
 								  : SV_DispatchThreadID) {
 	float2 TexCoord = (DTid.xy + 0.5) * RcpBufferDim;  // convert to [0,1]
 
-#ifdef VR
+#	ifdef VR
 	uint eyeIndex = (DTid.x * RcpBufferDim.x >= 0.5) ? 1 : 0;
-#else
+#	else
 	uint eyeIndex = 0;
-#endif  // VR
+#	endif  // VR
 
 	float startDepth = GetDepth(TexCoord * 2);
 	if (startDepth >= 1)
 		return;
 
-	OcclusionRW[DTid.xy] = FilterCS(DTid, TexCoord, startDepth, eyeIndex);
-}
\ No newline at end of file
+#	if defined(HORIZONTAL)
+	OcclusionRW[DTid.xy] = FilterCS(TexCoord, startDepth, true, 0, eyeIndex);
+#	elif defined(VERTICAL)
+	OcclusionRW[DTid.xy] = FilterCS(TexCoord, startDepth, false, 0, eyeIndex);
+#	else
+#		error "Must define an axis!"
+#	endif
+}
+#endif
@@ -89,7 +89,8 @@ float ScreenSpaceShadowsUV(float2 texcoord, float3 lightDirectionVS, uint a_eyeI
 
 [numthreads(32, 32, 1)] void main(uint3 DTid
 								  : SV_DispatchThreadID) {
-	float2 TexCoord = (DTid.xy + 0.5) * RcpBufferDim * DynamicRes.zw;
+	// At reduced resolution every thread traces one jittered pixel of its block, the filter upsamples the result
+	float2 TexCoord = (DTid.xy * RaymarchScale + Jitter + 0.5) * RcpBufferDim * DynamicRes.zw;
 
 #ifdef VR
 	uint eyeIndex = (TexCoord.x >= 0.5) ? 1 : 0;
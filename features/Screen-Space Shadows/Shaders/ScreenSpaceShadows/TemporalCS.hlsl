@@ -0,0 +1,48 @@
+#include "Common.hlsl"
+Texture2D<float> OcclusionTexture : register(t1);
+Texture2D<float> HistoryTexture : register(t2);
+
+// Blends the filtered shadows with the reprojected result of the previous frames, both stored in the top left quarter of their textures
+[numthreads(32, 32, 1)] void main(uint3 DTid  // [pixels]
+								  : SV_DispatchThreadID) {
+	float2 TexCoord = (DTid.xy + 0.5) * RcpBufferDim;  // convert to [0,1]
+
+#ifdef VR
+	uint eyeIndex = (DTid.x * RcpBufferDim.x >= 0.5) ? 1 : 0;
+#else
+	uint eyeIndex = 0;
+#endif  // VR
+
+	float occlusion = OcclusionTexture[DTid.xy];
+
+	float startDepth = GetDepth(TexCoord * 2);
+	if (startDepth >= 1 || HistoryWeight <= 0) {
+		OcclusionRW[DTid.xy] = occlusion;
+		return;
+	}
+
+	float3 positionVS = InverseProjectUVZ(TexCoord * 2, startDepth, eyeIndex);
+	float4 previousCS = mul(ReprojectionMatrix[eyeIndex], float4(positionVS, 1));
+	float2 previousUV = previousCS.xy / previousCS.w * float2(0.5, -0.5) + 0.5;
+
+	if (!IsSaturated(previousUV)) {
+		OcclusionRW[DTid.xy] = occlusion;
+		return;
+	}
+
+	// Clamp the history to the current neighbourhood to limit ghosting from disocclusion
+	float minOcclusion = occlusion;
+	float maxOcclusion = occlusion;
+	[unroll] for (int y = -1; y <= 1; y++)
+	{
+		[unroll] for (int x = -1; x <= 1; x++)
+		{
+			float neighbour = OcclusionTexture[clamp((int2)DTid.xy + int2(x, y), 0, (int2)(BufferDim * 0.5) - 1)];
+			minOcclusion = min(minOcclusion, neighbour);
+			maxOcclusion = max(maxOcclusion, neighbour);
+		}
+	}
+
+	float history = clamp(HistoryTexture.SampleLevel(LinearSampler, previousUV * 0.5, 0), minOcclusion, maxOcclusion);
+	OcclusionRW[DTid.xy] = lerp(occlusion, history, HistoryWeight);
+}
@@ -0,0 +1,56 @@
+#include "BenchmarkSuite.h"
+
+#include <cstdio>
+
+void BenchmarkSuite::Add(std::string a_name, std::function<void()> a_function)
+{
+	cases.push_back({ std::move(a_name), std::move(a_function) });
+}
+
+std::vector<BenchmarkSuite::Result> BenchmarkSuite::Run(std::chrono::nanoseconds a_minTime) const
+{
+	using Clock = std::chrono::steady_clock;
+	std::vector<Result> results;
+	for (auto& benchmark : cases) {
+		// double the batch until a single batch is long enough to time reliably
+		std::uint64_t iterations = 1;
+		while (true) {
+			auto start = Clock::now();
+			for (std::uint64_t i = 0; i < iterations; i++)
+				benchmark.function();
+			auto elapsed = Clock::now() - start;
+			if (elapsed >= a_minTime || iterations >= (1ull << 30)) {
+				results.push_back({ benchmark.name, iterations, std::chrono::duration<double, std::nano>(elapsed).count() / (double)iterations });
+				break;
+			}
+			iterations *= 2;
+		}
+	}
+	return results;
+}
+
+std::string BenchmarkSuite::ToJson(const std::vector<Result>& a_results, std::string_view a_version)
+{
+	auto escape = [](std::string_view a_text) {
+		std::string result;
+		for (auto c : a_text) {
+			if (c == '"' || c == '\\')
+				result += '\\';
+			result += c;
+		}
+		return result;
+	};
+
+	auto timestamp = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+
+	std::string json = "{\n  \"context\": {\n    \"timestamp\": " + std::to_string(timestamp) + ",\n    \"version\": \"" + escape(a_version) + "\"\n  },\n  \"benchmarks\": [";
+	for (size_t i = 0; i < a_results.size(); i++) {
+		auto& result = a_results[i];
+		char time[64]{};
+		std::snprintf(time, sizeof(time), "%.3f", result.nanoseconds);
+		json += std::string(i ? "," : "") + "\n    {\n      \"name\": \"" + escape(result.name) + "\",\n      \"iterations\": " + std::to_string(result.iterations) +
+		        ",\n      \"real_time\": " + time + ",\n      \"time_unit\": \"ns\"\n    }";
+	}
+	json += "\n  ]\n}\n";
+	return json;
+}
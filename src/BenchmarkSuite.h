@@ -0,0 +1,53 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#	include <intrin.h>
+#endif
+
+// Minimal microbenchmark runner, each case is repeated until it ran for the minimum time and reported in the google-benchmark JSON layout.
+// tests/CommunityShadersBench runs the cases that need no game data on the build machine.
+class BenchmarkSuite
+{
+public:
+	struct Result
+	{
+		std::string name;
+		std::uint64_t iterations = 0;
+		double nanoseconds = 0;  // per iteration
+	};
+
+	void Add(std::string a_name, std::function<void()> a_function);
+	std::vector<Result> Run(std::chrono::nanoseconds a_minTime = std::chrono::milliseconds(100)) const;
+
+	static std::string ToJson(const std::vector<Result>& a_results, std::string_view a_version);
+
+	// Keeps the compiler from optimizing away a result that is otherwise unused: the value has to be in memory at this
+	// point and may be read from there, so the work producing it cannot be dropped or moved out of the timed loop
+	template <class T>
+	static void DoNotOptimize(const T& a_value)
+	{
+#if defined(_MSC_VER) && !defined(__clang__)
+		sink = &reinterpret_cast<const volatile char&>(a_value);
+		_ReadWriteBarrier();
+#else
+		asm volatile("" : : "m"(a_value) : "memory");
+#endif
+	}
+
+private:
+	struct Case
+	{
+		std::string name;
+		std::function<void()> function;
+	};
+
+	std::vector<Case> cases;
+	static inline const volatile char* volatile sink = nullptr;
+};
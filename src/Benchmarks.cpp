@@ -0,0 +1,65 @@
+#include "Benchmarks.h"
+
+#include "BenchmarkSuite.h"
+#include "Features/LightLimitFIx/ParticleLights.h"
+#include "ModelBenchmarks.h"
+#include "ShaderCache.h"
+#include "State.h"
+
+namespace Benchmarks
+{
+	static constexpr const char* OutputPath = "Data\\SKSE\\Plugins\\CommunityShaders\\Benchmarks.json";
+
+	void Run()
+	{
+		BenchmarkSuite suite;
+		auto state = State::GetSingleton();
+
+		// shader lookups need a shader the game has drawn with
+		if (auto shader = state->currentShader) {
+			SIE::ShaderCompilationTask task{ SIE::ShaderClass::Pixel, *shader, state->currentPixelDescriptor };
+			suite.Add("ShaderCache/TaskKey", [task] { BenchmarkSuite::DoNotOptimize(task.GetString()); });
+			suite.Add("ShaderCache/TaskId", [task] { BenchmarkSuite::DoNotOptimize(task.GetId()); });
+
+			auto vertexDescriptor = state->currentVertexDescriptor;
+			auto pixelDescriptor = state->currentPixelDescriptor;
+			suite.Add("State/ModifyShaderLookup", [=] {
+				auto vertex = vertexDescriptor;
+				auto pixel = pixelDescriptor;
+				state->ModifyShaderLookup(*shader, vertex, pixel);
+				BenchmarkSuite::DoNotOptimize(pixel);
+			});
+
+			auto path = std::format(L"Data/Shaders/{}.hlsl", std::wstring(shader->fxpFilename, shader->fxpFilename + strlen(shader->fxpFilename)));
+			if (auto source = SIE::ShaderCache::Instance().sourceCache.Get(path)) {
+				suite.Add("ShaderSourceGroups/HashSource", [source] { BenchmarkSuite::DoNotOptimize(ShaderSourceGroups::HashSource("ps_5_0", *source)); });
+			}
+		}
+
+		// texture paths as the effect materials reference them, alternating with misses
+		std::vector<std::string> texturePaths;
+		for (auto& [stem, config] : ParticleLights::GetSingleton()->particleLightConfigs) {
+			texturePaths.push_back(std::format("Effects\\{}.dds", stem));
+			texturePaths.push_back(std::format("Effects\\{}Missing.dds", stem));
+		}
+		if (!texturePaths.empty()) {
+			suite.Add("ParticleLights/ConfigLookup", [texturePaths, index = size_t(0)]() mutable {
+				char stemBuffer[MAX_PATH];
+				auto& configs = ParticleLights::GetSingleton()->particleLightConfigs;
+				auto stem = ParticleLightConfigs::GetStem(texturePaths[index++ % texturePaths.size()], stemBuffer);
+				BenchmarkSuite::DoNotOptimize(configs.find(stem) != configs.end());
+			});
+		}
+
+		ModelBenchmarks::Add(suite);
+
+		logger::info("Running benchmarks");
+		auto results = suite.Run();
+		for (auto& result : results)
+			logger::info("{:<36} {:>12.1f} ns {:>12} iterations", result.name, result.nanoseconds, result.iterations);
+
+		std::ofstream file{ OutputPath };
+		file << BenchmarkSuite::ToJson(results, Plugin::VERSION.string());
+		logger::info("Saved benchmark results to {}", OutputPath);
+	}
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+namespace Benchmarks
+{
+	// Times the plugin's hot paths against the loaded game data and writes the results to Benchmarks.json
+	void Run();
+}
@@ -0,0 +1,65 @@
+#include "CompileCostModel.h"
+
+#include <algorithm>
+
+std::uint64_t CompileCostModel::MakeKey(std::uint32_t a_shaderClass, std::uint32_t a_shaderType, std::uint32_t a_technique, std::uint32_t a_defineCount)
+{
+	auto bucket = std::min<std::uint32_t>(a_defineCount / DEFINE_BUCKET_SIZE, 0xFF);
+	return (static_cast<std::uint64_t>(a_shaderClass & 0xFF) << 24) | (static_cast<std::uint64_t>(a_shaderType & 0xFF) << 16) |
+	       (static_cast<std::uint64_t>(a_technique & 0xFF) << 8) | bucket;
+}
+
+void CompileCostModel::Add(Entry& a_entry, double a_ms, std::uint64_t a_count)
+{
+	// a saved entry counts as its number of samples, up to the cap
+	a_entry.count = std::min(a_entry.count + a_count, MAX_AVERAGED);
+	auto weight = std::min(static_cast<double>(a_count) / static_cast<double>(a_entry.count), 1.0);
+	a_entry.meanMs += (a_ms - a_entry.meanMs) * weight;
+}
+
+void CompileCostModel::Record(std::uint64_t a_key, double a_ms)
+{
+	std::scoped_lock lock{ mutex };
+	Add(entries[a_key], a_ms, 1);
+	Add(typeEntries[GetTypeKey(a_key)], a_ms, 1);
+	Add(total, a_ms, 1);
+	recordedSamples++;
+}
+
+double CompileCostModel::Predict(std::uint64_t a_key) const
+{
+	std::scoped_lock lock{ mutex };
+	if (auto it = entries.find(a_key); it != entries.end())
+		return it->second.meanMs;
+	if (auto it = typeEntries.find(GetTypeKey(a_key)); it != typeEntries.end())
+		return it->second.meanMs;
+	return total.count ? total.meanMs : DEFAULT_COST_MS;
+}
+
+bool CompileCostModel::IsEmpty() const
+{
+	std::scoped_lock lock{ mutex };
+	return entries.empty();
+}
+
+std::uint64_t CompileCostModel::GetRecordedSamples() const
+{
+	std::scoped_lock lock{ mutex };
+	return recordedSamples;
+}
+
+std::unordered_map<std::uint64_t, CompileCostModel::Entry> CompileCostModel::GetEntries() const
+{
+	std::scoped_lock lock{ mutex };
+	return entries;
+}
+
+void CompileCostModel::SetEntry(std::uint64_t a_key, const Entry& a_entry)
+{
+	if (!a_entry.count)
+		return;
+	std::scoped_lock lock{ mutex };
+	entries[a_key] = a_entry;
+	Add(typeEntries[GetTypeKey(a_key)], a_entry.meanMs, a_entry.count);
+	Add(total, a_entry.meanMs, a_entry.count);
+}
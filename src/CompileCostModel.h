@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+
+// Average compile time per shader class, type, technique and define count, learned while compiling and used to
+// predict how long the remaining backlog takes and which tasks to start first.
+class CompileCostModel
+{
+public:
+	static constexpr double DEFAULT_COST_MS = 250.0;    // prediction before anything was compiled
+	static constexpr std::uint64_t MAX_AVERAGED = 64;  // later samples keep moving the average so it follows source changes
+	static constexpr std::uint32_t DEFINE_BUCKET_SIZE = 4;
+
+	struct Entry
+	{
+		std::uint64_t count = 0;
+		double meanMs = 0.0;
+	};
+
+	static std::uint64_t MakeKey(std::uint32_t a_shaderClass, std::uint32_t a_shaderType, std::uint32_t a_technique, std::uint32_t a_defineCount);
+
+	void Record(std::uint64_t a_key, double a_ms);
+
+	// Average of the key, falling back to the same shader class and type, then to every shader
+	double Predict(std::uint64_t a_key) const;
+
+	bool IsEmpty() const;
+
+	// Compiles recorded since the model was created, saved entries do not count
+	std::uint64_t GetRecordedSamples() const;
+
+	std::unordered_map<std::uint64_t, Entry> GetEntries() const;
+	void SetEntry(std::uint64_t a_key, const Entry& a_entry);
+
+private:
+	static std::uint64_t GetTypeKey(std::uint64_t a_key) { return a_key & ~0xFFFFull; }
+	static void Add(Entry& a_entry, double a_ms, std::uint64_t a_count);
+
+	std::unordered_map<std::uint64_t, Entry> entries;
+	std::unordered_map<std::uint64_t, Entry> typeEntries;
+	Entry total;
+	std::uint64_t recordedSamples = 0;
+	mutable std::mutex mutex;
+};
@@ -66,6 +66,11 @@ void CloudShadows::DrawSettings()
 		}
 		ImGui::TreePop();
 	}
+
+	if (ImGui::TreeNodeEx("Statistics")) {
+		ImGui::Text(std::format("Blend State Cache : {} hits, {} created, {} cached", blendStateHits, blendStateCreations, modifiedBlendStates.size()).c_str());
+		ImGui::TreePop();
+	}
 }
 
 void CloudShadows::CheckResourcesSide(int side)
@@ -105,60 +110,132 @@ void CloudShadows::ModifySky(const RE::BSShader*, const uint32_t descriptor)
 
 	auto tech_enum = static_cast<SkyShaderTechniques>(descriptor);
 	if (tech_enum == SkyShaderTechniques::Clouds || tech_enum == SkyShaderTechniques::CloudsLerp || tech_enum == SkyShaderTechniques::CloudsFade) {
-		auto renderer = RE::BSGraphics::Renderer::GetSingleton();
-		auto context = renderer->GetRuntimeData().context;
-		auto device = renderer->GetRuntimeData().forwarder;
+		auto context = RE::BSGraphics::Renderer::GetSingleton()->GetRuntimeData().context;
 
 		{
 			ID3D11ShaderResourceView* srv = nullptr;
 			context->PSSetShaderResources(40, 1, &srv);
 		}
 
-		auto reflections = renderer->GetRendererData().cubemapRenderTargets[RE::RENDER_TARGET_CUBEMAP::kREFLECTIONS];
-
 		// render targets
 		ID3D11RenderTargetView* rtvs[4];
 		ID3D11DepthStencilView* depthStencil;
 		context->OMGetRenderTargets(3, rtvs, &depthStencil);
 
-		int side = -1;
-		for (int i = 0; i < 6; ++i)
-			if (rtvs[0] == reflections.cubeSideRTV[i]) {
-				side = i;
-				break;
-			}
-		if (side == -1)
-			return;
+		int side = GetReflectionSide(rtvs[0]);
+		if (side != -1) {
+			CheckResourcesSide(side);
 
-		CheckResourcesSide(side);
+			rtvs[3] = cubemapCloudOccRTVs[side];
+			context->OMSetRenderTargets(4, rtvs, depthStencil);
 
-		rtvs[3] = cubemapCloudOccRTVs[side];
-		context->OMSetRenderTargets(4, rtvs, depthStencil);
+			// blend states
+			ID3D11BlendState* blendState;
+			FLOAT blendFactor[4];
+			UINT sampleMask;
 
-		// blend states
-		ID3D11BlendState* blendState;
-		FLOAT blendFactor[4];
-		UINT sampleMask;
+			context->OMGetBlendState(&blendState, blendFactor, &sampleMask);
 
-		context->OMGetBlendState(&blendState, blendFactor, &sampleMask);
+			if (blendState) {
+				auto modifiedBlendState = GetModifiedBlendState(blendState);
+				if (modifiedBlendState != blendState)
+					context->OMSetBlendState(modifiedBlendState, blendFactor, sampleMask);
+				blendState->Release();
+			}
+		}
 
-		if (!mappedBlendStates.contains(blendState)) {
-			if (!modifiedBlendStates.contains(blendState)) {
-				D3D11_BLEND_DESC blendDesc;
-				blendState->GetDesc(&blendDesc);
+		// the getters add a reference to everything they return
+		for (int i = 0; i < 3; i++) {
+			if (rtvs[i])
+				rtvs[i]->Release();
+		}
+		if (depthStencil)
+			depthStencil->Release();
+	}
+}
 
-				blendDesc.RenderTarget[3] = blendDesc.RenderTarget[0];
+int CloudShadows::GetReflectionSide(ID3D11RenderTargetView* rtv)
+{
+	if (auto it = reflectionSides.find(rtv); it != reflectionSides.end())
+		return it->second;
 
-				ID3D11BlendState* modifiedBlendState;
-				DX::ThrowIfFailed(device->CreateBlendState(&blendDesc, &modifiedBlendState));
+	// most misses are main view draws, the lookup is only rebuilt when the reflections cubemap views were recreated
+	auto renderer = RE::BSGraphics::Renderer::GetSingleton();
+	auto& reflections = renderer->GetRendererData().cubemapRenderTargets[RE::RENDER_TARGET_CUBEMAP::kREFLECTIONS];
+	if (std::equal(reflectionSideRTVs.begin(), reflectionSideRTVs.end(), reflections.cubeSideRTV))
+		return -1;
+
+	reflectionSides.clear();
+	for (int i = 0; i < 6; ++i) {
+		reflectionSideRTVs[i] = reflections.cubeSideRTV[i];
+		reflectionSides.insert({ reflections.cubeSideRTV[i], i });
+	}
 
-				mappedBlendStates.insert(modifiedBlendState);
-				modifiedBlendStates.insert({ blendState, modifiedBlendState });
-			}
-			blendState = modifiedBlendStates[blendState];
-			context->OMSetBlendState(blendState, blendFactor, sampleMask);
+	if (auto it = reflectionSides.find(rtv); it != reflectionSides.end())
+		return it->second;
+	return -1;
+}
+
+static size_t GetBlendDescHash(const D3D11_BLEND_DESC& desc)
+{
+	size_t hash = std::hash<int>{}(desc.AlphaToCoverageEnable) ^ (std::hash<int>{}(desc.IndependentBlendEnable) << 1);
+	for (auto& target : desc.RenderTarget) {
+		for (auto value : { (int)target.BlendEnable, (int)target.SrcBlend, (int)target.DestBlend, (int)target.BlendOp,
+				 (int)target.SrcBlendAlpha, (int)target.DestBlendAlpha, (int)target.BlendOpAlpha, (int)target.RenderTargetWriteMask }) {
+			hash = hash * 31 + std::hash<int>{}(value);
 		}
 	}
+	return hash;
+}
+
+static bool IsBlendDescEqual(const D3D11_BLEND_DESC& a, const D3D11_BLEND_DESC& b)
+{
+	if (a.AlphaToCoverageEnable != b.AlphaToCoverageEnable || a.IndependentBlendEnable != b.IndependentBlendEnable)
+		return false;
+	for (int i = 0; i < 8; i++) {
+		auto& x = a.RenderTarget[i];
+		auto& y = b.RenderTarget[i];
+		if (x.BlendEnable != y.BlendEnable || x.SrcBlend != y.SrcBlend || x.DestBlend != y.DestBlend || x.BlendOp != y.BlendOp ||
+			x.SrcBlendAlpha != y.SrcBlendAlpha || x.DestBlendAlpha != y.DestBlendAlpha || x.BlendOpAlpha != y.BlendOpAlpha ||
+			x.RenderTargetWriteMask != y.RenderTargetWriteMask)
+			return false;
+	}
+	return true;
+}
+
+ID3D11BlendState* CloudShadows::GetModifiedBlendState(ID3D11BlendState* blendState)
+{
+	// still bound from a previous cloud draw, it already blends into the occlusion target
+	if (ownBlendStates.contains(blendState))
+		return blendState;
+
+	D3D11_BLEND_DESC blendDesc;
+	blendState->GetDesc(&blendDesc);
+
+	auto hash = GetBlendDescHash(blendDesc);
+	if (auto it = modifiedBlendStates.find(hash); it != modifiedBlendStates.end() && IsBlendDescEqual(it->second.originalDesc, blendDesc)) {
+		blendStateHits++;
+		return it->second.state.get();
+	}
+
+	// the game only uses a handful of cloud blend states, anything past the bound is churn so start over
+	if (modifiedBlendStates.size() >= MAX_MODIFIED_BLEND_STATES) {
+		modifiedBlendStates.clear();
+		ownBlendStates.clear();
+	}
+
+	ModifiedBlendState modified{ blendDesc, nullptr };
+	blendDesc.RenderTarget[3] = blendDesc.RenderTarget[0];
+	auto device = RE::BSGraphics::Renderer::GetSingleton()->GetRuntimeData().forwarder;
+	DX::ThrowIfFailed(device->CreateBlendState(&blendDesc, modified.state.put()));
+	blendStateCreations++;
+
+	auto result = modified.state.get();
+	if (auto it = modifiedBlendStates.find(hash); it != modifiedBlendStates.end())
+		ownBlendStates.erase(it->second.state.get());  // replaced after a hash collision
+	modifiedBlendStates[hash] = std::move(modified);
+	ownBlendStates.insert(result);
+	return result;
 }
 
 void CloudShadows::ModifyLighting()
@@ -3,6 +3,9 @@
 #include "Buffer.h"
 #include "Feature.h"
 
+#include <EASTL/vector_map.h>
+#include <EASTL/vector_set.h>
+
 struct CloudShadows : Feature
 {
 	static CloudShadows* GetSingleton()
@@ -39,8 +42,20 @@ struct CloudShadows : Feature
 	};
 	std::unique_ptr<Buffer> perPass = nullptr;
 
-	std::set<ID3D11BlendState*> mappedBlendStates;
-	std::map<ID3D11BlendState*, ID3D11BlendState*> modifiedBlendStates;
+	// Cloud blend states extended to also blend into the occlusion target, keyed by the hash of the original description
+	struct ModifiedBlendState
+	{
+		D3D11_BLEND_DESC originalDesc;
+		winrt::com_ptr<ID3D11BlendState> state;
+	};
+	static constexpr size_t MAX_MODIFIED_BLEND_STATES = 64;
+	eastl::vector_map<size_t, ModifiedBlendState> modifiedBlendStates;
+	eastl::vector_set<ID3D11BlendState*> ownBlendStates;  // the states in modifiedBlendStates, never modified again
+	std::uint64_t blendStateHits = 0;
+	std::uint64_t blendStateCreations = 0;
+
+	eastl::vector_map<ID3D11RenderTargetView*, int> reflectionSides;  // cube side RTV to face index
+	std::array<ID3D11RenderTargetView*, 6> reflectionSideRTVs{};     // the views reflectionSides was built from
 
 	Texture2D* texCubemapCloudOcc = nullptr;
 	ID3D11RenderTargetView* cubemapCloudOccRTVs[6] = { nullptr };
@@ -52,6 +67,8 @@ struct CloudShadows : Feature
 	virtual void DrawSettings();
 
 	void CheckResourcesSide(int side);
+	int GetReflectionSide(ID3D11RenderTargetView* rtv);
+	ID3D11BlendState* GetModifiedBlendState(ID3D11BlendState* blendState);
 	void ModifySky(const RE::BSShader* shader, const uint32_t descriptor);
 	void ModifyLighting();
 	virtual void Draw(const RE::BSShader* shader, const uint32_t descriptor);
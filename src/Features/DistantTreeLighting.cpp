@@ -157,5 +157,5 @@ void DistantTreeLighting::RestoreDefaultSettings()
 
 void DistantTreeLighting::SetupResources()
 {
-	perPass = new ConstantBuffer(ConstantBufferDesc<PerPass>());
+	perPass = std::make_unique<SettingsBlock<PerPass>>(SettingsBlock<PerPass>::Kind::Constant);
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Buffer.h"
+#include "SettingsBlock.h"
 #include "Feature.h"
 
 struct DistantTreeLighting : Feature
@@ -33,7 +34,7 @@ struct DistantTreeLighting : Feature
 	};
 
 	Settings settings;
-	ConstantBuffer* perPass = nullptr;
+	std::unique_ptr<SettingsBlock<PerPass>> perPass = nullptr;
 
 	RE::TESWorldSpace* lastWorldSpace = nullptr;
 	bool complexAtlasTexture = false;
@@ -3,6 +3,12 @@
 
 constexpr auto MIPLEVELS = 10;
 
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE_WITH_DEFAULT(
+	DynamicCubemaps::Settings,
+	PrefilterBudget,
+	MinCameraMovement,
+	MaxPrefilterInterval)
+
 void DynamicCubemaps::DrawSettings()
 {
 	if (ImGui::TreeNodeEx("Settings", ImGuiTreeNodeFlags_DefaultOpen)) {
@@ -35,6 +41,28 @@ void DynamicCubemaps::DrawSettings()
 		ImGui::Spacing();
 		ImGui::Spacing();
 
+		ImGui::SliderFloat("Prefilter Budget", &settings.PrefilterBudget, 5.0f, 100.0f, "%.0f%%");
+		if (auto _tt = Util::HoverTooltipWrapper()) {
+			ImGui::Text("Share of the specular prefiltering done per frame. Lower values spread the work over more frames to avoid frame time spikes.");
+		}
+
+		ImGui::SliderFloat("Min Camera Movement", &settings.MinCameraMovement, 0.0f, 256.0f, "%.0f units");
+		if (auto _tt = Util::HoverTooltipWrapper()) {
+			ImGui::Text("Prefiltering is skipped until the camera moved this far or the max interval passed.");
+		}
+
+		ImGui::SliderFloat("Max Prefilter Interval", &settings.MaxPrefilterInterval, 0.0f, 5.0f, "%.1f s");
+		if (auto _tt = Util::HoverTooltipWrapper()) {
+			ImGui::Text("Longest time the prefiltered cubemap is kept while the camera is still, so lighting changes are still picked up.");
+		}
+
+		ImGui::TreePop();
+	}
+
+	if (ImGui::TreeNodeEx("Statistics", ImGuiTreeNodeFlags_DefaultOpen)) {
+		auto budget = (std::uint64_t)(filterSchedule.GetTotalCost() * settings.PrefilterBudget / 100.0f);
+		ImGui::Text(std::format("Frames per Prefilter : {} (at most {})", lastPrefilterFrames, filterSchedule.GetFrameBound(budget)).c_str());
+		ImGui::Text(std::format("Skipped Prefilters : {}/{}", skippedPrefilterPasses, skippedPrefilterPasses + prefilterPasses).c_str());
 		ImGui::TreePop();
 	}
 }
@@ -184,6 +212,8 @@ void DynamicCubemaps::UpdateCubemapCapture()
 
 	context->CSSetConstantBuffers(0, 2, buffers);
 
+	if (resetCapture)
+		forcePrefilter = true;
 	resetCapture = false;
 
 	context->CSSetShader(GetComputeShaderUpdate(), nullptr, 0);
@@ -263,49 +293,73 @@ void DynamicCubemaps::UpdateCubemap()
 		ID3D11SamplerState* sampler = nullptr;
 		context->CSSetSamplers(0, 1, &sampler);
 	} else if (nextTask == NextTask::kIrradiance) {
-		nextTask = NextTask::kCapture;
+		if (!filterSchedule.IsActive()) {
+			// Nothing in view changed much, keep the current prefiltered cubemap
+			auto state = RE::BSGraphics::RendererShadowState::GetSingleton();
+			auto eyePosition = !REL::Module::IsVR() ?
+			                       state->GetRuntimeData().posAdjust.getEye(0) :
+			                       state->GetVRRuntimeData().posAdjust.getEye(0);
+			auto now = std::chrono::steady_clock::now();
+			float elapsed = std::chrono::duration<float>(now - lastPrefilterTime).count();
+			if (!forcePrefilter && eyePosition.GetDistance(lastPrefilterPosition) < settings.MinCameraMovement && elapsed < settings.MaxPrefilterInterval) {
+				skippedPrefilterPasses++;
+				nextTask = NextTask::kCapture;
+				return;
+			}
+			forcePrefilter = false;
+			lastPrefilterPosition = eyePosition;
+			lastPrefilterTime = now;
+			prefilterFrames = 0;
+			prefilterPasses++;
+
+			// Copy cubemap to other resources
+			for (uint face = 0; face < 6; face++) {
+				uint srcSubresourceIndex = D3D11CalcSubresource(0, face, MIPLEVELS);
+				context->CopySubresourceRegion(envTexture->resource.get(), D3D11CalcSubresource(0, face, MIPLEVELS), 0, 0, 0, envInferredTexture->resource.get(), srcSubresourceIndex, nullptr);
+			}
 
-		// Copy cubemap to other resources
-		for (uint face = 0; face < 6; face++) {
-			uint srcSubresourceIndex = D3D11CalcSubresource(0, face, MIPLEVELS);
-			context->CopySubresourceRegion(envTexture->resource.get(), D3D11CalcSubresource(0, face, MIPLEVELS), 0, 0, 0, envInferredTexture->resource.get(), srcSubresourceIndex, nullptr);
+			// The inferred cubemap is not written again until the pass is finished
+			context->GenerateMips(envInferredTexture->srv.get());
+
+			filterSchedule.Begin(std::max(envTexture->desc.Width, envTexture->desc.Height), MIPLEVELS);
 		}
 
-		// Compute pre-filtered specular environment map.
+		// Compute pre-filtered specular environment map, a budgeted share of the faces and mips per frame.
 		{
-			auto srv = envInferredTexture->srv.get();
-			context->GenerateMips(srv);
-
-			context->CSSetShaderResources(0, 1, &srv);
+			ID3D11ShaderResourceView* srvs[2] = { envInferredTexture->srv.get(), filterSamples->srv.get() };
+			context->CSSetShaderResources(0, 2, srvs);
 			context->CSSetSamplers(0, 1, &computeSampler);
 			context->CSSetShader(GetComputeShaderSpecularIrradiance(), nullptr, 0);
 
 			ID3D11Buffer* buffer = spmapCB->CB();
 			context->CSSetConstantBuffers(0, 1, &buffer);
 
-			float const delta_roughness = 1.0f / std::max(float(MIPLEVELS - 1), 1.0f);
-
-			std::uint32_t size = std::max(envTexture->desc.Width, envTexture->desc.Height);
-
-			for (std::uint32_t level = 1; level < MIPLEVELS; level++, size /= 2) {
-				const UINT numGroups = (UINT)std::max(1u, size / 32);
+			auto budget = (std::uint64_t)(filterSchedule.GetTotalCost() * settings.PrefilterBudget / 100.0f);
+			for (auto& dispatch : filterSchedule.Next(budget)) {
+				const UINT numGroups = (UINT)std::max(1u, (dispatch.size + 31) / 32);
 
-				const SpecularMapFilterSettingsCB spmapConstants = { level * delta_roughness };
+				const SpecularMapFilterSettingsCB spmapConstants = { dispatch.firstFace, dispatch.mip };
 				spmapCB->Update(spmapConstants);
 
-				auto uav = uavArray[level - 1].get();
+				auto uav = uavArray[dispatch.mip - 1].get();
 
 				context->CSSetUnorderedAccessViews(0, 1, &uav, nullptr);
-				context->Dispatch(numGroups, numGroups, 6);
+				context->Dispatch(numGroups, numGroups, dispatch.faceCount);
 			}
 		}
 
-		ID3D11ShaderResourceView* nullSRV = { nullptr };
+		prefilterFrames++;
+		if (!filterSchedule.IsActive()) {
+			lastPrefilterFrames = prefilterFrames;
+			nextTask = NextTask::kCapture;
+		}
+
+		ID3D11ShaderResourceView* nullSRVs[2] = { nullptr, nullptr };
 		ID3D11SamplerState* nullSampler = { nullptr };
 		ID3D11Buffer* nullBuffer = { nullptr };
 		ID3D11UnorderedAccessView* nullUAV = { nullptr };
 
-		context->CSSetShaderResources(0, 1, &nullSRV);
+		context->CSSetShaderResources(0, 2, nullSRVs);
 		context->CSSetSamplers(0, 1, &nullSampler);
 		context->CSSetShader(nullptr, 0, 0);
 		context->CSSetConstantBuffers(0, 1, &nullBuffer);
@@ -357,25 +411,20 @@ void DynamicCubemaps::SetupResources()
 	}
 
 	{
-		spBRDFProgram = (ID3D11ComputeShader*)Util::CompileShader(L"Data\\Shaders\\DynamicCubemaps\\SpbrdfCS.hlsl", {}, "cs_5_0");
+		// Cook-Torrance BRDF 2D LUT for split-sum approximation, computed once on the CPU and cached on disk
+		auto lut = SpecularTables::LoadBRDFLUT("Data\\ShaderCache\\DynamicCubemaps\\BRDFLUT.bin");
 
 		D3D11_TEXTURE2D_DESC texDesc{};
-		texDesc.Width = 256;
-		texDesc.Height = 256;
+		texDesc.Width = SpecularTables::BRDF_LUT_SIZE;
+		texDesc.Height = SpecularTables::BRDF_LUT_SIZE;
 		texDesc.MipLevels = 1;
 		texDesc.ArraySize = 1;
-		texDesc.Format = DXGI_FORMAT_R16G16_FLOAT;
+		texDesc.Format = DXGI_FORMAT_R32G32_FLOAT;
 		texDesc.SampleDesc.Count = 1;
 		texDesc.Usage = D3D11_USAGE_DEFAULT;
-		texDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_UNORDERED_ACCESS;
+		texDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
 		spBRDFLUT = new Texture2D(texDesc);
 
-		D3D11_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
-		uavDesc.Format = texDesc.Format;
-		uavDesc.ViewDimension = D3D11_UAV_DIMENSION_TEXTURE2D;
-		uavDesc.Texture2D.MipSlice = 0;
-		spBRDFLUT->CreateUAV(uavDesc);
-
 		D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
 		srvDesc.Format = texDesc.Format;
 		srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
@@ -383,15 +432,29 @@ void DynamicCubemaps::SetupResources()
 		srvDesc.Texture2D.MipLevels = 1;
 		spBRDFLUT->CreateSRV(srvDesc);
 
-		{
-			// Compute Cook-Torrance BRDF 2D LUT for split-sum approximation.
-			auto uav = spBRDFLUT->uav.get();
-			context->CSSetUnorderedAccessViews(0, 1, &uav, nullptr);
-			context->CSSetShader(spBRDFProgram, nullptr, 0);
-			context->Dispatch(spBRDFLUT->desc.Width / 32, spBRDFLUT->desc.Height / 32, 1);
-			uav = nullptr;
-			context->CSSetUnorderedAccessViews(0, 1, &uav, nullptr);
-		}
+		context->UpdateSubresource(spBRDFLUT->resource.get(), 0, nullptr, lut.data(), texDesc.Width * sizeof(float) * 2, 0);
+	}
+
+	{
+		// GGX importance samples of every mip, so the prefiltering only does table lookups
+		auto samples = SpecularTables::ComputeFilterSamples(MIPLEVELS);
+
+		D3D11_BUFFER_DESC sbDesc{};
+		sbDesc.Usage = D3D11_USAGE_IMMUTABLE;
+		sbDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+		sbDesc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+		sbDesc.StructureByteStride = sizeof(float) * 4;
+		sbDesc.ByteWidth = (UINT)(samples.size() * sizeof(float));
+
+		D3D11_SUBRESOURCE_DATA initData{ samples.data(), 0, 0 };
+		filterSamples = new Buffer(sbDesc, &initData);
+
+		D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc;
+		srvDesc.Format = DXGI_FORMAT_UNKNOWN;
+		srvDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+		srvDesc.Buffer.FirstElement = 0;
+		srvDesc.Buffer.NumElements = sbDesc.ByteWidth / sbDesc.StructureByteStride;
+		filterSamples->CreateSRV(srvDesc);
 	}
 
 	auto& cubemap = renderer->GetRendererData().cubemapRenderTargets[RE::RENDER_TARGETS_CUBEMAP::kREFLECTIONS];
@@ -510,13 +573,18 @@ void DynamicCubemaps::Reset()
 
 void DynamicCubemaps::Load(json& o_json)
 {
+	if (o_json[GetName()].is_object())
+		settings = o_json[GetName()];
+
 	Feature::Load(o_json);
 }
 
-void DynamicCubemaps::Save(json&)
+void DynamicCubemaps::Save(json& o_json)
 {
+	o_json[GetName()] = settings;
 }
 
 void DynamicCubemaps::RestoreDefaultSettings()
 {
+	settings = {};
 }
\ No newline at end of file
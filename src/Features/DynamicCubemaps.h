@@ -2,6 +2,8 @@
 
 #include "Buffer.h"
 #include "Feature.h"
+#include "Features/DynamicCubemaps/CubemapFilterSchedule.h"
+#include "Features/DynamicCubemaps/SpecularTables.h"
 
 class MenuOpenCloseEventHandler : public RE::BSTEventSink<RE::MenuOpenCloseEvent>
 {
@@ -21,24 +23,34 @@ public:
 
 	bool renderedScreenCamera = false;
 
+	struct Settings
+	{
+		float PrefilterBudget = 25.0f;      // percent of a full prefiltering pass done per frame
+		float MinCameraMovement = 32.0f;    // units the camera must move before prefiltering again early
+		float MaxPrefilterInterval = 1.0f;  // seconds before prefiltering again without movement
+	};
+
+	Settings settings;
+
 	// Specular irradiance
 
 	ID3D11SamplerState* computeSampler = nullptr;
 
 	struct alignas(16) SpecularMapFilterSettingsCB
 	{
-		float roughness;
-		float pad[3];
+		uint faceOffset;
+		uint sampleMip;
+		float pad[2];
 	};
 
 	ID3D11ComputeShader* specularIrradianceCS = nullptr;
 	ConstantBuffer* spmapCB = nullptr;
+	Buffer* filterSamples = nullptr;
 	Texture2D* envTexture = nullptr;
 	winrt::com_ptr<ID3D11UnorderedAccessView> uavArray[9];
 
 	// BRDF 2D LUT
 
-	ID3D11ComputeShader* spBRDFProgram = nullptr;
 	Texture2D* spBRDFLUT = nullptr;
 
 	// Reflection capture
@@ -73,6 +85,16 @@ public:
 
 	NextTask nextTask = NextTask::kCapture;
 
+	// Prefiltering is spread over frames and skipped while the capture is unlikely to have changed
+	CubemapFilterSchedule filterSchedule;
+	bool forcePrefilter = true;
+	RE::NiPoint3 lastPrefilterPosition{};
+	std::chrono::steady_clock::time_point lastPrefilterTime{};
+	std::uint32_t prefilterFrames = 0;
+	std::uint32_t lastPrefilterFrames = 0;
+	std::uint64_t prefilterPasses = 0;
+	std::uint64_t skippedPrefilterPasses = 0;
+
 	ID3D11UnorderedAccessView* cubemapUAV;
 
 	void UpdateCubemap();
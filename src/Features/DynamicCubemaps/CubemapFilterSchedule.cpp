@@ -0,0 +1,55 @@
+#include "CubemapFilterSchedule.h"
+
+#include <algorithm>
+
+void CubemapFilterSchedule::Begin(std::uint32_t a_size, std::uint32_t a_mipLevels)
+{
+	items.clear();
+	nextItem = 0;
+	totalCost = 0;
+	for (std::uint32_t mip = 1; mip < a_mipLevels; mip++) {
+		auto size = std::max(a_size >> mip, 1u);
+		for (std::uint32_t face = 0; face < FACES; face++) {
+			items.push_back({ mip, size, face, (std::uint64_t)size * size });
+			totalCost += (std::uint64_t)size * size;
+		}
+	}
+}
+
+std::vector<CubemapFilterSchedule::Dispatch> CubemapFilterSchedule::Next(std::uint64_t a_budgetTexels)
+{
+	std::vector<Dispatch> dispatches;
+	std::uint64_t spent = 0;
+	while (nextItem < items.size()) {
+		auto& item = items[nextItem];
+		if (!dispatches.empty() && spent + item.cost > a_budgetTexels)
+			break;
+		spent += item.cost;
+		nextItem++;
+
+		if (!dispatches.empty() && dispatches.back().mip == item.mip) {
+			dispatches.back().faceCount++;
+		} else {
+			dispatches.push_back(Dispatch{ item.mip, item.size, item.face, 1 });
+		}
+	}
+	return dispatches;
+}
+
+std::uint32_t CubemapFilterSchedule::GetFrameBound(std::uint64_t a_budgetTexels) const
+{
+	// a frame either spends more than the budget minus the next item, or handles a single item larger than the budget
+	std::uint32_t frames = 0;
+	std::uint64_t spent = 0;
+	bool empty = true;
+	for (auto& item : items) {
+		if (!empty && spent + item.cost > a_budgetTexels) {
+			frames++;
+			spent = 0;
+			empty = true;
+		}
+		spent += item.cost;
+		empty = false;
+	}
+	return frames + (empty ? 0 : 1);
+}
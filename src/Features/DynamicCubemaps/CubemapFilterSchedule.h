@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Splits the prefiltering of a cubemap's mips into per face work items spread over several frames.
+class CubemapFilterSchedule
+{
+public:
+	static constexpr std::uint32_t FACES = 6;
+
+	// A dispatch covering consecutive faces of one mip level
+	struct Dispatch
+	{
+		std::uint32_t mip;
+		std::uint32_t size;
+		std::uint32_t firstFace;
+		std::uint32_t faceCount;
+	};
+
+	// Starts a new pass over mips 1 to a_mipLevels - 1 of a cubemap with faces of a_size texels
+	void Begin(std::uint32_t a_size, std::uint32_t a_mipLevels);
+
+	// Work for this frame, at least one face so every pass finishes, then faces while they fit in the budget
+	std::vector<Dispatch> Next(std::uint64_t a_budgetTexels);
+
+	bool IsActive() const { return nextItem < items.size(); }
+
+	// Texels written by a whole pass, the unit of the budget
+	std::uint64_t GetTotalCost() const { return totalCost; }
+
+	// Upper bound of the frames a pass takes with the given budget
+	std::uint32_t GetFrameBound(std::uint64_t a_budgetTexels) const;
+
+private:
+	struct Item
+	{
+		std::uint32_t mip;
+		std::uint32_t size;
+		std::uint32_t face;
+		std::uint64_t cost;
+	};
+
+	std::vector<Item> items;
+	std::size_t nextItem = 0;
+	std::uint64_t totalCost = 0;
+};
@@ -0,0 +1,167 @@
+#include "SpecularTables.h"
+
+#include <algorithm>
+#include <cmath>
+#include <execution>
+#include <fstream>
+#include <numeric>
+
+namespace SpecularTables
+{
+	// Physically Based Rendering
+	// Copyright (c) 2017-2018 Michał Siejak
+
+	constexpr float PI = 3.141592f;
+	constexpr float TwoPI = 2 * PI;
+
+	constexpr std::uint32_t LUT_MAGIC = 0x54554C42;  // "BLUT"
+	constexpr std::uint32_t LUT_VERSION = 1;
+
+	struct Vector3
+	{
+		float x, y, z;
+	};
+
+	// Compute Van der Corput radical inverse
+	// See: http://holger.dammertz.org/stuff/notes_HammersleyOnHemisphere.html
+	static float RadicalInverseVdC(std::uint32_t bits)
+	{
+		bits = (bits << 16u) | (bits >> 16u);
+		bits = ((bits & 0x55555555u) << 1u) | ((bits & 0xAAAAAAAAu) >> 1u);
+		bits = ((bits & 0x33333333u) << 2u) | ((bits & 0xCCCCCCCCu) >> 2u);
+		bits = ((bits & 0x0F0F0F0Fu) << 4u) | ((bits & 0xF0F0F0F0u) >> 4u);
+		bits = ((bits & 0x00FF00FFu) << 8u) | ((bits & 0xFF00FF00u) >> 8u);
+		return float(bits) * 2.3283064365386963e-10f;  // / 0x100000000
+	}
+
+	// Importance sample GGX normal distribution function for a fixed roughness value.
+	// This returns normalized half-vector between Li & Lo.
+	static Vector3 SampleGGX(float u1, float u2, float roughness)
+	{
+		float alpha = roughness * roughness;
+
+		float cosTheta = std::sqrt((1.0f - u2) / (1.0f + (alpha * alpha - 1.0f) * u2));
+		float sinTheta = std::sqrt(1.0f - cosTheta * cosTheta);
+		float phi = TwoPI * u1;
+
+		return { sinTheta * std::cos(phi), sinTheta * std::sin(phi), cosTheta };
+	}
+
+	// GGX/Towbridge-Reitz normal distribution function.
+	static float NdfGGX(float cosLh, float roughness)
+	{
+		float alpha = roughness * roughness;
+		float alphaSq = alpha * alpha;
+
+		float denom = (cosLh * cosLh) * (alphaSq - 1.0f) + 1.0f;
+		return alphaSq / (PI * denom * denom);
+	}
+
+	static float GaSchlickG1(float cosTheta, float k)
+	{
+		return cosTheta / (cosTheta * (1.0f - k) + k);
+	}
+
+	// Schlick-GGX approximation of geometric attenuation function using Smith's method (IBL version).
+	static float GaSchlickGGX_IBL(float cosLi, float cosLo, float roughness)
+	{
+		float k = (roughness * roughness) / 2.0f;
+		return GaSchlickG1(cosLi, k) * GaSchlickG1(cosLo, k);
+	}
+
+	std::vector<float> ComputeBRDFLUT(std::uint32_t a_size)
+	{
+		constexpr float Epsilon = 0.001f;
+
+		std::vector<float> lut((size_t)a_size * a_size * 2);
+		std::vector<std::uint32_t> rows(a_size);
+		std::iota(rows.begin(), rows.end(), 0);
+		std::for_each(std::execution::par, rows.begin(), rows.end(), [&](std::uint32_t y) {
+			float roughness = (float)y / a_size;
+			for (std::uint32_t x = 0; x < a_size; x++) {
+				// Make sure viewing angle is non-zero to avoid divisions by zero (and subsequently NaNs).
+				float cosLo = std::max((float)x / a_size, Epsilon);
+				Vector3 Lo{ std::sqrt(1.0f - cosLo * cosLo), 0.0f, cosLo };
+
+				// Pre-integrate Cook-Torrance BRDF for a solid white environment.
+				// For derivation see: "Moving Frostbite to Physically Based Rendering 3.0", SIGGRAPH 2014, section 4.9.2.
+				float DFG1 = 0;
+				float DFG2 = 0;
+				for (std::uint32_t i = 0; i < BRDF_SAMPLES; i++) {
+					auto Lh = SampleGGX((float)i / BRDF_SAMPLES, RadicalInverseVdC(i), roughness);
+
+					float LoLh = Lo.x * Lh.x + Lo.y * Lh.y + Lo.z * Lh.z;
+					float cosLi = 2.0f * LoLh * Lh.z - Lo.z;
+					float cosLh = Lh.z;
+					float cosLoLh = std::max(LoLh, 0.0f);
+
+					if (cosLi > 0.0f) {
+						float G = GaSchlickGGX_IBL(cosLi, cosLo, roughness);
+						float Gv = G * cosLoLh / (cosLh * cosLo);
+						float Fc = std::pow(1.0f - cosLoLh, 5.0f);
+
+						DFG1 += (1 - Fc) * Gv;
+						DFG2 += Fc * Gv;
+					}
+				}
+
+				auto texel = ((size_t)y * a_size + x) * 2;
+				lut[texel] = DFG1 / BRDF_SAMPLES;
+				lut[texel + 1] = DFG2 / BRDF_SAMPLES;
+			}
+		});
+		return lut;
+	}
+
+	std::vector<float> LoadBRDFLUT(const std::filesystem::path& a_path, std::uint32_t a_size)
+	{
+		std::vector<float> lut((size_t)a_size * a_size * 2);
+		const auto bytes = (std::streamsize)(lut.size() * sizeof(float));
+
+		if (std::ifstream file{ a_path, std::ios::binary }) {
+			std::uint32_t header[3]{};
+			file.read(reinterpret_cast<char*>(header), sizeof(header));
+			if (file && header[0] == LUT_MAGIC && header[1] == LUT_VERSION && header[2] == a_size) {
+				file.read(reinterpret_cast<char*>(lut.data()), bytes);
+				if (file.gcount() == bytes)
+					return lut;
+			}
+		}
+
+		lut = ComputeBRDFLUT(a_size);
+
+		std::error_code ec;
+		std::filesystem::create_directories(a_path.parent_path(), ec);
+		if (std::ofstream file{ a_path, std::ios::binary | std::ios::trunc }) {
+			const std::uint32_t header[3]{ LUT_MAGIC, LUT_VERSION, a_size };
+			file.write(reinterpret_cast<const char*>(header), sizeof(header));
+			file.write(reinterpret_cast<const char*>(lut.data()), bytes);
+		}
+		return lut;
+	}
+
+	std::vector<float> ComputeFilterSamples(std::uint32_t a_mipLevels)
+	{
+		std::vector<float> samples((size_t)a_mipLevels * FILTER_SAMPLES * 4);
+		const float deltaRoughness = 1.0f / std::max(float(a_mipLevels - 1), 1.0f);
+		// mip 0 is the unfiltered capture and keeps zeroed samples
+		for (std::uint32_t mip = 1; mip < a_mipLevels; mip++) {
+			float roughness = mip * deltaRoughness;
+			for (std::uint32_t i = 0; i < FILTER_SAMPLES; i++) {
+				auto Lh = SampleGGX((float)i / FILTER_SAMPLES, RadicalInverseVdC(i), roughness);
+
+				// The view direction is the normal, so the pdf and solid angle only depend on the sample.
+				// Scaling by 1/4 is due to change of density in terms of Lh to Li.
+				float pdf = NdfGGX(std::max(Lh.z, 0.0f), roughness) * 0.25f;
+				float ws = 1.0f / (FILTER_SAMPLES * pdf);
+
+				auto sample = samples.data() + ((size_t)mip * FILTER_SAMPLES + i) * 4;
+				sample[0] = Lh.x;
+				sample[1] = Lh.y;
+				sample[2] = Lh.z;
+				sample[3] = 0.5f * std::log2(ws);
+			}
+		}
+		return samples;
+	}
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+// CPU versions of the split-sum BRDF LUT and of the GGX samples used to prefilter the cubemap.
+namespace SpecularTables
+{
+	constexpr std::uint32_t BRDF_LUT_SIZE = 256;
+	constexpr std::uint32_t BRDF_SAMPLES = 2048;
+	constexpr std::uint32_t FILTER_SAMPLES = 16;  // must match NumSamples in SpecularIrradianceCS.hlsl
+
+	// DFG1 and DFG2 pairs for cosLo along x and roughness along y, same as the former SpbrdfCS
+	std::vector<float> ComputeBRDFLUT(std::uint32_t a_size = BRDF_LUT_SIZE);
+
+	// Loads the LUT from a_path, computing and writing it there first when missing or outdated
+	std::vector<float> LoadBRDFLUT(const std::filesystem::path& a_path, std::uint32_t a_size = BRDF_LUT_SIZE);
+
+	// FILTER_SAMPLES float4 per mip level: tangent space half vector in xyz, half of log2 of the sample solid angle in w
+	std::vector<float> ComputeFilterSamples(std::uint32_t a_mipLevels);
+}
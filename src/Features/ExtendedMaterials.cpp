@@ -130,18 +130,13 @@ void ExtendedMaterials::ModifyLighting(const RE::BSShader*, const uint32_t)
 	{
 		PerPass data{};
 		data.settings = settings;
-
-		D3D11_MAPPED_SUBRESOURCE mapped;
-		DX::ThrowIfFailed(context->Map(perPass->resource.get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped));
-		size_t bytes = sizeof(PerPass);
-		memcpy_s(mapped.pData, bytes, &data, bytes);
-		context->Unmap(perPass->resource.get(), 0);
+		perPass->Update(data);
 	}
 
 	context->PSSetSamplers(1, 1, &terrainSampler);
 
 	ID3D11ShaderResourceView* views[1]{};
-	views[0] = perPass->srv.get();
+	views[0] = perPass->SRV();
 	context->PSSetShaderResources(30, 1, views);
 }
 
@@ -156,21 +151,7 @@ void ExtendedMaterials::Draw(const RE::BSShader* shader, const uint32_t descript
 
 void ExtendedMaterials::SetupResources()
 {
-	D3D11_BUFFER_DESC sbDesc{};
-	sbDesc.Usage = D3D11_USAGE_DYNAMIC;
-	sbDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-	sbDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
-	sbDesc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
-	sbDesc.StructureByteStride = sizeof(PerPass);
-	sbDesc.ByteWidth = sizeof(PerPass);
-	perPass = std::make_unique<Buffer>(sbDesc);
-
-	D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc;
-	srvDesc.Format = DXGI_FORMAT_UNKNOWN;
-	srvDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
-	srvDesc.Buffer.FirstElement = 0;
-	srvDesc.Buffer.NumElements = 1;
-	perPass->CreateSRV(srvDesc);
+	perPass = std::make_unique<SettingsBlock<PerPass>>(SettingsBlock<PerPass>::Kind::Structured);
 
 	logger::info("Creating terrain parallax sampler state");
 
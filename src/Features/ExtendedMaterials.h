@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Buffer.h"
+#include "SettingsBlock.h"
 #include "Feature.h"
 
 struct ExtendedMaterials : Feature
@@ -42,7 +43,7 @@ struct ExtendedMaterials : Feature
 
 	Settings settings;
 
-	std::unique_ptr<Buffer> perPass = nullptr;
+	std::unique_ptr<SettingsBlock<PerPass>> perPass = nullptr;
 
 	ID3D11SamplerState* terrainSampler = nullptr;
 
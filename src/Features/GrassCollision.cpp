@@ -43,7 +43,8 @@ void GrassCollision::DrawSettings()
 				settings.frameInterval++;
 		}
 		if (auto _tt = Util::HoverTooltipWrapper()) {
-			ImGui::Text("How many frames to skip before calculating positions again. 0 means calculate every frame (most smooth/costly).");
+			ImGui::Text("How many frames to skip before calculating positions again. 0 means calculate every frame (most smooth/costly). "
+				"Skipped frames move the last calculated positions along their velocity.");
 		}
 
 		ImGui::TreePop();
@@ -51,6 +52,37 @@ void GrassCollision::DrawSettings()
 	if (ImGui::TreeNodeEx("Statistics", ImGuiTreeNodeFlags_DefaultOpen)) {
 		ImGui::Text(std::format("Active/Total Actors : {}/{}", activeActorCount, totalActorCount).c_str());
 		ImGui::Text(std::format("Total Collisions : {}", currentCollisionCount).c_str());
+		ImGui::Text(std::format("Cached Shape Bounds : {}/{}", cachedShapeCount, currentCollisionCount).c_str());
+		ImGui::Text(std::format("Gather Time : {:.3f} ms", gatherTime).c_str());
+		ImGui::Text(std::format("Reused/Active Actors : {}/{}", reusedActorCount, activeActorCount).c_str());
+		auto totalFrames = gatheredFrameCount + extrapolatedFrameCount;
+		ImGui::Text(std::format("Extrapolated Frames : {:.1f}%", totalFrames ? 100.0 * extrapolatedFrameCount / totalFrames : 0.0).c_str());
+		ImGui::Text(std::format("Grid Cell Size : {:.1f}, Max Collisions per Cell : {}", collisionGrid.GetCellSize(), collisionGrid.GetMaxCellCount()).c_str());
+
+		if (ImGui::TreeNode("Collisions per Grid Cell")) {
+			// heat map of the cells, brighter cells make every grass vertex inside them test more collisions
+			auto& cells = collisionGrid.GetCells();
+			auto maxCount = std::max(collisionGrid.GetMaxCellCount(), 1u);
+			const float cellPixels = 12.0f;
+			auto drawList = ImGui::GetWindowDrawList();
+			auto origin = ImGui::GetCursorScreenPos();
+			for (std::uint32_t y = 0; y < CollisionGrid::GRID_SIZE; y++) {
+				for (std::uint32_t x = 0; x < CollisionGrid::GRID_SIZE; x++) {
+					auto count = cells[y * CollisionGrid::GRID_SIZE + x].count;
+					float intensity = (float)count / maxCount;
+					// world y points north, so draw the last row at the top
+					ImVec2 min{ origin.x + x * cellPixels, origin.y + (CollisionGrid::GRID_SIZE - 1 - y) * cellPixels };
+					ImVec2 max{ min.x + cellPixels - 1.0f, min.y + cellPixels - 1.0f };
+					drawList->AddRectFilled(min, max, ImGui::GetColorU32(ImVec4(intensity, intensity * 0.5f, 0.1f, 1.0f)));
+					if (ImGui::IsMouseHoveringRect(min, max)) {
+						ImGui::SetTooltip("%u collisions", count);
+					}
+				}
+			}
+			ImGui::Dummy(ImVec2(CollisionGrid::GRID_SIZE * cellPixels, CollisionGrid::GRID_SIZE * cellPixels));
+			ImGui::TreePop();
+		}
+
 		ImGui::TreePop();
 	}
 }
@@ -96,7 +128,24 @@ static bool GetShapeBound(RE::NiAVObject* a_node, RE::NiPoint3& centerPos, float
 	return false;
 }
 
-static bool GetShapeBound(RE::bhkNiCollisionObject* Colliedobj, RE::NiPoint3& centerPos, float& radius)
+static float GetShapeRadius(const RE::hkpShape* shape)
+{
+	float upExtent = shape->GetMaximumProjection(RE::hkVector4{ 0.0f, 0.0f, 1.0f, 0.0f }) * RE::bhkWorld::GetWorldScaleInverse();
+	float downExtent = shape->GetMaximumProjection(RE::hkVector4{ 0.0f, 0.0f, -1.0f, 0.0f }) * RE::bhkWorld::GetWorldScaleInverse();
+	auto z_extent = (upExtent + downExtent) / 2.0f;
+
+	float forwardExtent = shape->GetMaximumProjection(RE::hkVector4{ 0.0f, 1.0f, 0.0f, 0.0f }) * RE::bhkWorld::GetWorldScaleInverse();
+	float backwardExtent = shape->GetMaximumProjection(RE::hkVector4{ 0.0f, -1.0f, 0.0f, 0.0f }) * RE::bhkWorld::GetWorldScaleInverse();
+	auto y_extent = (forwardExtent + backwardExtent) / 2.0f;
+
+	float leftExtent = shape->GetMaximumProjection(RE::hkVector4{ 1.0f, 0.0f, 0.0f, 0.0f }) * RE::bhkWorld::GetWorldScaleInverse();
+	float rightExtent = shape->GetMaximumProjection(RE::hkVector4{ -1.0f, 0.0f, 0.0f, 0.0f }) * RE::bhkWorld::GetWorldScaleInverse();
+	auto x_extent = (leftExtent + rightExtent) / 2.0f;
+
+	return sqrtf(x_extent * x_extent + y_extent * y_extent + z_extent * z_extent);
+}
+
+static bool GetShapeBound(RE::bhkNiCollisionObject* Colliedobj, RE::NiPoint3& centerPos, const RE::hkpShape*& shape)
 {
 	if (!Colliedobj)
 		return false;
@@ -104,33 +153,64 @@ static bool GetShapeBound(RE::bhkNiCollisionObject* Colliedobj, RE::NiPoint3& ce
 	RE::bhkRigidBody* bhkRigid = Colliedobj->body.get() ? Colliedobj->body.get()->AsBhkRigidBody() : nullptr;
 	RE::hkpRigidBody* hkpRigid = bhkRigid ? skyrim_cast<RE::hkpRigidBody*>(bhkRigid->referencedObject.get()) : nullptr;
 	if (bhkRigid && hkpRigid) {
-		RE::hkVector4 massCenter;
-		bhkRigid->GetCenterOfMassWorld(massCenter);
-		float massTrans[4];
-		_mm_store_ps(massTrans, massCenter.quad);
-		centerPos = RE::NiPoint3(massTrans[0], massTrans[1], massTrans[2]) * RE::bhkWorld::GetWorldScaleInverse();
-
-		const RE::hkpShape* shape = hkpRigid->collidable.GetShape();
+		shape = hkpRigid->collidable.GetShape();
 		if (shape) {
-			float upExtent = shape->GetMaximumProjection(RE::hkVector4{ 0.0f, 0.0f, 1.0f, 0.0f }) * RE::bhkWorld::GetWorldScaleInverse();
-			float downExtent = shape->GetMaximumProjection(RE::hkVector4{ 0.0f, 0.0f, -1.0f, 0.0f }) * RE::bhkWorld::GetWorldScaleInverse();
-			auto z_extent = (upExtent + downExtent) / 2.0f;
+			RE::hkVector4 massCenter;
+			bhkRigid->GetCenterOfMassWorld(massCenter);
+			float massTrans[4];
+			_mm_store_ps(massTrans, massCenter.quad);
+			centerPos = RE::NiPoint3(massTrans[0], massTrans[1], massTrans[2]) * RE::bhkWorld::GetWorldScaleInverse();
+			return true;
+		}
+	}
 
-			float forwardExtent = shape->GetMaximumProjection(RE::hkVector4{ 0.0f, 1.0f, 0.0f, 0.0f }) * RE::bhkWorld::GetWorldScaleInverse();
-			float backwardExtent = shape->GetMaximumProjection(RE::hkVector4{ 0.0f, -1.0f, 0.0f, 0.0f }) * RE::bhkWorld::GetWorldScaleInverse();
-			auto y_extent = (forwardExtent + backwardExtent) / 2.0f;
+	return false;
+}
 
-			float leftExtent = shape->GetMaximumProjection(RE::hkVector4{ 1.0f, 0.0f, 0.0f, 0.0f }) * RE::bhkWorld::GetWorldScaleInverse();
-			float rightExtent = shape->GetMaximumProjection(RE::hkVector4{ -1.0f, 0.0f, 0.0f, 0.0f }) * RE::bhkWorld::GetWorldScaleInverse();
-			auto x_extent = (leftExtent + rightExtent) / 2.0f;
+static void UpdateDynamicBuffer(std::unique_ptr<Buffer>& a_buffer, std::uint32_t& a_capacity, std::uint32_t a_stride, const void* a_data, std::uint32_t a_count)
+{
+	if (!a_buffer || a_count > a_capacity) {
+		a_capacity = std::max(a_count, 1u);
 
-			radius = sqrtf(x_extent * x_extent + y_extent * y_extent + z_extent * z_extent);
+		D3D11_BUFFER_DESC sbDesc{};
+		sbDesc.Usage = D3D11_USAGE_DYNAMIC;
+		sbDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+		sbDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+		sbDesc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+		sbDesc.StructureByteStride = a_stride;
+		sbDesc.ByteWidth = a_stride * a_capacity;
+		a_buffer = std::make_unique<Buffer>(sbDesc);
 
-			return true;
-		}
+		D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc;
+		srvDesc.Format = DXGI_FORMAT_UNKNOWN;
+		srvDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+		srvDesc.Buffer.FirstElement = 0;
+		srvDesc.Buffer.NumElements = a_capacity;
+		a_buffer->CreateSRV(srvDesc);
 	}
 
-	return false;
+	if (!a_count)
+		return;
+
+	auto context = RE::BSGraphics::Renderer::GetSingleton()->GetRuntimeData().context;
+	D3D11_MAPPED_SUBRESOURCE mapped;
+	DX::ThrowIfFailed(context->Map(a_buffer->resource.get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped));
+	size_t bytes = (size_t)a_stride * a_count;
+	memcpy_s(mapped.pData, bytes, a_data, bytes);
+	context->Unmap(a_buffer->resource.get(), 0);
+}
+
+// Reads the current world position of every cached body, fails if any of them no longer has the same shape
+static bool RefreshBodies(GrassCollision::ActorCollisions& a_actor, float a_deltaTime)
+{
+	for (auto& body : a_actor.bodies) {
+		RE::NiPoint3 centerPos;
+		const RE::hkpShape* shape = nullptr;
+		if (!GetShapeBound(body.object.get(), centerPos, shape) || shape != body.shape)
+			return false;
+		CollisionPacking::Move(body.bounds, { centerPos.x, centerPos.y, centerPos.z }, a_deltaTime);
+	}
+	return true;
 }
 
 void GrassCollision::UpdateCollisions()
@@ -138,13 +218,13 @@ void GrassCollision::UpdateCollisions()
 	auto state = RE::BSGraphics::RendererShadowState::GetSingleton();
 
 	auto frameCount = RE::BSGraphics::State::GetSingleton()->uiFrameCount;
+	auto now = std::chrono::steady_clock::now();
 
 	if (settings.frameInterval == 0 || frameCount % settings.frameInterval == 0) {  // only calculate actor positions on some frames
-		currentCollisionCount = 0;
 		totalActorCount = 0;
 		activeActorCount = 0;
+		reusedActorCount = 0;
 		actorList.clear();
-		collisionsData.clear();
 		// actor query code from po3 under MIT
 		// https://github.com/powerof3/PapyrusExtenderSSE/blob/7a73b47bc87331bec4e16f5f42f2dbc98b66c3a7/include/Papyrus/Functions/Faction.h#L24C7-L46
 		if (const auto processLists = RE::ProcessLists::GetSingleton(); processLists && settings.maxDistance > 0.0f) {
@@ -167,37 +247,118 @@ void GrassCollision::UpdateCollisions()
 			playerPosition = player->GetPosition();
 		}
 
-		for (const auto actor : actorList) {
-			if (auto root = actor->Get3D(false)) {
-				if (playerPosition.GetDistance(actor->GetPosition()) > settings.maxDistance) {  // npc too far so skip
-					continue;
-				}
-				activeActorCount++;
-				RE::BSVisit::TraverseScenegraphCollision(root, [&](RE::bhkNiCollisionObject* a_object) -> RE::BSVisit::BSVisitControl {
-					RE::NiPoint3 centerPos;
+		auto startTime = std::chrono::high_resolution_clock::now();
+		float deltaTime = std::chrono::duration<float>(now - lastGatherTime).count();
+		lastGatherTime = now;
+		lastGatherFrame = frameCount;
+		gatheredFrameCount++;
+
+		// carry over the entries of actors still loaded
+		auto previousCollisions = std::move(actorCollisions);
+		actorCollisions.clear();
+		std::vector<std::pair<RE::Actor*, ActorCollisions*>> gathers;
+		for (auto actor : actorList) {
+			auto [it, inserted] = actorCollisions.try_emplace(actor->GetFormID());
+			if (!inserted)
+				continue;
+			if (auto previous = previousCollisions.find(actor->GetFormID()); previous != previousCollisions.end())
+				it->second = std::move(previous->second);
+			gathers.push_back({ actor, &it->second });
+		}
+		previousCollisions.clear();
+
+		// actor 3D and havok objects are only safe to read on this thread, the game may be updating them on others
+		for (auto [actor, result] : gathers) {
+			auto root = actor->Get3D(false);
+			result->active = root && playerPosition.GetDistance(actor->GetPosition()) <= settings.maxDistance;  // npc too far so skip
+			result->reused = false;
+			result->newShapes = 0;
+			if (!result->active) {
+				// out of range, do not keep its collision objects alive
+				result->root = nullptr;
+				result->bodies.clear();
+				continue;
+			}
+
+			// same 3D as last time, only the body positions need to be read again
+			if (root == result->root && RefreshBodies(*result, deltaTime)) {
+				result->reused = true;
+				continue;
+			}
+
+			result->root = root;
+			result->bodies.clear();
+			RE::BSVisit::TraverseScenegraphCollision(root, [&](RE::bhkNiCollisionObject* a_object) -> RE::BSVisit::BSVisitControl {
+				RE::NiPoint3 centerPos;
+				const RE::hkpShape* shape = nullptr;
+				if (GetShapeBound(a_object, centerPos, shape)) {
 					float radius;
-					if (GetShapeBound(a_object, centerPos, radius)) {
-						radius *= settings.RadiusMultiplier;
-						CollisionSData data{};
-						RE::NiPoint3 eyePosition{};
-						for (int eyeIndex = 0; eyeIndex < eyeCount; eyeIndex++) {
-							if (!REL::Module::IsVR()) {
-								eyePosition = state->GetRuntimeData().posAdjust.getEye();
-							} else
-								eyePosition = state->GetVRRuntimeData().posAdjust.getEye(eyeIndex);
-							data.centre[eyeIndex].x = centerPos.x - eyePosition.x;
-							data.centre[eyeIndex].y = centerPos.y - eyePosition.y;
-							data.centre[eyeIndex].z = centerPos.z - eyePosition.z;
-						}
-						data.radius = radius;
-						currentCollisionCount++;
-						collisionsData.push_back(data);
+					if (auto it = shapeRadiusCache.find(shape); it != shapeRadiusCache.end()) {
+						radius = it->second;
+					} else {
+						radius = GetShapeRadius(shape);
+						result->newShapes++;
 					}
-					return RE::BSVisit::BSVisitControl::kContinue;
-				});
+					result->bodies.push_back({ RE::NiPointer<RE::bhkNiCollisionObject>(a_object), shape, { { centerPos.x, centerPos.y, centerPos.z }, {}, radius } });
+				}
+				return RE::BSVisit::BSVisitControl::kContinue;
+			});
+		}
+
+		// shapes not seen in this update are dropped so a reused address can never return a stale radius
+		std::unordered_map<const RE::hkpShape*, float> usedShapes;
+		cachedShapeCount = 0;
+		for (auto& [formID, result] : actorCollisions) {
+			if (!result.active)
+				continue;
+			activeActorCount++;
+			reusedActorCount += result.reused;
+			cachedShapeCount += (std::uint32_t)result.bodies.size() - result.newShapes;
+			for (auto& body : result.bodies) {
+				usedShapes.try_emplace(body.shape, body.bounds.radius);
 			}
 		}
+		shapeRadiusCache = std::move(usedShapes);
+
+		gatherTime = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+	} else {
+		extrapolatedFrameCount++;
+	}
+
+	CollisionPacking::Vector3 eyePositions[2]{};
+	for (int eyeIndex = 0; eyeIndex < eyeCount; eyeIndex++) {
+		RE::NiPoint3 eyePosition;
+		if (!REL::Module::IsVR()) {
+			eyePosition = state->GetRuntimeData().posAdjust.getEye();
+		} else
+			eyePosition = state->GetVRRuntimeData().posAdjust.getEye(eyeIndex);
+		eyePositions[eyeIndex] = { eyePosition.x, eyePosition.y, eyePosition.z };
+	}
+
+	// bounds are kept in world space, moved along their last velocity on skipped frames and made relative to this frame's eye
+	float extrapolationTime = std::min(std::chrono::duration<float>(now - lastGatherTime).count(), 0.25f);
+	std::vector<const CollisionPacking::Bounds*> bodies;
+	for (auto& [formID, result] : actorCollisions) {
+		if (!result.active)
+			continue;
+		for (auto& body : result.bodies)
+			bodies.push_back(&body.bounds);
+	}
+
+	// only the gathered bounds are read from here on, no game objects, so the packing can run in parallel
+	currentCollisionCount = (std::uint32_t)bodies.size();
+	std::vector<CollisionGrid::Sphere> spheres;
+	CollisionPacking::Pack(bodies, eyePositions, (std::uint32_t)eyeCount, extrapolationTime, settings.RadiusMultiplier, collisionsData, spheres);
+
+	State::GetSingleton()->frameCapture.WriteArray(FrameCapture::RecordType::CollisionSpheres, spheres);
+	collisionGrid.Build(spheres);
+	for (int eyeIndex = 0; eyeIndex < eyeCount; eyeIndex++) {
+		gridOrigin[eyeIndex].x = collisionGrid.GetOriginX() - eyePositions[eyeIndex].x;
+		gridOrigin[eyeIndex].y = collisionGrid.GetOriginY() - eyePositions[eyeIndex].y;
+		gridOrigin[eyeIndex].z = collisionGrid.GetCellSize();
+		gridOrigin[eyeIndex].w = 0.0f;
 	}
+
 	if (!currentCollisionCount) {
 		CollisionSData data{};
 		ZeroMemory(&data, sizeof(data));
@@ -233,6 +394,11 @@ void GrassCollision::UpdateCollisions()
 	size_t bytes = sizeof(CollisionSData) * colllisionCount;
 	memcpy_s(mapped.pData, bytes, collisionsData.data(), bytes);
 	context->Unmap(collisions->resource.get(), 0);
+
+	auto& cells = collisionGrid.GetCells();
+	UpdateDynamicBuffer(gridCells, gridCellsCapacity, sizeof(CollisionGrid::CellRange), cells.data(), (std::uint32_t)cells.size());
+	auto& indices = collisionGrid.GetIndices();
+	UpdateDynamicBuffer(gridIndices, gridIndicesCapacity, sizeof(std::uint32_t), indices.data(), (std::uint32_t)indices.size());
 }
 
 void GrassCollision::ModifyGrass(const RE::BSShader*, const uint32_t)
@@ -263,6 +429,8 @@ void GrassCollision::ModifyGrass(const RE::BSShader*, const uint32_t)
 			perFrameData.boundCentre[eyeIndex].z = bound.center.z - eyePosition.z;
 			perFrameData.boundCentre[eyeIndex].w = 0.0f;
 		}
+		perFrameData.gridOrigin[0] = gridOrigin[0];
+		perFrameData.gridOrigin[1] = gridOrigin[1];
 		perFrameData.boundRadius = bound.radius * settings.RadiusMultiplier;
 
 		perFrameData.Settings = settings;
@@ -275,8 +443,10 @@ void GrassCollision::ModifyGrass(const RE::BSShader*, const uint32_t)
 	if (settings.EnableGrassCollision) {
 		auto context = RE::BSGraphics::Renderer::GetSingleton()->GetRuntimeData().context;
 
-		ID3D11ShaderResourceView* views[1]{};
+		ID3D11ShaderResourceView* views[3]{};
 		views[0] = collisions->srv.get();
+		views[1] = gridCells->srv.get();
+		views[2] = gridIndices->srv.get();
 		context->VSSetShaderResources(0, ARRAYSIZE(views), views);
 
 		ID3D11Buffer* buffers[1];
@@ -320,6 +490,11 @@ void GrassCollision::SetupResources()
 void GrassCollision::Reset()
 {
 	updatePerFrame = true;
+
+	// the cache holds references to collision objects, let go of them once nothing draws grass anymore
+	auto frameCount = RE::BSGraphics::State::GetSingleton()->uiFrameCount;
+	if (!actorCollisions.empty() && frameCount - lastGatherFrame > MAX_IDLE_FRAMES)
+		actorCollisions.clear();
 }
 
 bool GrassCollision::HasShaderDefine(RE::BSShader::Type shaderType)
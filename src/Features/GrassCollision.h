@@ -2,6 +2,8 @@
 
 #include "Buffer.h"
 #include "Feature.h"
+#include "Features/GrassCollision/CollisionGrid.h"
+#include "Features/GrassCollision/CollisionPacking.h"
 
 struct GrassCollision : Feature
 {
@@ -29,15 +31,28 @@ struct GrassCollision : Feature
 	struct alignas(16) PerFrame
 	{
 		Vector4 boundCentre[2];
+		Vector4 gridOrigin[2];  // eye relative xy origin of the collision grid, z is the cell size
 		float boundRadius;
 		Settings Settings;
 		float pad01[2];
 	};
 
-	struct CollisionSData
+	using CollisionSData = CollisionPacking::Sphere;
+
+	struct CollisionBody
+	{
+		RE::NiPointer<RE::bhkNiCollisionObject> object;
+		const RE::hkpShape* shape;
+		CollisionPacking::Bounds bounds;
+	};
+
+	struct ActorCollisions
 	{
-		Vector3 centre[2];
-		float radius;
+		const RE::NiAVObject* root = nullptr;  // the bodies are only gathered again when this changes, never dereferenced
+		std::vector<CollisionBody> bodies;
+		std::uint32_t newShapes = 0;
+		bool active = false;
+		bool reused = false;
 	};
 
 	std::unique_ptr<Buffer> collisions = nullptr;
@@ -46,6 +61,24 @@ struct GrassCollision : Feature
 	std::uint32_t currentCollisionCount = 0;
 	std::vector<RE::Actor*> actorList{};
 	std::vector<CollisionSData> collisionsData{};
+	std::unordered_map<const RE::hkpShape*, float> shapeRadiusCache{};  // shape extents are expensive to project, cached while the shape is in use
+	std::uint32_t cachedShapeCount = 0;
+	float gatherTime = 0.0f;
+
+	std::unordered_map<RE::FormID, ActorCollisions> actorCollisions{};
+	std::chrono::steady_clock::time_point lastGatherTime{};
+	std::uint32_t lastGatherFrame = 0;
+	static constexpr std::uint32_t MAX_IDLE_FRAMES = 60;  // cached collision objects are released when grass was not drawn for this long
+	std::uint32_t reusedActorCount = 0;
+	std::uint64_t gatheredFrameCount = 0;
+	std::uint64_t extrapolatedFrameCount = 0;
+
+	CollisionGrid collisionGrid;
+	Vector4 gridOrigin[2]{};
+	std::unique_ptr<Buffer> gridCells = nullptr;
+	std::unique_ptr<Buffer> gridIndices = nullptr;
+	std::uint32_t gridCellsCapacity = 0;
+	std::uint32_t gridIndicesCapacity = 0;
 	std::uint32_t colllisionCount = 0;
 
 	Settings settings;
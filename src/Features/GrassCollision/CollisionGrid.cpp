@@ -0,0 +1,66 @@
+#include "CollisionGrid.h"
+
+#include <algorithm>
+#include <limits>
+
+void CollisionGrid::Build(const std::vector<Sphere>& a_spheres)
+{
+	std::fill(cells.begin(), cells.end(), CellRange{ 0, 0 });
+	indices.clear();
+	maxCellCount = 0;
+
+	if (a_spheres.empty()) {
+		originX = originY = 0.0f;
+		cellSize = 1.0f;
+		return;
+	}
+
+	float minX = std::numeric_limits<float>::max();
+	float minY = std::numeric_limits<float>::max();
+	float maxX = std::numeric_limits<float>::lowest();
+	float maxY = std::numeric_limits<float>::lowest();
+	for (auto& sphere : a_spheres) {
+		minX = std::min(minX, sphere.x - sphere.radius);
+		minY = std::min(minY, sphere.y - sphere.radius);
+		maxX = std::max(maxX, sphere.x + sphere.radius);
+		maxY = std::max(maxY, sphere.y + sphere.radius);
+	}
+
+	originX = minX;
+	originY = minY;
+	cellSize = std::max(std::max(maxX - minX, maxY - minY) / GRID_SIZE, 1.0f);
+
+	auto getCell = [&](float a_value, float a_origin) {
+		return (std::uint32_t)std::clamp((int)((a_value - a_origin) / cellSize), 0, (int)GRID_SIZE - 1);
+	};
+
+	auto forEachCell = [&](const Sphere& a_sphere, auto&& a_func) {
+		auto x0 = getCell(a_sphere.x - a_sphere.radius, originX);
+		auto x1 = getCell(a_sphere.x + a_sphere.radius, originX);
+		auto y0 = getCell(a_sphere.y - a_sphere.radius, originY);
+		auto y1 = getCell(a_sphere.y + a_sphere.radius, originY);
+		for (auto y = y0; y <= y1; y++) {
+			for (auto x = x0; x <= x1; x++) {
+				a_func(cells[y * GRID_SIZE + x]);
+			}
+		}
+	};
+
+	// counting sort: size each cell, prefix sum into offsets, then scatter the indices
+	for (auto& sphere : a_spheres) {
+		forEachCell(sphere, [](CellRange& cell) { cell.count++; });
+	}
+
+	std::uint32_t offset = 0;
+	for (auto& cell : cells) {
+		cell.offset = offset;
+		offset += cell.count;
+		maxCellCount = std::max(maxCellCount, cell.count);
+		cell.count = 0;
+	}
+
+	indices.resize(offset);
+	for (std::uint32_t i = 0; i < (std::uint32_t)a_spheres.size(); i++) {
+		forEachCell(a_spheres[i], [&](CellRange& cell) { indices[cell.offset + cell.count++] = i; });
+	}
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Coarse 2D binning of collision spheres, so a grass vertex only tests the colliders overlapping its cell.
+class CollisionGrid
+{
+public:
+	static constexpr std::uint32_t GRID_SIZE = 16;  // must match GridSize in GrassCollision.hlsli
+
+	struct Sphere
+	{
+		float x;
+		float y;
+		float radius;
+	};
+
+	struct CellRange
+	{
+		std::uint32_t offset;
+		std::uint32_t count;
+	};
+
+	// Fits the grid around the horizontal footprint of the spheres and bins every sphere into each cell it overlaps
+	void Build(const std::vector<Sphere>& a_spheres);
+
+	const std::vector<CellRange>& GetCells() const { return cells; }
+	const std::vector<std::uint32_t>& GetIndices() const { return indices; }
+	float GetOriginX() const { return originX; }
+	float GetOriginY() const { return originY; }
+	float GetCellSize() const { return cellSize; }
+	std::uint32_t GetMaxCellCount() const { return maxCellCount; }
+
+private:
+	std::vector<CellRange> cells = std::vector<CellRange>(GRID_SIZE * GRID_SIZE);
+	std::vector<std::uint32_t> indices;  // sphere indices, grouped by cell
+	float originX = 0.0f;
+	float originY = 0.0f;
+	float cellSize = 1.0f;
+	std::uint32_t maxCellCount = 0;
+};
@@ -0,0 +1,39 @@
+#include "CollisionPacking.h"
+
+#include <algorithm>
+#include <execution>
+
+namespace CollisionPacking
+{
+	void Move(Bounds& a_bounds, const Vector3& a_centre, float a_deltaTime)
+	{
+		if (a_deltaTime > 0.0f) {
+			a_bounds.velocity = { (a_centre.x - a_bounds.centre.x) / a_deltaTime, (a_centre.y - a_bounds.centre.y) / a_deltaTime, (a_centre.z - a_bounds.centre.z) / a_deltaTime };
+		} else {
+			a_bounds.velocity = {};
+		}
+		a_bounds.centre = a_centre;
+	}
+
+	void Pack(const std::vector<const Bounds*>& a_bounds, const Vector3 a_eyes[2], std::uint32_t a_eyeCount, float a_extrapolationTime, float a_radiusMultiplier,
+		std::vector<Sphere>& a_spheres, std::vector<CollisionGrid::Sphere>& a_gridSpheres)
+	{
+		a_spheres.resize(a_bounds.size());
+		a_gridSpheres.resize(a_bounds.size());
+		std::for_each(std::execution::par_unseq, a_bounds.begin(), a_bounds.end(), [&](const Bounds* const& bounds) {
+			auto index = &bounds - a_bounds.data();
+			Vector3 centre{
+				bounds->centre.x + bounds->velocity.x * a_extrapolationTime,
+				bounds->centre.y + bounds->velocity.y * a_extrapolationTime,
+				bounds->centre.z + bounds->velocity.z * a_extrapolationTime
+			};
+
+			Sphere sphere{};
+			for (std::uint32_t eyeIndex = 0; eyeIndex < a_eyeCount; eyeIndex++)
+				sphere.centre[eyeIndex] = { centre.x - a_eyes[eyeIndex].x, centre.y - a_eyes[eyeIndex].y, centre.z - a_eyes[eyeIndex].z };
+			sphere.radius = bounds->radius * a_radiusMultiplier;
+			a_spheres[index] = sphere;
+			a_gridSpheres[index] = { centre.x, centre.y, sphere.radius };
+		});
+	}
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "CollisionGrid.h"
+
+#include <cstdint>
+#include <vector>
+
+// The part of GrassCollision::UpdateCollisions after the game objects were read: moving the gathered bounds and packing
+// them into the collision buffer and grid of GrassCollision.hlsli.
+namespace CollisionPacking
+{
+	struct Vector3
+	{
+		float x = 0.0f;
+		float y = 0.0f;
+		float z = 0.0f;
+	};
+
+	// A collision body in world space at the last gather
+	struct Bounds
+	{
+		Vector3 centre;
+		Vector3 velocity;  // world units per second between the last two gathers
+		float radius = 0.0f;
+	};
+
+	// Element of the collision buffer, relative to each eye
+	struct Sphere
+	{
+		Vector3 centre[2];
+		float radius;
+	};
+	static_assert(sizeof(Sphere) == 28, "must match StructuredCollision in GrassCollision.hlsli");
+
+	// Moves a_bounds to a newly read centre, the velocity is only known when there is a previous gather to compare with
+	void Move(Bounds& a_bounds, const Vector3& a_centre, float a_deltaTime);
+
+	// Extrapolates every body by a_extrapolationTime and makes it relative to each eye, in parallel as it reads no game objects.
+	// a_gridSpheres gets the world space footprint of the same spheres for CollisionGrid::Build.
+	void Pack(const std::vector<const Bounds*>& a_bounds, const Vector3 a_eyes[2], std::uint32_t a_eyeCount, float a_extrapolationTime, float a_radiusMultiplier,
+		std::vector<Sphere>& a_spheres, std::vector<CollisionGrid::Sphere>& a_gridSpheres);
+}
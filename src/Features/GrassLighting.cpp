@@ -139,7 +139,7 @@ void GrassLighting::RestoreDefaultSettings()
 
 void GrassLighting::SetupResources()
 {
-	perFrame = new ConstantBuffer(ConstantBufferDesc<PerFrame>());
+	perFrame = std::make_unique<SettingsBlock<PerFrame>>(SettingsBlock<PerFrame>::Kind::Constant);
 }
 
 void GrassLighting::Reset()
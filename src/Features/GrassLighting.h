@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Buffer.h"
+#include "SettingsBlock.h"
 #include "Feature.h"
 
 struct GrassLighting : Feature
@@ -35,7 +36,7 @@ struct GrassLighting : Feature
 	Settings settings;
 
 	bool updatePerFrame = false;
-	ConstantBuffer* perFrame = nullptr;
+	std::unique_ptr<SettingsBlock<PerFrame>> perFrame = nullptr;
 	virtual void SetupResources();
 	virtual void Reset();
 
@@ -0,0 +1,145 @@
+#include "LightGathering.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace LightGathering
+{
+	namespace
+	{
+		Vector3 operator+(const Vector3& a_left, const Vector3& a_right) { return { a_left.x + a_right.x, a_left.y + a_right.y, a_left.z + a_right.z }; }
+		Vector3 operator-(const Vector3& a_left, const Vector3& a_right) { return { a_left.x - a_right.x, a_left.y - a_right.y, a_left.z - a_right.z }; }
+		Vector3 operator*(const Vector3& a_vector, float a_scale) { return { a_vector.x * a_scale, a_vector.y * a_scale, a_vector.z * a_scale }; }
+		Vector3 operator/(const Vector3& a_vector, float a_scale) { return { a_vector.x / a_scale, a_vector.y / a_scale, a_vector.z / a_scale }; }
+
+		float Length(const Vector3& a_vector)
+		{
+			return std::sqrt(a_vector.x * a_vector.x + a_vector.y * a_vector.y + a_vector.z * a_vector.z);
+		}
+
+		float Dimmer(float a_distance, float a_start, float a_end)
+		{
+			if (a_distance < a_start || a_end == 0.0f)
+				return 1.0f;
+			if (a_distance <= a_end)
+				return 1.0f - ((a_distance - a_start) / (a_end - a_start));
+			return 0.0f;
+		}
+
+		bool IsVisible(const Light& a_light)
+		{
+			return (a_light.color.x + a_light.color.y + a_light.color.z) > 1e-4 && a_light.radius > 1e-4;
+		}
+
+		void AddParticleLight(const Camera& a_camera, Light& a_light, std::vector<Light>& a_lights)
+		{
+			float distance = GetDistance(a_light.positionWS[0], a_light.radius);
+			a_light.color = a_light.color * GetFadeDimmer(distance, a_camera);
+			a_light.color = a_light.color * GetDistantDimmer(distance, a_camera);
+			if (IsVisible(a_light))
+				a_lights.push_back(a_light);
+		}
+
+		// Running sums of the mesh particles merged so far
+		struct Cluster
+		{
+			Vector3 color;
+			float radius = 0.0f;
+			Vector3 positionWS;
+			std::uint32_t count = 0;
+
+			void Flush(const Camera& a_camera, std::vector<Light>& a_lights)
+			{
+				if (!count)
+					return;
+				Light light{};
+				light.source = Source::Cluster;
+				light.color = color;
+				light.radius = radius / (float)count;
+				light.positionWS[0] = positionWS / (float)count;
+				light.positionWS[1] = light.positionWS[0];
+				if (a_camera.eyeCount == 2)
+					light.positionWS[1] = light.positionWS[1] + (a_camera.posAdjust[0] - a_camera.posAdjust[1]) / (float)count;
+				AddParticleLight(a_camera, light, a_lights);
+				*this = {};
+			}
+		};
+	}
+
+	Vector3 Saturation(Vector3 a_color, float a_saturation)
+	{
+		float grey = a_color.x * 0.3f + a_color.y * 0.59f + a_color.z * 0.11f;
+		a_color.x = std::max(std::lerp(grey, a_color.x, a_saturation), 0.0f);
+		a_color.y = std::max(std::lerp(grey, a_color.y, a_saturation), 0.0f);
+		a_color.z = std::max(std::lerp(grey, a_color.z, a_saturation), 0.0f);
+		return a_color;
+	}
+
+	float GetDistance(const Vector3& a_positionWS, float a_radius)
+	{
+		return (a_positionWS.x * a_positionWS.x) + (a_positionWS.y * a_positionWS.y) + (a_positionWS.z * a_positionWS.z) - (a_radius * a_radius);
+	}
+
+	float GetFadeDimmer(float a_distance, const Camera& a_camera)
+	{
+		return Dimmer(a_distance, a_camera.lightFadeStart, a_camera.lightFadeEnd);
+	}
+
+	float GetDistantDimmer(float a_distance, const Camera& a_camera)
+	{
+		float distantLightFadeStart = a_camera.lightsFar * a_camera.lightsFar * (a_camera.lightFadeStart / a_camera.lightFadeEnd);
+		float distantLightFadeEnd = a_camera.lightsFar * a_camera.lightsFar;
+		return Dimmer(a_distance, distantLightFadeStart, distantLightFadeEnd);
+	}
+
+	void Gather(const Camera& a_camera, const Settings& a_settings, const std::vector<PointLight>& a_pointLights, const std::vector<ParticleLight>& a_particleLights, std::vector<Light>& a_lights)
+	{
+		auto eyeCount = std::min(a_camera.eyeCount, 2u);
+
+		for (std::uint32_t i = 0; i < a_pointLights.size(); i++) {
+			auto& pointLight = a_pointLights[i];
+			Light light{};
+			light.index = i;
+			light.color = pointLight.color;
+			light.radius = pointLight.radius;
+			for (std::uint32_t eyeIndex = 0; eyeIndex < eyeCount; eyeIndex++)
+				light.positionWS[eyeIndex] = pointLight.position - a_camera.posAdjust[eyeIndex];
+
+			light.color = light.color * GetDistantDimmer(GetDistance(light.positionWS[0], light.radius), a_camera);
+			if (IsVisible(light)) {
+				light.firstPersonShadow = pointLight.firstPersonShadow;
+				a_lights.push_back(light);
+			}
+		}
+
+		Cluster cluster;
+		for (std::uint32_t i = 0; i < a_particleLights.size(); i++) {
+			auto& particleLight = a_particleLights[i];
+			if (particleLight.billboard) {
+				Light light{};
+				light.source = Source::Billboard;
+				light.index = i;
+				light.color = Saturation(particleLight.color, a_settings.particleLightsSaturation) * particleLight.alpha;
+				light.radius = particleLight.radius * a_settings.particleLightsRadiusBillboards;
+				for (std::uint32_t eyeIndex = 0; eyeIndex < eyeCount; eyeIndex++)
+					light.positionWS[eyeIndex] = particleLight.position - a_camera.posAdjust[eyeIndex];
+				AddParticleLight(a_camera, light, a_lights);
+				continue;
+			}
+
+			auto positionWS = particleLight.position - a_camera.posAdjust[0];
+			if (cluster.count) {
+				float radiusDiff = std::abs(cluster.radius / (float)cluster.count - particleLight.radius);
+				float positionDiff = Length(positionWS - cluster.positionWS / (float)cluster.count);
+				if ((radiusDiff + positionDiff) > a_settings.particleLightsOptimisationClusterRadius || !a_settings.enableParticleLightsOptimization)
+					cluster.Flush(a_camera, a_lights);
+			}
+
+			cluster.color = cluster.color + Saturation(particleLight.color, a_settings.particleLightsSaturation) * particleLight.alpha;
+			cluster.radius += particleLight.radius * particleLight.radiusMult;
+			cluster.positionWS = cluster.positionWS + positionWS;
+			cluster.count++;
+		}
+		cluster.Flush(a_camera, a_lights);
+	}
+}
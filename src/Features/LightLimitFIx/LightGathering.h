@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// The CPU side of LightLimitFix::UpdateLights that needs no game objects: the distance fades of point and particle lights
+// and the merging of mesh particles into clustered lights. Its inputs are what a frame capture records for the light list.
+namespace LightGathering
+{
+	struct Vector3
+	{
+		float x = 0.0f;
+		float y = 0.0f;
+		float z = 0.0f;
+	};
+
+	struct Camera
+	{
+		Vector3 posAdjust[2];  // eye positions, light positions are relative to them
+		std::uint32_t eyeCount = 1;
+		float lightsNear = 0.0f;
+		float lightsFar = 16384.0f;
+		float lightFadeStart = 0.0f;  // squared distances of the game's light fade
+		float lightFadeEnd = 0.0f;
+	};
+
+	struct Settings
+	{
+		float particleLightsSaturation = 1.0f;
+		float particleLightsRadiusBillboards = 1.0f;
+		std::uint32_t enableParticleLightsOptimization = 1;
+		float particleLightsOptimisationClusterRadius = 32.0f;
+	};
+
+	struct PointLight
+	{
+		Vector3 position;  // world space
+		float radius = 0.0f;
+		Vector3 color;  // with the light's fade and LOD dimmer
+		std::uint32_t firstPersonShadow = 0;
+	};
+
+	struct ParticleLight
+	{
+		Vector3 position;  // world space
+		float radius = 0.0f;
+		float radiusMult = 1.0f;  // of the particle's config, mesh particles only
+		Vector3 color;
+		float alpha = 1.0f;
+		std::uint32_t billboard = 0;  // billboards are never clustered and use the billboard radius setting
+	};
+
+	enum class Source : std::uint32_t
+	{
+		PointLight,
+		Cluster,
+		Billboard,
+	};
+
+	struct Light
+	{
+		Vector3 color;
+		float radius = 0.0f;
+		Vector3 positionWS[2];
+		std::uint32_t firstPersonShadow = 0;
+		Source source = Source::PointLight;
+		std::uint32_t index = 0;  // of the point light or billboard it was made from
+	};
+
+	Vector3 Saturation(Vector3 a_color, float a_saturation);
+
+	// Squared distance to the eye minus the squared radius
+	float GetDistance(const Vector3& a_positionWS, float a_radius);
+
+	// The game's light fade, particle lights only
+	float GetFadeDimmer(float a_distance, const Camera& a_camera);
+
+	// Fade towards the far plane of the light clusters
+	float GetDistantDimmer(float a_distance, const Camera& a_camera);
+
+	// Appends the lights left after the fades, point lights first and then particle lights in order.
+	// Consecutive mesh particles are merged while they stay within the cluster radius of the running average.
+	void Gather(const Camera& a_camera, const Settings& a_settings, const std::vector<PointLight>& a_pointLights, const std::vector<ParticleLight>& a_particleLights, std::vector<Light>& a_lights);
+}
@@ -0,0 +1,74 @@
+#include "ParticleLightConfigs.h"
+
+#include <cctype>
+#include <fstream>
+
+std::string_view ParticleLightConfigs::GetStem(std::string_view a_path, std::span<char> a_buffer)
+{
+	auto lastSeparatorPos = a_path.find_last_of("\\/");
+	if (lastSeparatorPos == std::string_view::npos)
+		return {};
+
+	auto filename = a_path.substr(lastSeparatorPos + 1);
+	if (filename.size() < 4 || filename.size() - 4 > a_buffer.size())
+		return {};
+
+	auto stem = filename.substr(0, filename.size() - 4);  // Remove the extension
+	std::transform(stem.begin(), stem.end(), a_buffer.begin(), [](char c) { return (char)std::tolower((unsigned char)c); });
+	return { a_buffer.data(), stem.size() };
+}
+
+std::uint64_t ParticleLightConfigs::GetKey(std::span<const std::vector<std::string>* const> a_lists)
+{
+	std::uint64_t key = 0xcbf29ce484222325ull;
+	auto hash = [&](const void* a_data, size_t a_size) {
+		for (size_t i = 0; i < a_size; i++) {
+			key ^= static_cast<const std::uint8_t*>(a_data)[i];
+			key *= 0x100000001b3ull;
+		}
+	};
+	for (auto* paths : a_lists) {
+		auto count = paths->size();
+		hash(&count, sizeof(count));
+		for (auto& path : *paths) {
+			std::error_code ec;
+			auto size = std::filesystem::file_size(path, ec);
+			auto writeTime = std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+			hash(path.data(), path.size() + 1);
+			hash(&size, sizeof(size));
+			hash(&writeTime, sizeof(writeTime));
+		}
+	}
+	return key;
+}
+
+bool ParticleLightConfigs::WriteFile(const std::filesystem::path& a_path, const std::string& a_contents)
+{
+	std::error_code ec;
+	std::filesystem::create_directories(a_path.parent_path(), ec);
+	auto temporaryPath = a_path;
+	temporaryPath += ".tmp";
+	{
+		std::ofstream file{ temporaryPath, std::ios::binary | std::ios::trunc };
+		if (!file)
+			return false;
+		file.write(a_contents.data(), a_contents.size());
+		file.flush();
+		if (!file)
+			return false;
+	}
+	std::filesystem::rename(temporaryPath, a_path, ec);
+	if (ec) {
+		std::filesystem::remove(temporaryPath, ec);
+		return false;
+	}
+	return true;
+}
+
+std::optional<std::string> ParticleLightConfigs::ReadFile(const std::filesystem::path& a_path)
+{
+	std::ifstream file{ a_path, std::ios::binary };
+	if (!file)
+		return std::nullopt;
+	return std::string{ std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+}
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <execution>
+#include <filesystem>
+#include <numeric>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+// Loading of the particle light inis independent of how a single ini is parsed: the inis are parsed in parallel, inserted
+// by lowercase texture stem and kept in one cache file keyed by the list of inis with their sizes and write times.
+namespace ParticleLightConfigs
+{
+	// allows looking up a texture stem without building a string for it
+	struct StemHash
+	{
+		using is_transparent = void;
+		size_t operator()(std::string_view a_stem) const { return std::hash<std::string_view>{}(a_stem); }
+	};
+
+	// keyed by lowercase texture stems, e.g. "fxfire01" for "Effects\FXFire01.dds"
+	template <class T>
+	using Map = std::unordered_map<std::string, T, StemHash, std::equal_to<>>;
+
+	constexpr std::uint32_t CACHE_MAGIC = 0x46434C50;  // "PLCF"
+	constexpr std::uint32_t CACHE_VERSION = 1;
+	constexpr std::uint32_t MAX_STEM = 260;
+
+	// Lowercase file name without its extension written into the buffer, empty if the path has no directory or is too short
+	std::string_view GetStem(std::string_view a_path, std::span<char> a_buffer);
+
+	// Changes with any added, removed or edited ini
+	std::uint64_t GetKey(std::span<const std::vector<std::string>* const> a_lists);
+
+	// Written next to the target and renamed over it, so an interrupted write leaves the previous cache or none
+	bool WriteFile(const std::filesystem::path& a_path, const std::string& a_contents);
+	std::optional<std::string> ReadFile(const std::filesystem::path& a_path);
+
+	// Parses every ini in parallel, they are independent of each other
+	template <class T, class Parse>
+	std::vector<std::optional<T>> ParseAll(const std::vector<std::string>& a_paths, Parse a_parse)
+	{
+		std::vector<std::optional<T>> parsed(a_paths.size());
+		std::vector<size_t> indices(a_paths.size());
+		std::iota(indices.begin(), indices.end(), size_t{ 0 });
+		std::for_each(std::execution::par, indices.begin(), indices.end(), [&](size_t i) { parsed[i] = a_parse(a_paths[i]); });
+		return parsed;
+	}
+
+	// Inserts in the order of the paths, the first ini for a stem wins as when they were loaded one by one.
+	// Returns the paths that have no stem.
+	template <class T>
+	std::vector<std::string> Insert(Map<T>& a_map, const std::vector<std::string>& a_paths, std::vector<std::optional<T>>& a_parsed)
+	{
+		std::vector<std::string> incomplete;
+		for (size_t i = 0; i < a_paths.size(); i++) {
+			if (!a_parsed[i])
+				continue;
+			char buffer[MAX_STEM];
+			auto stem = GetStem(a_paths[i], buffer);
+			if (stem.empty())
+				incomplete.push_back(a_paths[i]);
+			else
+				a_map.try_emplace(std::string(stem), *a_parsed[i]);
+		}
+		return incomplete;
+	}
+
+	template <class T>
+	void AppendEntries(std::string& a_bytes, const Map<T>& a_entries)
+	{
+		static_assert(std::is_trivially_copyable_v<T>);
+		auto count = static_cast<std::uint32_t>(a_entries.size());
+		a_bytes.append(reinterpret_cast<const char*>(&count), sizeof(count));
+		for (auto& [stem, entry] : a_entries) {
+			auto length = static_cast<std::uint32_t>(stem.size());
+			a_bytes.append(reinterpret_cast<const char*>(&length), sizeof(length));
+			a_bytes.append(stem);
+			a_bytes.append(reinterpret_cast<const char*>(&entry), sizeof(T));
+		}
+	}
+
+	// Reads entries written by AppendEntries into a_entries, keeping entries already there
+	template <class T>
+	bool ExtractEntries(std::string_view& a_bytes, Map<T>& a_entries)
+	{
+		auto read = [&](void* a_data, size_t a_size) {
+			if (a_bytes.size() < a_size)
+				return false;
+			std::memcpy(a_data, a_bytes.data(), a_size);
+			a_bytes.remove_prefix(a_size);
+			return true;
+		};
+
+		std::uint32_t count = 0;
+		if (!read(&count, sizeof(count)))
+			return false;
+		Map<T> entries;
+		entries.reserve(count);
+		for (std::uint32_t i = 0; i < count; i++) {
+			std::uint32_t length = 0;
+			if (!read(&length, sizeof(length)) || length > MAX_STEM || a_bytes.size() < length)
+				return false;
+			std::string stem{ a_bytes.substr(0, length) };
+			a_bytes.remove_prefix(length);
+			T entry;
+			if (!read(&entry, sizeof(T)))
+				return false;
+			entries.try_emplace(std::move(stem), entry);
+		}
+		for (auto& [stem, entry] : entries)
+			a_entries.try_emplace(stem, entry);
+		return true;
+	}
+
+	template <class TConfig, class TGradient>
+	bool WriteCache(const std::filesystem::path& a_path, std::uint64_t a_key, const Map<TConfig>& a_configs, const Map<TGradient>& a_gradientConfigs)
+	{
+		std::string bytes;
+		bytes.append(reinterpret_cast<const char*>(&CACHE_MAGIC), sizeof(CACHE_MAGIC));
+		bytes.append(reinterpret_cast<const char*>(&CACHE_VERSION), sizeof(CACHE_VERSION));
+		bytes.append(reinterpret_cast<const char*>(&a_key), sizeof(a_key));
+		AppendEntries(bytes, a_configs);
+		AppendEntries(bytes, a_gradientConfigs);
+		return WriteFile(a_path, bytes);
+	}
+
+	// Fills the maps from a cache written with the same key, they are only changed if the whole file is valid
+	template <class TConfig, class TGradient>
+	bool ReadCache(const std::filesystem::path& a_path, std::uint64_t a_key, Map<TConfig>& a_configs, Map<TGradient>& a_gradientConfigs)
+	{
+		auto contents = ReadFile(a_path);
+		if (!contents)
+			return false;
+
+		std::string_view bytes = *contents;
+		std::uint32_t header[2]{};
+		std::uint64_t key = 0;
+		if (bytes.size() < sizeof(header) + sizeof(key))
+			return false;
+		std::memcpy(header, bytes.data(), sizeof(header));
+		std::memcpy(&key, bytes.data() + sizeof(header), sizeof(key));
+		if (header[0] != CACHE_MAGIC || header[1] != CACHE_VERSION || key != a_key)
+			return false;
+		bytes.remove_prefix(sizeof(header) + sizeof(key));
+
+		Map<TConfig> configs;
+		Map<TGradient> gradientConfigs;
+		if (!ExtractEntries(bytes, configs) || !ExtractEntries(bytes, gradientConfigs) || !bytes.empty())
+			return false;
+		for (auto& [stem, config] : configs)
+			a_configs.try_emplace(stem, config);
+		for (auto& [stem, config] : gradientConfigs)
+			a_gradientConfigs.try_emplace(stem, config);
+		return true;
+	}
+}
@@ -1,146 +1,140 @@
-#include "Features/LightLimitFix/ParticleLights.h"
+#include "Features/LightLimitFIx/ParticleLights.h"
 
 #include <numbers>
 
+namespace
+{
+	const std::filesystem::path CacheFilePath = "Data/ShaderCache/ParticleLights.bin";
+}
+
+std::optional<ParticleLights::Config> ParticleLights::ParseConfig(const std::string& a_path)
+{
+	logger::info("[LLF] loading ini : {}", a_path);
+
+	CSimpleIniA ini;
+	ini.SetUnicode();
+	ini.SetMultiKey();
+
+	if (const auto rc = ini.LoadFile(a_path.c_str()); rc < 0) {
+		logger::error("\t\t[LLF] couldn't read INI");
+		return std::nullopt;
+	}
+
+	Config data{};
+	data.cull = ini.GetBoolValue("Light", "Cull", false);
+	data.colorMult.red = (float)ini.GetDoubleValue("Light", "ColorMultRed", 1.0);
+	data.colorMult.green = (float)ini.GetDoubleValue("Light", "ColorMultGreen", 1.0);
+	data.colorMult.blue = (float)ini.GetDoubleValue("Light", "ColorMultBlue", 1.0);
+	data.radiusMult = (float)ini.GetDoubleValue("Light", "RadiusMult", 1.0);
+	data.saturationMult = (float)ini.GetDoubleValue("Light", "SaturationMult", 1.0);
+	data.flicker = ini.GetBoolValue("Light", "Flicker", false);
+	data.flickerSpeed = (float)ini.GetDoubleValue("Light", "FlickerSpeed", 1.0);
+	data.flickerIntensity = (float)ini.GetDoubleValue("Light", "FlickerIntensity", 0.0);
+	data.flickerMovement = (float)ini.GetDoubleValue("Light", "FlickerMovement", 0.0) / std::numbers::pi_v<float>;
+	return data;
+}
+
+std::optional<ParticleLights::GradientConfig> ParticleLights::ParseGradientConfig(const std::string& a_path)
+{
+	logger::info("[LLF] loading ini : {}", a_path);
+
+	CSimpleIniA ini;
+	ini.SetUnicode();
+	ini.SetMultiKey();
+
+	if (const auto rc = ini.LoadFile(a_path.c_str()); rc < 0) {
+		logger::error("\t\t[LLF] couldn't read INI");
+		return std::nullopt;
+	}
+
+	GradientConfig data{};
+	const char* value = nullptr;
+	constexpr std::string_view prefix1 = "0x";
+	constexpr std::string_view prefix2 = "#";
+	constexpr std::string_view cset = "0123456789ABCDEFabcdef";
+
+	value = ini.GetValue("Gradient", "Color");
+	if (value && strcmp(value, "") != 0) {
+		std::string_view str = value;
+
+		if (str.starts_with(prefix1)) {
+			str.remove_prefix(prefix1.size());
+		}
+
+		if (str.starts_with(prefix2)) {
+			str.remove_prefix(prefix2.size());
+		}
+
+		bool matches = std::strspn(str.data(), cset.data()) == str.size();
+
+		if (matches) {
+			uint32_t color = std::stoi(str.data(), 0, 16);
+			data.color = color;
+		} else {
+			logger::error("[LLF] invalid color");
+			return std::nullopt;
+		}
+	} else {
+		logger::error("[LLF] missing color");
+		return std::nullopt;
+	}
+	return data;
+}
+
 void ParticleLights::GetConfigs()
 {
+	std::vector<std::string> configs;
+	std::vector<std::string> gradientConfigs;
+	if (std::filesystem::exists("Data\\ParticleLights"))
+		configs = clib_util::distribution::get_configs("Data\\ParticleLights", "", ".ini");
+	if (!configs.empty() && std::filesystem::exists("Data\\ParticleLights\\Gradients"))
+		gradientConfigs = clib_util::distribution::get_configs("Data\\ParticleLights\\Gradients", "", ".ini");
+
+	const std::vector<std::string>* lists[] = { &configs, &gradientConfigs };
+	auto key = ParticleLightConfigs::GetKey(lists);
+	if (!configs.empty() && ParticleLightConfigs::ReadCache(CacheFilePath, key, particleLightConfigs, particleLightGradientConfigs)) {
+		logger::info("[LLF] Loaded {} particle lights configs and {} gradients configs from cache", particleLightConfigs.size(), particleLightGradientConfigs.size());
+		return;
+	}
+
+	auto insertConfigs = [](auto& a_map, const std::vector<std::string>& a_paths, auto a_parse) {
+		using ConfigType = typename std::decay_t<decltype(a_map)>::mapped_type;
+		auto parsed = ParticleLightConfigs::ParseAll<ConfigType>(a_paths, a_parse);
+		for (auto& path : ParticleLightConfigs::Insert(a_map, a_paths, parsed))
+			logger::error("[LLF] Path incomplete {}", path);
+	};
+
+	auto writeCache = [&] {
+		if (!ParticleLightConfigs::WriteCache(CacheFilePath, key, particleLightConfigs, particleLightGradientConfigs))
+			logger::warn("[LLF] Failed to write particle lights cache {}", CacheFilePath.string());
+	};
+
 	if (std::filesystem::exists("Data\\ParticleLights")) {
 		logger::info("[LLF] Loading particle lights configs");
 
-		auto configs = clib_util::distribution::get_configs("Data\\ParticleLights", "", ".ini");
-
 		if (configs.empty()) {
 			logger::warn("[LLF] No .ini files were found within the Data\\ParticleLights folder, aborting...");
 			return;
 		}
 
 		logger::info("[LLF] {} matching inis found", configs.size());
-
-		for (auto& path : configs) {
-			logger::info("[LLF] loading ini : {}", path);
-
-			CSimpleIniA ini;
-			ini.SetUnicode();
-			ini.SetMultiKey();
-
-			if (const auto rc = ini.LoadFile(path.c_str()); rc < 0) {
-				logger::error("\t\t[LLF] couldn't read INI");
-				continue;
-			}
-
-			Config data{};
-			particleLightConfigs.insert({ "default", data });
-
-			data.cull = ini.GetBoolValue("Light", "Cull", false);
-			data.colorMult.red = (float)ini.GetDoubleValue("Light", "ColorMultRed", 1.0);
-			data.colorMult.green = (float)ini.GetDoubleValue("Light", "ColorMultGreen", 1.0);
-			data.colorMult.blue = (float)ini.GetDoubleValue("Light", "ColorMultBlue", 1.0);
-			data.radiusMult = (float)ini.GetDoubleValue("Light", "RadiusMult", 1.0);
-			data.saturationMult = (float)ini.GetDoubleValue("Light", "SaturationMult", 1.0);
-			data.flicker = ini.GetBoolValue("Light", "Flicker", false);
-			data.flickerSpeed = (float)ini.GetDoubleValue("Light", "FlickerSpeed", 1.0);
-			data.flickerIntensity = (float)ini.GetDoubleValue("Light", "FlickerIntensity", 0.0);
-			data.flickerMovement = (float)ini.GetDoubleValue("Light", "FlickerMovement", 0.0) / std::numbers::pi_v<float>;
-
-			auto lastSeparatorPos = path.find_last_of("\\/");
-			if (lastSeparatorPos != std::string::npos) {
-				std::string filename = path.substr(lastSeparatorPos + 1);
-				if (filename.size() < 4) {
-					logger::error("[LLF] Path too short");
-					continue;
-				}
-
-				filename.erase(filename.length() - 4);  // Remove ".ini"
-#pragma warning(push)
-#pragma warning(disable: 4244)
-				std::transform(filename.begin(), filename.end(), filename.begin(), ::tolower);
-#pragma warning(pop)
-
-				logger::debug("[LLF] Inserting {}", filename);
-
-				particleLightConfigs.insert({ filename, data });
-			} else {
-				logger::error("[LLF] Path incomplete");
-			}
-		}
+		particleLightConfigs.insert({ "default", Config{} });
+		insertConfigs(particleLightConfigs, configs, &ParticleLights::ParseConfig);
 	}
 
 	if (std::filesystem::exists("Data\\ParticleLights\\Gradients")) {
 		logger::info("[LLF] Loading particle lights gradients configs");
 
-		auto configs = clib_util::distribution::get_configs("Data\\ParticleLights\\Gradients", "", ".ini");
-
-		if (configs.empty()) {
+		if (gradientConfigs.empty()) {
 			logger::warn("[LLF] No .ini files were found within the Data\\ParticleLights\\Gradients folder, aborting...");
+			writeCache();
 			return;
 		}
 
-		logger::info("[LLF] {} matching inis found", configs.size());
-
-		for (auto& path : configs) {
-			logger::info("[LLF] loading ini : {}", path);
-
-			CSimpleIniA ini;
-			ini.SetUnicode();
-			ini.SetMultiKey();
-
-			if (const auto rc = ini.LoadFile(path.c_str()); rc < 0) {
-				logger::error("\t\t[LLF] couldn't read INI");
-				continue;
-			}
-
-			GradientConfig data{};
-			const char* value = nullptr;
-			constexpr std::string_view prefix1 = "0x";
-			constexpr std::string_view prefix2 = "#";
-			constexpr std::string_view cset = "0123456789ABCDEFabcdef";
-
-			value = ini.GetValue("Gradient", "Color");
-			if (value && strcmp(value, "") != 0) {
-				std::string_view str = value;
-
-				if (str.starts_with(prefix1)) {
-					str.remove_prefix(prefix1.size());
-				}
-
-				if (str.starts_with(prefix2)) {
-					str.remove_prefix(prefix2.size());
-				}
-
-				bool matches = std::strspn(str.data(), cset.data()) == str.size();
-
-				if (matches) {
-					uint32_t color = std::stoi(str.data(), 0, 16);
-					data.color = color;
-				} else {
-					logger::error("[LLF] invalid color");
-					continue;
-				}
-			} else {
-				logger::error("[LLF] missing color");
-				continue;
-			}
-
-			auto lastSeparatorPos = path.find_last_of("\\/");
-			if (lastSeparatorPos != std::string::npos) {
-				std::string filename = path.substr(lastSeparatorPos + 1);
-				if (filename.size() < 4) {
-					logger::error("[LLF] Path too short");
-					continue;
-				}
-
-				filename.erase(filename.length() - 4);  // Remove ".ini"
-#pragma warning(push)
-#pragma warning(disable: 4244)
-				std::transform(filename.begin(), filename.end(), filename.begin(), ::tolower);
-#pragma warning(pop)
-
-				logger::debug("[LLF] Inserting {}", filename);
-
-				particleLightGradientConfigs.insert({ filename, data });
-			} else {
-				logger::error("[LLF] Path incomplete");
-			}
-		}
+		logger::info("[LLF] {} matching inis found", gradientConfigs.size());
+		insertConfigs(particleLightGradientConfigs, gradientConfigs, &ParticleLights::ParseGradientConfig);
 	}
+
+	if (!configs.empty())
+		writeCache();
 }
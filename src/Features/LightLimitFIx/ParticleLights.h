@@ -1,5 +1,7 @@
 #pragma once
 
+#include "ParticleLightConfigs.h"
+
 class ParticleLights
 {
 public:
@@ -32,8 +34,12 @@ public:
 		RE::NiColor color;
 	};
 
-	std::unordered_map<std::string, Config> particleLightConfigs;
-	std::unordered_map<std::string, GradientConfig> particleLightGradientConfigs;
+	ParticleLightConfigs::Map<Config> particleLightConfigs;
+	ParticleLightConfigs::Map<GradientConfig> particleLightGradientConfigs;
 
 	void GetConfigs();
-};
\ No newline at end of file
+
+private:
+	static std::optional<Config> ParseConfig(const std::string& a_path);
+	static std::optional<GradientConfig> ParseGradientConfig(const std::string& a_path);
+};
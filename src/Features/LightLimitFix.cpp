@@ -1,5 +1,6 @@
 #include "LightLimitFix.h"
 
+#include <Features/LightLimitFIx/LightGathering.h>
 #include <PerlinNoise.hpp>
 
 #include "State.h"
@@ -289,24 +290,6 @@ void LightLimitFix::BSLightingShader_SetupGeometry_After(RE::BSRenderPass*)
 	context->Unmap(strictLightData->resource.get(), 0);
 }
 
-void LightLimitFix::SetLightPosition(LightLimitFix::LightData& a_light, RE::NiPoint3 a_initialPosition)
-{
-	auto state = RE::BSGraphics::RendererShadowState::GetSingleton();
-	for (int eyeIndex = 0; eyeIndex < eyeCount; eyeIndex++) {
-		auto eyePosition = eyeCount == 1 ?
-		                       state->GetRuntimeData().posAdjust.getEye(eyeIndex) :
-		                       state->GetVRRuntimeData().posAdjust.getEye(eyeIndex);
-		auto viewMatrix = eyeCount == 1 ?
-		                      state->GetRuntimeData().cameraData.getEye(eyeIndex).viewMat :
-		                      state->GetVRRuntimeData().cameraData.getEye(eyeIndex).viewMat;
-		auto worldPos = a_initialPosition - eyePosition;
-		a_light.positionWS[eyeIndex].x = worldPos.x;
-		a_light.positionWS[eyeIndex].y = worldPos.y;
-		a_light.positionWS[eyeIndex].z = worldPos.z;
-		a_light.positionVS[eyeIndex] = DirectX::SimpleMath::Vector3::Transform(a_light.positionWS[eyeIndex], viewMatrix);
-	}
-}
-
 float LightLimitFix::CalculateLuminance(CachedParticleLight& light, RE::NiPoint3& point)
 {
 	// See BSLight::CalculateLuminance_14131D3D0
@@ -448,57 +431,25 @@ bool LightLimitFix::CheckParticleLights(RE::BSRenderPass* a_pass, uint32_t)
 			if (!shaderProperty->lightData) {
 				if (auto material = shaderProperty->GetMaterial()) {
 					if (!material->sourceTexturePath.empty()) {
-						std::string textureName = material->sourceTexturePath.c_str();
-
-						{
-							if (textureName.size() < 1)
-								return false;
-
-							auto lastSeparatorPos = textureName.find_last_of("\\/");
-							if (lastSeparatorPos == std::string::npos)
-								return false;
-
-							textureName = textureName.substr(lastSeparatorPos + 1);
-							if (textureName.size() < 4)
-								return false;
-
-							textureName.erase(textureName.length() - 4);  // Remove ".dds"
-#pragma warning(push)
-#pragma warning(disable: 4244)
-							std::transform(textureName.begin(), textureName.end(), textureName.begin(), ::tolower);
-#pragma warning(pop)
-						}
+						char stemBuffer[MAX_PATH];
+						auto textureStem = ParticleLightConfigs::GetStem(material->sourceTexturePath.c_str(), stemBuffer);
+						if (textureStem.empty())
+							return false;
 
 						auto& configs = ParticleLights::GetSingleton()->particleLightConfigs;
-						auto it = configs.find(textureName);
+						auto it = configs.find(textureStem);
 						if (it == configs.end())
 							return false;
 
 						ParticleLights::Config* config = &it->second;
 						ParticleLights::GradientConfig* gradientConfig = nullptr;
 						if (!material->greyscaleTexturePath.empty()) {
-							textureName = material->greyscaleTexturePath.c_str();
-							{
-								if (textureName.size() < 1)
-									return false;
-
-								auto lastSeparatorPos = textureName.find_last_of("\\/");
-								if (lastSeparatorPos == std::string::npos)
-									return false;
-
-								textureName = textureName.substr(lastSeparatorPos + 1);
-								if (textureName.size() < 4)
-									return false;
-
-								textureName.erase(textureName.length() - 4);  // Remove ".dds"
-#pragma warning(push)
-#pragma warning(disable: 4244)
-								std::transform(textureName.begin(), textureName.end(), textureName.begin(), ::tolower);
-#pragma warning(pop)
-							}
+							textureStem = ParticleLightConfigs::GetStem(material->greyscaleTexturePath.c_str(), stemBuffer);
+							if (textureStem.empty())
+								return false;
 
 							auto& gradientConfigs = ParticleLights::GetSingleton()->particleLightGradientConfigs;
-							auto itGradient = gradientConfigs.find(textureName);
+							auto itGradient = gradientConfigs.find(textureStem);
 							if (itGradient == gradientConfigs.end())
 								return false;
 							gradientConfig = &itGradient->second;
@@ -612,96 +563,26 @@ void LightLimitFix::DataLoaded()
 	logger::info("[LLF] Unlocked particle limit");
 }
 
-float LightLimitFix::CalculateLightDistance(float3 a_lightPosition, float a_radius)
-{
-	return (a_lightPosition.x * a_lightPosition.x) + (a_lightPosition.y * a_lightPosition.y) + (a_lightPosition.z * a_lightPosition.z) - (a_radius * a_radius);
-}
-
-bool LightLimitFix::AddCachedParticleLights(eastl::vector<LightData>& lightsData, LightLimitFix::LightData& light, ParticleLights::Config* a_config, RE::BSGeometry* a_geometry, double a_timer)
+void LightLimitFix::ApplyFlicker(LightData& a_light, const ParticleLights::Config& a_config, RE::BSGeometry* a_geometry, double a_timer)
 {
-	static float& lightFadeStart = (*(float*)RELOCATION_ID(527668, 414582).address());
-	static float& lightFadeEnd = (*(float*)RELOCATION_ID(527669, 414583).address());
-
-	float distance = CalculateLightDistance(light.positionWS[0], light.radius);
-
-	float dimmer = 0.0f;
-
-	if (distance < lightFadeStart || lightFadeEnd == 0.0f) {
-		dimmer = 1.0f;
-	} else if (distance <= lightFadeEnd) {
-		dimmer = 1.0f - ((distance - lightFadeStart) / (lightFadeEnd - lightFadeStart));
-	} else {
-		dimmer = 0.0f;
-	}
-
-	light.color *= dimmer;
-
-	float distantLightFadeStart = lightsFar * lightsFar * (lightFadeStart / lightFadeEnd);
-	float distantLightFadeEnd = lightsFar * lightsFar;
-
-	if (distance < distantLightFadeStart || distantLightFadeEnd == 0.0f) {
-		dimmer = 1.0f;
-	} else if (distance <= distantLightFadeEnd) {
-		dimmer = 1.0f - ((distance - distantLightFadeStart) / (distantLightFadeEnd - distantLightFadeStart));
-	} else {
-		dimmer = 0.0f;
-	}
-
-	light.color *= dimmer;
-
-	if ((light.color.x + light.color.y + light.color.z) > 1e-4 && light.radius > 1e-4) {
-		if (a_geometry && a_config && a_config->flicker) {
-			auto seed = (std::uint32_t)std::hash<void*>{}(a_geometry);
-
-			siv::PerlinNoise perlin1{ seed };
-			siv::PerlinNoise perlin2{ seed + 1 };
-			siv::PerlinNoise perlin3{ seed + 2 };
-			siv::PerlinNoise perlin4{ seed + 3 };
-
-			auto scaledTimer = a_timer * a_config->flickerSpeed;
-
-			for (int eyeIndex = 0; eyeIndex < eyeCount; eyeIndex++) {
-				light.positionWS[eyeIndex].x += (float)perlin1.noise1D(scaledTimer) * a_config->flickerMovement;
-				light.positionWS[eyeIndex].y += (float)perlin2.noise1D(scaledTimer) * a_config->flickerMovement;
-				light.positionWS[eyeIndex].z += (float)perlin3.noise1D(scaledTimer) * a_config->flickerMovement;
-			}
+	auto seed = (std::uint32_t)std::hash<void*>{}(a_geometry);
 
-			light.color.x = std::max(0.0f, light.color.x - ((float)perlin4.noise1D_01(scaledTimer) * a_config->flickerIntensity));
-			light.color.y = std::max(0.0f, light.color.y - ((float)perlin4.noise1D_01(scaledTimer) * a_config->flickerIntensity));
-			light.color.z = std::max(0.0f, light.color.z - ((float)perlin4.noise1D_01(scaledTimer) * a_config->flickerIntensity));
-		}
-
-		CachedParticleLight cachedParticleLight{};
-		cachedParticleLight.grey = float3(light.color.x, light.color.y, light.color.z).Dot(float3(0.3f, 0.59f, 0.11f));
-		cachedParticleLight.radius = light.radius;
+	siv::PerlinNoise perlin1{ seed };
+	siv::PerlinNoise perlin2{ seed + 1 };
+	siv::PerlinNoise perlin3{ seed + 2 };
+	siv::PerlinNoise perlin4{ seed + 3 };
 
-		auto state = RE::BSGraphics::RendererShadowState::GetSingleton();
-		auto eyePosition = eyeCount == 1 ?
-		                       state->GetRuntimeData().posAdjust.getEye(0) :
-		                       state->GetVRRuntimeData().posAdjust.getEye(0);
-		cachedParticleLight.position = { light.positionWS[0].x + eyePosition.x, light.positionWS[0].y + eyePosition.y, light.positionWS[0].z + eyePosition.z };
-		for (int eyeIndex = 0; eyeIndex < eyeCount; eyeIndex++) {
-			auto viewMatrix = eyeCount == 1 ?
-			                      state->GetRuntimeData().cameraData.getEye(eyeIndex).viewMat :
-			                      state->GetVRRuntimeData().cameraData.getEye(eyeIndex).viewMat;
-			light.positionVS[eyeIndex] = DirectX::SimpleMath::Vector3::Transform(light.positionWS[eyeIndex], viewMatrix);
-		}
+	auto scaledTimer = a_timer * a_config.flickerSpeed;
 
-		cachedParticleLights.push_back(cachedParticleLight);
-
-		lightsData.push_back(light);
-		return true;
+	for (int eyeIndex = 0; eyeIndex < eyeCount; eyeIndex++) {
+		a_light.positionWS[eyeIndex].x += (float)perlin1.noise1D(scaledTimer) * a_config.flickerMovement;
+		a_light.positionWS[eyeIndex].y += (float)perlin2.noise1D(scaledTimer) * a_config.flickerMovement;
+		a_light.positionWS[eyeIndex].z += (float)perlin3.noise1D(scaledTimer) * a_config.flickerMovement;
 	}
-	return false;
-}
 
-float3 LightLimitFix::Saturation(float3 color, float saturation)
-{
-	float grey = color.Dot(float3(0.3f, 0.59f, 0.11f));
-	color.x = std::max(std::lerp(grey, color.x, saturation), 0.0f);
-	color.y = std::max(std::lerp(grey, color.y, saturation), 0.0f);
-	color.z = std::max(std::lerp(grey, color.z, saturation), 0.0f);
-	return color;
+	a_light.color.x = std::max(0.0f, a_light.color.x - ((float)perlin4.noise1D_01(scaledTimer) * a_config.flickerIntensity));
+	a_light.color.y = std::max(0.0f, a_light.color.y - ((float)perlin4.noise1D_01(scaledTimer) * a_config.flickerIntensity));
+	a_light.color.z = std::max(0.0f, a_light.color.z - ((float)perlin4.noise1D_01(scaledTimer) * a_config.flickerIntensity));
 }
 
 void LightLimitFix::UpdateLights()
@@ -711,8 +592,6 @@ void LightLimitFix::UpdateLights()
 	lightsNear = std::max(0.0f, accumulator->kCamera->GetRuntimeData2().viewFrustum.fNear);
 	lightsFar = std::min(16384.0f, accumulator->kCamera->GetRuntimeData2().viewFrustum.fFar);
 
-	std::uint32_t currentLightCount = 0;  // Max number of lights is 4294967295
-
 	auto shadowSceneNode = RE::BSShaderManager::State::GetSingleton().shadowSceneNode[0];
 	auto state = RE::BSGraphics::RendererShadowState::GetSingleton();
 
@@ -738,168 +617,152 @@ void LightLimitFix::UpdateLights()
 		}
 	}
 
-	eastl::vector<LightData> lightsData{};
-
 	static float* g_deltaTime = (float*)RELOCATION_ID(523660, 410199).address();  // 2F6B948, 30064C8
 	static double timer = 0;
 	if (!RE::UI::GetSingleton()->GameIsPaused())
 		timer += *g_deltaTime;
 
+	static float& lightFadeStart = (*(float*)RELOCATION_ID(527668, 414582).address());
+	static float& lightFadeEnd = (*(float*)RELOCATION_ID(527669, 414583).address());
+
+	LightGathering::Camera camera{};
+	camera.eyeCount = (std::uint32_t)eyeCount;
+	for (int eyeIndex = 0; eyeIndex < eyeCount; eyeIndex++) {
+		auto eyePosition = eyeCount == 1 ?
+		                       state->GetRuntimeData().posAdjust.getEye(eyeIndex) :
+		                       state->GetVRRuntimeData().posAdjust.getEye(eyeIndex);
+		camera.posAdjust[eyeIndex] = { eyePosition.x, eyePosition.y, eyePosition.z };
+	}
+	camera.lightsNear = lightsNear;
+	camera.lightsFar = lightsFar;
+	camera.lightFadeStart = lightFadeStart;
+	camera.lightFadeEnd = lightFadeEnd;
+
+	LightGathering::Settings gatheringSettings{};
+	gatheringSettings.particleLightsSaturation = settings.ParticleLightsSaturation;
+	gatheringSettings.particleLightsRadiusBillboards = settings.ParticleLightsRadiusBillboards;
+	gatheringSettings.enableParticleLightsOptimization = settings.EnableParticleLightsOptimization;
+	gatheringSettings.particleLightsOptimisationClusterRadius = (float)settings.ParticleLightsOptimisationClusterRadius;
+
 	//process point lights
+	std::vector<LightGathering::PointLight> pointLights;
 	for (auto& e : shadowSceneNode->GetRuntimeData().activePointLights) {
 		if (auto bsLight = e.get()) {
 			if (auto niLight = bsLight->light.get()) {
 				if (IsValidLight(bsLight) && IsGlobalLight(bsLight)) {
 					auto& runtimeData = niLight->GetLightRuntimeData();
 
-					LightData light{};
+					LightGathering::PointLight light{};
 					light.color = { runtimeData.diffuse.red, runtimeData.diffuse.green, runtimeData.diffuse.blue };
-					light.color *= runtimeData.fade;
-					light.color *= bsLight->lodDimmer;
-
+					light.color.x *= runtimeData.fade * bsLight->lodDimmer;
+					light.color.y *= runtimeData.fade * bsLight->lodDimmer;
+					light.color.z *= runtimeData.fade * bsLight->lodDimmer;
 					light.radius = runtimeData.radius.x;
-
-					SetLightPosition(light, niLight->world.translate);
-
-					static float& lightFadeStart = (*(float*)RELOCATION_ID(527668, 414582).address());
-					static float& lightFadeEnd = (*(float*)RELOCATION_ID(527669, 414583).address());
-
-					float distance = CalculateLightDistance(light.positionWS[0], light.radius);
-
-					float distantLightFadeStart = lightsFar * lightsFar * (lightFadeStart / lightFadeEnd);
-					float distantLightFadeEnd = lightsFar * lightsFar;
-
-					float dimmer;
-
-					if (distance < distantLightFadeStart || distantLightFadeEnd == 0.0f) {
-						dimmer = 1.0f;
-					} else if (distance <= distantLightFadeEnd) {
-						dimmer = 1.0f - ((distance - distantLightFadeStart) / (distantLightFadeEnd - distantLightFadeStart));
-					} else {
-						dimmer = 0.0f;
-					}
-
-					light.color *= dimmer;
-
-					if ((light.color.x + light.color.y + light.color.z) > 1e-4 && light.radius > 1e-4) {
-						light.firstPersonShadow = bsLight == firstPersonLight || bsLight == thirdPersonLight || niLight == refLight || niLight == magicLight;
-						lightsData.push_back(light);
-						currentLightCount++;
-					}
+					light.position = { niLight->world.translate.x, niLight->world.translate.y, niLight->world.translate.z };
+					light.firstPersonShadow = bsLight == firstPersonLight || bsLight == thirdPersonLight || niLight == refLight || niLight == magicLight;
+					pointLights.push_back(light);
 				}
 			}
 		}
 	}
 
-	{
-		std::lock_guard<std::shared_mutex> lk{ cachedParticleLightsMutex };
-		cachedParticleLights.clear();
-
-		LightData clusteredLight{};
-		uint32_t clusteredLights = 0;
-
-		auto eyePosition = eyeCount == 1 ?
-		                       state->GetRuntimeData().posAdjust.getEye(0) :
-		                       state->GetVRRuntimeData().posAdjust.getEye(0);
-
-		for (const auto& particleLight : particleLights) {
-			if (const auto particleSystem = netimmerse_cast<RE::NiParticleSystem*>(particleLight.first);
-				particleSystem && particleSystem->GetParticleRuntimeData().particleData.get()) {
-				// process BSGeometry
-				auto particleData = particleSystem->GetParticleRuntimeData().particleData.get();
-
-				auto numVertices = particleData->GetActiveVertexCount();
-				for (std::uint32_t p = 0; p < numVertices; p++) {
-					float radius = particleData->GetParticlesRuntimeData().sizes[p] * 50;
-
-					auto initialPosition = particleData->GetParticlesRuntimeData().positions[p];
-					if (!particleSystem->GetParticleSystemRuntimeData().isWorldspace) {
-						// Detect first-person meshes
-						if ((particleLight.first->GetModelData().modelBound.radius * particleLight.first->world.scale) != particleLight.first->worldBound.radius)
-							initialPosition += particleLight.first->worldBound.center;
-						else
-							initialPosition += particleLight.first->world.translate;
-					}
-
-					RE::NiPoint3 positionWS = initialPosition - eyePosition;
-
-					if (clusteredLights) {
-						auto averageRadius = clusteredLight.radius / (float)clusteredLights;
-						float radiusDiff = abs(averageRadius - radius);
-
-						auto averagePosition = clusteredLight.positionWS[0] / (float)clusteredLights;
-						float positionDiff = positionWS.GetDistance({ averagePosition.x, averagePosition.y, averagePosition.z });
-
-						if ((radiusDiff + positionDiff) > settings.ParticleLightsOptimisationClusterRadius || !settings.EnableParticleLightsOptimization) {
-							clusteredLight.radius /= (float)clusteredLights;
-							clusteredLight.positionWS[0] /= (float)clusteredLights;
-							clusteredLight.positionWS[1] = clusteredLight.positionWS[0];
-							if (eyeCount == 2) {
-								auto offset = eyePosition - state->GetVRRuntimeData().posAdjust.getEye(1);
-								clusteredLight.positionWS[1].x += offset.x / (float)clusteredLights;
-								clusteredLight.positionWS[1].y += offset.y / (float)clusteredLights;
-								clusteredLight.positionWS[1].z += offset.z / (float)clusteredLights;
-							}
-
-							currentLightCount += AddCachedParticleLights(lightsData, clusteredLight);
-
-							clusteredLights = 0;
-							clusteredLight.color = { 0, 0, 0 };
-							clusteredLight.radius = 0;
-							clusteredLight.positionWS[0] = { 0, 0, 0 };
-						}
-					}
-
-					float alpha = particleLight.second.color.alpha * particleData->GetParticlesRuntimeData().color[p].alpha;
-					float3 color;
-					color.x = particleLight.second.color.red * particleData->GetParticlesRuntimeData().color[p].red;
-					color.y = particleLight.second.color.green * particleData->GetParticlesRuntimeData().color[p].green;
-					color.z = particleLight.second.color.blue * particleData->GetParticlesRuntimeData().color[p].blue;
-					clusteredLight.color += Saturation(color, settings.ParticleLightsSaturation) * alpha;
-
-					clusteredLight.radius += radius * particleLight.second.config.radiusMult;
-					clusteredLight.positionWS[0].x += positionWS.x;
-					clusteredLight.positionWS[0].y += positionWS.y;
-					clusteredLight.positionWS[0].z += positionWS.z;
-
-					clusteredLights++;
+	//process particle lights, billboards keep their geometry and config for flickering
+	std::vector<LightGathering::ParticleLight> particleLightInputs;
+	std::vector<std::pair<RE::BSGeometry*, ParticleLights::Config*>> particleLightSources;
+	for (auto& particleLight : particleLights) {
+		if (const auto particleSystem = netimmerse_cast<RE::NiParticleSystem*>(particleLight.first);
+			particleSystem && particleSystem->GetParticleRuntimeData().particleData.get()) {
+			// process BSGeometry
+			auto particleData = particleSystem->GetParticleRuntimeData().particleData.get();
+
+			auto numVertices = particleData->GetActiveVertexCount();
+			for (std::uint32_t p = 0; p < numVertices; p++) {
+				auto initialPosition = particleData->GetParticlesRuntimeData().positions[p];
+				if (!particleSystem->GetParticleSystemRuntimeData().isWorldspace) {
+					// Detect first-person meshes
+					if ((particleLight.first->GetModelData().modelBound.radius * particleLight.first->world.scale) != particleLight.first->worldBound.radius)
+						initialPosition += particleLight.first->worldBound.center;
+					else
+						initialPosition += particleLight.first->world.translate;
 				}
 
-			} else {
-				// process billboard
-				LightData light{};
+				auto& particleColor = particleData->GetParticlesRuntimeData().color[p];
 
-				light.color.x = particleLight.second.color.red;
-				light.color.y = particleLight.second.color.green;
-				light.color.z = particleLight.second.color.blue;
+				LightGathering::ParticleLight light{};
+				light.position = { initialPosition.x, initialPosition.y, initialPosition.z };
+				light.radius = particleData->GetParticlesRuntimeData().sizes[p] * 50;
+				light.radiusMult = particleLight.second.config.radiusMult;
+				light.color = { particleLight.second.color.red * particleColor.red, particleLight.second.color.green * particleColor.green, particleLight.second.color.blue * particleColor.blue };
+				light.alpha = particleLight.second.color.alpha * particleColor.alpha;
+				particleLightInputs.push_back(light);
+				particleLightSources.emplace_back(particleLight.first, &particleLight.second.config);
+			}
+		} else {
+			// process billboard
+			LightGathering::ParticleLight light{};
+			light.position = { particleLight.first->world.translate.x, particleLight.first->world.translate.y, particleLight.first->world.translate.z };
+			light.radius = (particleLight.first->worldBound.radius / std::max(FLT_MIN, particleLight.first->GetModelData().modelBound.radius)) * particleLight.second.radius * 64;  // correct bad model bounds
+			light.color = { particleLight.second.color.red, particleLight.second.color.green, particleLight.second.color.blue };
+			light.alpha = particleLight.second.color.alpha;
+			light.billboard = true;
+			particleLightInputs.push_back(light);
+			particleLightSources.emplace_back(particleLight.first, &particleLight.second.config);
+		}
+	}
 
-				light.color = Saturation(light.color, settings.ParticleLightsSaturation);
+	auto& frameCapture = State::GetSingleton()->frameCapture;
+	if (frameCapture.IsCapturing()) {
+		frameCapture.Write(FrameCapture::RecordType::LightCamera, camera);
+		frameCapture.Write(FrameCapture::RecordType::LightSettings, gatheringSettings);
+		frameCapture.WriteArray(FrameCapture::RecordType::PointLights, pointLights);
+		frameCapture.WriteArray(FrameCapture::RecordType::ParticleLights, particleLightInputs);
+	}
 
-				light.color *= particleLight.second.color.alpha;
+	std::vector<LightGathering::Light> gatheredLights;
+	LightGathering::Gather(camera, gatheringSettings, pointLights, particleLightInputs, gatheredLights);
 
-				float radius = (particleLight.first->worldBound.radius / std::max(FLT_MIN, particleLight.first->GetModelData().modelBound.radius)) * particleLight.second.radius * 64;  // correct bad model bounds
-				light.radius = radius * settings.ParticleLightsRadiusBillboards;
+	eastl::vector<LightData> lightsData{};
+	lightsData.reserve(gatheredLights.size() + 1);
 
-				SetLightPosition(light, particleLight.first->world.translate);  //light is complete for both eyes by now
+	{
+		std::lock_guard<std::shared_mutex> lk{ cachedParticleLightsMutex };
+		cachedParticleLights.clear();
 
-				currentLightCount += AddCachedParticleLights(lightsData, light, &particleLight.second.config, particleLight.first, timer);
+		for (auto& gatheredLight : gatheredLights) {
+			LightData light{};
+			light.color = { gatheredLight.color.x, gatheredLight.color.y, gatheredLight.color.z };
+			light.radius = gatheredLight.radius;
+			for (int eyeIndex = 0; eyeIndex < 2; eyeIndex++)
+				light.positionWS[eyeIndex] = { gatheredLight.positionWS[eyeIndex].x, gatheredLight.positionWS[eyeIndex].y, gatheredLight.positionWS[eyeIndex].z };
+			light.firstPersonShadow = gatheredLight.firstPersonShadow;
+
+			if (gatheredLight.source == LightGathering::Source::Billboard) {
+				auto [geometry, config] = particleLightSources[gatheredLight.index];
+				if (config->flicker)
+					ApplyFlicker(light, *config, geometry, timer);
+			}
+
+			if (gatheredLight.source != LightGathering::Source::PointLight) {
+				CachedParticleLight cachedParticleLight{};
+				cachedParticleLight.grey = float3(light.color.x, light.color.y, light.color.z).Dot(float3(0.3f, 0.59f, 0.11f));
+				cachedParticleLight.radius = light.radius;
+				cachedParticleLight.position = { light.positionWS[0].x + camera.posAdjust[0].x, light.positionWS[0].y + camera.posAdjust[0].y, light.positionWS[0].z + camera.posAdjust[0].z };
+				cachedParticleLights.push_back(cachedParticleLight);
 			}
-		}
 
-		if (clusteredLights) {
-			clusteredLight.radius /= (float)clusteredLights;
-			clusteredLight.positionWS[0] /= (float)clusteredLights;
-			clusteredLight.positionWS[1] = clusteredLight.positionWS[0];
-			if (eyeCount == 2) {
-				auto offset = eyePosition - state->GetVRRuntimeData().posAdjust.getEye(1);
-				clusteredLight.positionWS[1].x += offset.x / (float)clusteredLights;
-				clusteredLight.positionWS[1].y += offset.y / (float)clusteredLights;
-				clusteredLight.positionWS[1].z += offset.z / (float)clusteredLights;
+			for (int eyeIndex = 0; eyeIndex < eyeCount; eyeIndex++) {
+				auto viewMatrix = eyeCount == 1 ?
+				                      state->GetRuntimeData().cameraData.getEye(eyeIndex).viewMat :
+				                      state->GetVRRuntimeData().cameraData.getEye(eyeIndex).viewMat;
+				light.positionVS[eyeIndex] = DirectX::SimpleMath::Vector3::Transform(light.positionWS[eyeIndex], viewMatrix);
 			}
-			currentLightCount += AddCachedParticleLights(lightsData, clusteredLight);
+
+			lightsData.push_back(light);
 		}
 	}
 
+	std::uint32_t currentLightCount = (std::uint32_t)lightsData.size();
+
 	auto context = RE::BSGraphics::Renderer::GetSingleton()->GetRuntimeData().context;
 
 	{
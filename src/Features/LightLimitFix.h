@@ -7,7 +7,7 @@
 
 #include "Feature.h"
 #include "ShaderCache.h"
-#include <Features/LightLimitFix/ParticleLights.h>
+#include <Features/LightLimitFIx/ParticleLights.h>
 
 struct LightLimitFix : Feature
 {
@@ -132,13 +132,10 @@ public:
 	virtual void PostPostLoad() override;
 	virtual void DataLoaded() override;
 
-	float CalculateLightDistance(float3 a_lightPosition, float a_radius);
-	bool AddCachedParticleLights(eastl::vector<LightData>& lightsData, LightLimitFix::LightData& light, ParticleLights::Config* a_config = nullptr, RE::BSGeometry* a_geometry = nullptr, double timer = 0.0f);
-	void SetLightPosition(LightLimitFix::LightData& a_light, RE::NiPoint3 a_initialPosition);
+	void ApplyFlicker(LightData& a_light, const ParticleLights::Config& a_config, RE::BSGeometry* a_geometry, double a_timer);
 	void UpdateLights();
 	void Bind();
 
-	static inline float3 Saturation(float3 color, float saturation);
 	static inline bool IsValidLight(RE::BSLight* a_light);
 	static inline bool IsGlobalLight(RE::BSLight* a_light);
 
@@ -16,7 +16,10 @@ NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE_WITH_DEFAULT(
 	NearHardness,
 	BlurRadius,
 	BlurDropoff,
-	Enabled)
+	Enabled,
+	RaymarchScale,
+	TemporalAccumulation,
+	FusedFilter)
 
 void ScreenSpaceShadows::DrawSettings()
 {
@@ -31,6 +34,19 @@ void ScreenSpaceShadows::DrawSettings()
 			ImGui::Text("Controls the accuracy of traced shadows.");
 		}
 
+		const char* raymarchScales[] = { "Full", "Half", "Quarter" };
+		int raymarchScale = settings.RaymarchScale >= 4 ? 2 : settings.RaymarchScale >= 2 ? 1 : 0;
+		if (ImGui::Combo("Raymarch Resolution", &raymarchScale, raymarchScales, IM_ARRAYSIZE(raymarchScales)))
+			settings.RaymarchScale = 1u << raymarchScale;
+		if (auto _tt = Util::HoverTooltipWrapper()) {
+			ImGui::Text("Traces one pixel of every 2x2 or 4x4 block, changing the pixel every frame. The rest are filled in by a depth-aware upsample.");
+		}
+
+		ImGui::Checkbox("Temporal Accumulation", &settings.TemporalAccumulation);
+		if (auto _tt = Util::HoverTooltipWrapper()) {
+			ImGui::Text("Blends the shadows with the reprojected shadows of the previous frames, hiding the noise of reduced resolution tracing.");
+		}
+
 		ImGui::Spacing();
 		ImGui::Spacing();
 		ImGui::TreePop();
@@ -47,6 +63,11 @@ void ScreenSpaceShadows::DrawSettings()
 			ImGui::Text("Blur depth dropoff.");
 		}
 
+		ImGui::Checkbox("Fused Filter", (bool*)&settings.FusedFilter);
+		if (auto _tt = Util::HoverTooltipWrapper()) {
+			ImGui::Text("Runs both blur axes in a single tiled pass, skipping the intermediate texture. Trades bandwidth for some repeated horizontal filtering at tile edges.");
+		}
+
 		ImGui::Spacing();
 		ImGui::Spacing();
 		ImGui::TreePop();
@@ -86,6 +107,16 @@ void ScreenSpaceShadows::DrawSettings()
 			ImGui::Text("Far Shadow Hardness.");
 		}
 
+		ImGui::Spacing();
+		ImGui::Spacing();
+		ImGui::TreePop();
+	}
+
+	if (ImGui::TreeNodeEx("Statistics", ImGuiTreeNodeFlags_DefaultOpen)) {
+		ImGui::Text(std::format("Traced Pixels: 1 in {}", settings.RaymarchScale * settings.RaymarchScale).c_str());
+		ImGui::Text(std::format("History Weight: {:.3f}", settings.TemporalAccumulation ? historyWeight : 0.0f).c_str());
+		ImGui::Text(std::format("Accumulated Frames: {}", historyTracker.GetAccumulatedFrames()).c_str());
+		ImGui::Text(std::format("History Resets: {}", historyTracker.GetResetCount()).c_str());
 		ImGui::TreePop();
 	}
 }
@@ -161,6 +192,14 @@ void ScreenSpaceShadows::ClearShaderCache()
 		verticalBlurProgram->Release();
 		verticalBlurProgram = nullptr;
 	}
+	if (temporalProgram) {
+		temporalProgram->Release();
+		temporalProgram = nullptr;
+	}
+	if (fusedBlurProgram) {
+		fusedBlurProgram->Release();
+		fusedBlurProgram = nullptr;
+	}
 }
 
 ID3D11ComputeShader* ScreenSpaceShadows::GetComputeShader()
@@ -190,6 +229,24 @@ ID3D11ComputeShader* ScreenSpaceShadows::GetComputeShaderVerticalBlur()
 	return verticalBlurProgram;
 }
 
+ID3D11ComputeShader* ScreenSpaceShadows::GetComputeShaderTemporal()
+{
+	if (!temporalProgram) {
+		logger::debug("Compiling temporalProgram");
+		temporalProgram = (ID3D11ComputeShader*)Util::CompileShader(L"Data\\Shaders\\ScreenSpaceShadows\\TemporalCS.hlsl", {}, "cs_5_0");
+	}
+	return temporalProgram;
+}
+
+ID3D11ComputeShader* ScreenSpaceShadows::GetComputeShaderFusedBlur()
+{
+	if (!fusedBlurProgram) {
+		logger::debug("Compiling fusedBlurProgram");
+		fusedBlurProgram = (ID3D11ComputeShader*)Util::CompileShader(L"Data\\Shaders\\ScreenSpaceShadows\\FilterCS.hlsl", { { "FUSED", "" } }, "cs_5_0");
+	}
+	return fusedBlurProgram;
+}
+
 void ScreenSpaceShadows::ModifyLighting(const RE::BSShader*, const uint32_t)
 {
 	if (!loaded)
@@ -265,7 +322,7 @@ void ScreenSpaceShadows::ModifyLighting(const RE::BSShader*, const uint32_t)
 			// Backup the game state
 			struct OldState
 			{
-				ID3D11ShaderResourceView* srvs[2];
+				ID3D11ShaderResourceView* srvs[3];
 				ID3D11SamplerState* sampler;
 				ID3D11ComputeShader* shader;
 				ID3D11Buffer* buffer;
@@ -275,7 +332,7 @@ void ScreenSpaceShadows::ModifyLighting(const RE::BSShader*, const uint32_t)
 			};
 
 			OldState old{};
-			context->CSGetShaderResources(0, 2, old.srvs);
+			context->CSGetShaderResources(0, 3, old.srvs);
 			context->CSGetSamplers(0, 1, &old.sampler);
 			context->CSGetShader(&old.shader, &old.instance, &old.numInstances);
 			context->CSGetConstantBuffers(0, 1, &old.buffer);
@@ -287,6 +344,24 @@ void ScreenSpaceShadows::ModifyLighting(const RE::BSShader*, const uint32_t)
 				float resolutionX = screenSpaceShadowsTexture->desc.Width * viewport->GetRuntimeData().dynamicResolutionCurrentWidthScale;
 				float resolutionY = screenSpaceShadowsTexture->desc.Height * viewport->GetRuntimeData().dynamicResolutionCurrentHeightScale;
 
+				uint32_t raymarchScale = settings.RaymarchScale >= 4 ? 4u : settings.RaymarchScale >= 2 ? 2u : 1u;
+				bool temporal = settings.TemporalAccumulation;
+
+				if (temporal && !historyTextures[0]) {
+					logger::debug("Creating historyTextures");
+					D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc{};
+					screenSpaceShadowsTexture->srv->GetDesc(&srvDesc);
+					D3D11_UNORDERED_ACCESS_VIEW_DESC uavDesc{};
+					screenSpaceShadowsTexture->uav->GetDesc(&uavDesc);
+					for (auto& history : historyTextures) {
+						history = new Texture2D(screenSpaceShadowsTexture->desc);
+						history->CreateSRV(srvDesc);
+						history->CreateUAV(uavDesc);
+					}
+					// the new textures hold no history yet
+					historyTracker.Invalidate();
+				}
+
 				{
 					RaymarchCB data{};
 
@@ -300,6 +375,13 @@ void ScreenSpaceShadows::ModifyLighting(const RE::BSShader*, const uint32_t)
 
 					data.DynamicRes.z = 1.0f / data.DynamicRes.x;
 					data.DynamicRes.w = 1.0f / data.DynamicRes.y;
+
+					auto jitter = ShadowHistory::GetJitter(jitterFrame++, raymarchScale);
+					data.Jitter[0] = jitter.x;
+					data.Jitter[1] = jitter.y;
+
+					Matrix viewProjMatrix[2]{};
+					RE::NiPoint3 eyePosition[2]{};
 					for (int eyeIndex = 0; eyeIndex < (!REL::Module::IsVR() ? 1 : 2); eyeIndex++) {
 						if (!REL::Module::IsVR())
 							data.ProjMatrix[eyeIndex] = shadowState->GetRuntimeData().cameraData.getEye(eyeIndex).projMat;
@@ -320,10 +402,35 @@ void ScreenSpaceShadows::ModifyLighting(const RE::BSShader*, const uint32_t)
 
 						auto invDirLightDirectionWS = XMLoadFloat3(&position);
 						data.InvDirLightDirectionVS[eyeIndex] = XMVector3TransformCoord(invDirLightDirectionWS, viewMatrix[eyeIndex]);
+
+						// Current view space to the previous frame's clip space, both eye relative
+						eyePosition[eyeIndex] = !REL::Module::IsVR() ? shadowState->GetRuntimeData().posAdjust.getEye(eyeIndex) : shadowState->GetVRRuntimeData().posAdjust.getEye(eyeIndex);
+						viewProjMatrix[eyeIndex] = viewMatrix[eyeIndex] * data.ProjMatrix[eyeIndex];
+						auto eyeDelta = eyePosition[eyeIndex] - previousEyePosition[eyeIndex];
+						data.ReprojectionMatrix[eyeIndex] = XMMatrixInverse(nullptr, viewMatrix[eyeIndex]) * XMMatrixTranslation(eyeDelta.x, eyeDelta.y, eyeDelta.z) * previousViewProjMatrix[eyeIndex];
+
+						if (eyeIndex == 0) {
+							ShadowHistory::Tracker::Camera camera{
+								{ eyePosition[0].x, eyePosition[0].y, eyePosition[0].z },
+								{ viewMatrix[0]._13, viewMatrix[0]._23, viewMatrix[0]._33 },
+								screenSpaceShadowsTexture->desc.Width,
+								screenSpaceShadowsTexture->desc.Height,
+								raymarchScale
+							};
+							if (!temporal)
+								historyTracker.Invalidate();
+							State::GetSingleton()->frameCapture.Write(FrameCapture::RecordType::ShadowCamera, camera);
+							historyWeight = historyTracker.Update(camera);
+						}
 					}
+					std::copy(std::begin(viewProjMatrix), std::end(viewProjMatrix), std::begin(previousViewProjMatrix));
+					std::copy(std::begin(eyePosition), std::end(eyePosition), std::begin(previousEyePosition));
+
 					data.ShadowDistance = 10000.0f;
 
 					data.Settings = settings;
+					data.Settings.RaymarchScale = raymarchScale;
+					data.HistoryWeight = historyWeight;
 
 					raymarchCB->Update(data);
 				}
@@ -344,51 +451,101 @@ void ScreenSpaceShadows::ModifyLighting(const RE::BSShader*, const uint32_t)
 				auto shader = GetComputeShader();
 				context->CSSetShader(shader, nullptr, 0);
 
-				context->Dispatch((uint32_t)std::ceil(resolutionX / 32.0f), (uint32_t)std::ceil(resolutionY / 32.0f), 1);
+				context->Dispatch(ShadowHistory::GetDispatchSize(resolutionX, raymarchScale, 32), ShadowHistory::GetDispatchSize(resolutionY, raymarchScale, 32), 1);
 
 				// Filter
-				{
+				outputTexture = screenSpaceShadowsTexture;
+				if (settings.FusedFilter) {
+					if (!fusedFilterTexture) {
+						logger::debug("Creating fusedFilterTexture");
+						fusedFilterTexture = new Texture2D(screenSpaceShadowsTexture->desc);
+						D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc{};
+						screenSpaceShadowsTexture->srv->GetDesc(&srvDesc);
+						fusedFilterTexture->CreateSRV(srvDesc);
+						D3D11_UNORDERED_ACCESS_VIEW_DESC uavDesc{};
+						screenSpaceShadowsTexture->uav->GetDesc(&uavDesc);
+						fusedFilterTexture->CreateUAV(uavDesc);
+					}
+
 					uav = nullptr;
 					context->CSSetUnorderedAccessViews(0, 1, &uav, nullptr);
-					view = nullptr;
-					context->CSSetShaderResources(1, 1, &view);
 
 					view = screenSpaceShadowsTexture->srv.get();
-
 					context->CSSetShaderResources(1, 1, &view);
 
-					uav = screenSpaceShadowsTextureTemp->uav.get();
+					uav = fusedFilterTexture->uav.get();
 					context->CSSetUnorderedAccessViews(0, 1, &uav, nullptr);
 
-					shader = GetComputeShaderHorizontalBlur();
+					shader = GetComputeShaderFusedBlur();
 					context->CSSetShader(shader, nullptr, 0);
 
-					context->Dispatch((uint32_t)std::ceil(resolutionX / 64.0f), (uint32_t)std::ceil(resolutionY / 64.0f), 1);
+					context->Dispatch((uint32_t)std::ceil(resolutionX / 32.0f), (uint32_t)std::ceil(resolutionY / 32.0f), 1);
+
+					outputTexture = fusedFilterTexture;
+				} else {
+					{
+						uav = nullptr;
+						context->CSSetUnorderedAccessViews(0, 1, &uav, nullptr);
+						view = nullptr;
+						context->CSSetShaderResources(1, 1, &view);
+
+						view = screenSpaceShadowsTexture->srv.get();
+
+						context->CSSetShaderResources(1, 1, &view);
+
+						uav = screenSpaceShadowsTextureTemp->uav.get();
+						context->CSSetUnorderedAccessViews(0, 1, &uav, nullptr);
+
+						shader = GetComputeShaderHorizontalBlur();
+						context->CSSetShader(shader, nullptr, 0);
+
+						context->Dispatch((uint32_t)std::ceil(resolutionX / 64.0f), (uint32_t)std::ceil(resolutionY / 64.0f), 1);
+					}
+
+					{
+						uav = nullptr;
+						context->CSSetUnorderedAccessViews(0, 1, &uav, nullptr);
+						view = nullptr;
+						context->CSSetShaderResources(1, 1, &view);
+
+						view = screenSpaceShadowsTextureTemp->srv.get();
+
+						context->CSSetShaderResources(1, 1, &view);
+
+						uav = screenSpaceShadowsTexture->uav.get();
+						context->CSSetUnorderedAccessViews(0, 1, &uav, nullptr);
+
+						shader = GetComputeShaderVerticalBlur();
+						context->CSSetShader(shader, nullptr, 0);
+
+						context->Dispatch((uint32_t)std::ceil(resolutionX / 64.0f), (uint32_t)std::ceil(resolutionY / 64.0f), 1);
+					}
 				}
 
-				{
+				if (temporal) {
+					historyIndex ^= 1;
+
 					uav = nullptr;
 					context->CSSetUnorderedAccessViews(0, 1, &uav, nullptr);
-					view = nullptr;
-					context->CSSetShaderResources(1, 1, &view);
 
-					view = screenSpaceShadowsTextureTemp->srv.get();
+					ID3D11ShaderResourceView* views[2] = { outputTexture->srv.get(), historyTextures[historyIndex ^ 1]->srv.get() };
+					context->CSSetShaderResources(1, 2, views);
 
-					context->CSSetShaderResources(1, 1, &view);
-
-					uav = screenSpaceShadowsTexture->uav.get();
+					uav = historyTextures[historyIndex]->uav.get();
 					context->CSSetUnorderedAccessViews(0, 1, &uav, nullptr);
 
-					shader = GetComputeShaderVerticalBlur();
+					shader = GetComputeShaderTemporal();
 					context->CSSetShader(shader, nullptr, 0);
 
 					context->Dispatch((uint32_t)std::ceil(resolutionX / 64.0f), (uint32_t)std::ceil(resolutionY / 64.0f), 1);
+
+					outputTexture = historyTextures[historyIndex];
 				}
 			}
 
 			// Restore the game state
-			context->CSSetShaderResources(0, 2, old.srvs);
-			for (uint8_t i = 0; i < 2; i++)
+			context->CSSetShaderResources(0, 3, old.srvs);
+			for (uint8_t i = 0; i < 3; i++)
 				if (old.srvs[i])
 					old.srvs[i]->Release();
 
@@ -417,7 +574,7 @@ void ScreenSpaceShadows::ModifyLighting(const RE::BSShader*, const uint32_t)
 			auto shadowMask = renderer->GetDepthStencilData().depthStencils[RE::RENDER_TARGET_DEPTHSTENCIL::kPOST_ZPREPASS_COPY];
 			ID3D11ShaderResourceView* views[2]{};
 			views[0] = shadowMask.depthSRV;
-			views[1] = screenSpaceShadowsTexture->srv.get();
+			views[1] = outputTexture->srv.get();
 			context->PSSetShaderResources(20, ARRAYSIZE(views), views);
 		}
 	} else {
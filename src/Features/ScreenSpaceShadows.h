@@ -2,6 +2,7 @@
 
 #include "Buffer.h"
 #include "Feature.h"
+#include "Features/ScreenSpaceShadows/ShadowHistory.h"
 
 struct ScreenSpaceShadows : Feature
 {
@@ -29,6 +30,9 @@ struct ScreenSpaceShadows : Feature
 		float BlurRadius = 0.5f;
 		float BlurDropoff = 0.005f;
 		bool Enabled = true;
+		uint32_t RaymarchScale = 1;  // 1 full, 2 half or 4 quarter resolution raymarch
+		bool TemporalAccumulation = false;
+		uint32_t FusedFilter = false;  // both blur axes in one tiled pass
 	};
 
 	struct alignas(16) PerPass
@@ -50,7 +54,17 @@ struct ScreenSpaceShadows : Feature
 		Vector4 InvDirLightDirectionVS[2];
 		float ShadowDistance = 10000;
 		Settings Settings;
+		uint32_t pad0[2];  // Matrix is only 4 byte aligned, HLSL starts the float4x4 on the next register
+		Matrix ReprojectionMatrix[2];
+		uint32_t Jitter[2];
+		float HistoryWeight;
+		float pad1;
 	};
+	static_assert(offsetof(RaymarchCB, Settings) + offsetof(Settings, FusedFilter) == 372);
+	static_assert(offsetof(RaymarchCB, ReprojectionMatrix) == 384);
+	static_assert(offsetof(RaymarchCB, Jitter) == 512);
+	static_assert(offsetof(RaymarchCB, HistoryWeight) == 520);
+	static_assert(sizeof(RaymarchCB) % 16 == 0);
 #pragma warning(pop)
 
 	Settings settings;
@@ -61,12 +75,24 @@ struct ScreenSpaceShadows : Feature
 
 	Texture2D* screenSpaceShadowsTexture = nullptr;
 	Texture2D* screenSpaceShadowsTextureTemp = nullptr;
+	Texture2D* fusedFilterTexture = nullptr;  // created on first use of the fused filter, the raymarch result is still in screenSpaceShadowsTexture
+	Texture2D* historyTextures[2] = { nullptr };  // accumulated shadows, written alternately, created on first use of the temporal pass
+	uint32_t historyIndex = 0;
+	Texture2D* outputTexture = nullptr;  // result sampled by the lighting shaders this frame
+
+	ShadowHistory::Tracker historyTracker;
+	uint32_t jitterFrame = 0;
+	Matrix previousViewProjMatrix[2];
+	RE::NiPoint3 previousEyePosition[2];
+	float historyWeight = 0.0f;
 
 	ConstantBuffer* raymarchCB = nullptr;
 	ID3D11ComputeShader* raymarchProgram = nullptr;
 
 	ID3D11ComputeShader* horizontalBlurProgram = nullptr;
 	ID3D11ComputeShader* verticalBlurProgram = nullptr;
+	ID3D11ComputeShader* temporalProgram = nullptr;
+	ID3D11ComputeShader* fusedBlurProgram = nullptr;
 
 	bool renderedScreenCamera = false;
 
@@ -81,6 +107,8 @@ struct ScreenSpaceShadows : Feature
 	ID3D11ComputeShader* GetComputeShader();
 	ID3D11ComputeShader* GetComputeShaderHorizontalBlur();
 	ID3D11ComputeShader* GetComputeShaderVerticalBlur();
+	ID3D11ComputeShader* GetComputeShaderTemporal();
+	ID3D11ComputeShader* GetComputeShaderFusedBlur();
 
 	void ModifyLighting(const RE::BSShader* shader, const uint32_t descriptor);
 	virtual void Draw(const RE::BSShader* shader, const uint32_t descriptor);
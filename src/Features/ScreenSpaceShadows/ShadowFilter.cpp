@@ -0,0 +1,143 @@
+#include "ShadowFilter.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ShadowFilter
+{
+	static constexpr std::int32_t KERNEL_SIZE = 12;
+	static constexpr float CENTER_WEIGHT = 0.114725602f;
+
+	static constexpr float BLUR_WEIGHTS[KERNEL_SIZE] = {
+		0.057424882f,
+		0.058107773f,
+		0.061460144f,
+		0.071020611f,
+		0.088092873f,
+		0.106530916f,
+		0.106530916f,
+		0.088092873f,
+		0.071020611f,
+		0.061460144f,
+		0.058107773f,
+		0.057424882f
+	};
+
+	static constexpr float BLUR_OFFSETS[KERNEL_SIZE] = { -6.0f, -5.0f, -4.0f, -3.0f, -2.0f, -1.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f };
+
+	float Image::Load(std::int32_t x, std::int32_t y) const
+	{
+		x = std::clamp(x, 0, (std::int32_t)width - 1);
+		y = std::clamp(y, 0, (std::int32_t)height - 1);
+		return At(x, y);
+	}
+
+	float Image::Sample(float u, float v) const
+	{
+		float x = u * width - 0.5f;
+		float y = v * height - 0.5f;
+		float x0 = std::floor(x);
+		float y0 = std::floor(y);
+		float tx = x - x0;
+		float ty = y - y0;
+		auto ix = (std::int32_t)x0;
+		auto iy = (std::int32_t)y0;
+		float top = Load(ix, iy) * (1 - tx) + Load(ix + 1, iy) * tx;
+		float bottom = Load(ix, iy + 1) * (1 - tx) + Load(ix + 1, iy + 1) * tx;
+		return top * (1 - ty) + bottom * ty;
+	}
+
+	// FilterCS for the half resolution pixel at (u, v), in full resolution uv units like the shader's TexCoord.
+	// The vertical axis reads the horizontal result through a_sampleHorizontal.
+	template <class SampleHorizontal>
+	static float FilterAxis(float u, float v, bool a_horizontal, const Image& a_occlusion, const Image& a_viewDepth, const Settings& a_settings, SampleHorizontal&& a_sampleHorizontal)
+	{
+		float weightSum = CENTER_WEIGHT;
+
+		float depth1 = a_viewDepth.Sample(u * 2, v * 2);
+		float depthDrop = depth1 * a_settings.BlurDropoff;
+
+		float color1 = a_horizontal ? a_occlusion.Sample(u * 2, v * 2) : a_sampleHorizontal(u, v);
+		color1 *= weightSum;
+
+		for (std::int32_t i = 0; i < KERNEL_SIZE; i++) {
+			float offset = BLUR_OFFSETS[i] * a_settings.BlurRadius;
+			float sampleU = a_horizontal ? u + offset / a_occlusion.width : u;
+			float sampleV = a_horizontal ? v : v + offset * 0.5f / a_occlusion.height;
+
+			float color2 = a_horizontal ? a_occlusion.Sample(sampleU * 2, sampleV * 2) : a_sampleHorizontal(sampleU, sampleV);
+			float depth2 = a_viewDepth.Sample(sampleU * 2, sampleV * 2);
+
+			float awareness = std::clamp(depthDrop - std::abs(depth1 - depth2), 0.0f, 1.0f);
+
+			color1 += BLUR_WEIGHTS[i] * color2 * awareness;
+			weightSum += BLUR_WEIGHTS[i] * awareness;
+		}
+		return color1 / weightSum;
+	}
+
+	static float FilterHorizontal(std::uint32_t x, std::uint32_t y, const Image& a_occlusion, const Image& a_viewDepth, const Settings& a_settings)
+	{
+		float u = (x + 0.5f) / a_occlusion.width;
+		float v = (y + 0.5f) / a_occlusion.height;
+		return FilterAxis(u, v, true, a_occlusion, a_viewDepth, a_settings, [](float, float) { return 0.0f; });
+	}
+
+	Image FilterTwoPass(const Image& a_occlusion, const Image& a_viewDepth, const Settings& a_settings)
+	{
+		Image horizontal{ a_occlusion.width / 2, a_occlusion.height / 2 };
+		for (std::uint32_t y = 0; y < horizontal.height; y++)
+			for (std::uint32_t x = 0; x < horizontal.width; x++)
+				horizontal.At(x, y) = FilterHorizontal(x, y, a_occlusion, a_viewDepth, a_settings);
+
+		Image result{ horizontal.width, horizontal.height };
+		auto sampleHorizontal = [&](float u, float v) { return horizontal.Sample(u * 2, v * 2); };
+		for (std::uint32_t y = 0; y < result.height; y++) {
+			for (std::uint32_t x = 0; x < result.width; x++) {
+				float u = (x + 0.5f) / a_occlusion.width;
+				float v = (y + 0.5f) / a_occlusion.height;
+				result.At(x, y) = FilterAxis(u, v, false, a_occlusion, a_viewDepth, a_settings, sampleHorizontal);
+			}
+		}
+		return result;
+	}
+
+	Image FilterFused(const Image& a_occlusion, const Image& a_viewDepth, const Settings& a_settings)
+	{
+		constexpr std::int32_t TILE_ROWS = TILE_SIZE + APRON * 2;
+
+		Image result{ a_occlusion.width / 2, a_occlusion.height / 2 };
+		auto halfHeight = (std::int32_t)result.height;
+
+		float tile[TILE_ROWS][TILE_SIZE];
+		for (std::uint32_t tileY = 0; tileY < result.height; tileY += TILE_SIZE) {
+			for (std::uint32_t tileX = 0; tileX < result.width; tileX += TILE_SIZE) {
+				auto columns = std::min<std::uint32_t>(TILE_SIZE, result.width - tileX);
+
+				for (std::int32_t row = 0; row < TILE_ROWS; row++) {
+					auto y = std::clamp((std::int32_t)tileY - APRON + row, 0, halfHeight - 1);
+					for (std::uint32_t column = 0; column < columns; column++)
+						tile[row][column] = FilterHorizontal(tileX + column, y, a_occlusion, a_viewDepth, a_settings);
+				}
+
+				auto sampleHorizontal = [&](float u, float v) {
+					float rowPos = v * a_occlusion.height - 0.5f - ((std::int32_t)tileY - APRON);
+					auto row = std::clamp((std::int32_t)std::floor(rowPos), 0, TILE_ROWS - 2);
+					auto column = (std::uint32_t)(u * a_occlusion.width) - tileX;
+					float t = std::clamp(rowPos - row, 0.0f, 1.0f);
+					return tile[row][column] * (1 - t) + tile[row + 1][column] * t;
+				};
+
+				auto rows = std::min<std::uint32_t>(TILE_SIZE, result.height - tileY);
+				for (std::uint32_t y = tileY; y < tileY + rows; y++) {
+					for (std::uint32_t x = tileX; x < tileX + columns; x++) {
+						float u = (x + 0.5f) / a_occlusion.width;
+						float v = (y + 0.5f) / a_occlusion.height;
+						result.At(x, y) = FilterAxis(u, v, false, a_occlusion, a_viewDepth, a_settings, sampleHorizontal);
+					}
+				}
+			}
+		}
+		return result;
+	}
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// CPU reference of the depth-aware blur in FilterCS.hlsl at full resolution raymarching, used to check that the
+// fused tiled pass produces the same result as the horizontal and vertical passes.
+// Depth is given in view space, the shaders reconstruct it from the depth buffer before comparing.
+namespace ShadowFilter
+{
+	// Same tile and apron as the FUSED variant of the shader
+	constexpr std::int32_t TILE_SIZE = 16;
+	constexpr std::int32_t APRON = 4;
+
+	struct Image
+	{
+		std::uint32_t width = 0;
+		std::uint32_t height = 0;
+		std::vector<float> texels;
+
+		Image() = default;
+		Image(std::uint32_t a_width, std::uint32_t a_height, float a_value = 0.0f) :
+			width(a_width), height(a_height), texels((std::size_t)a_width * a_height, a_value) {}
+
+		float& At(std::uint32_t x, std::uint32_t y) { return texels[(std::size_t)y * width + x]; }
+		float At(std::uint32_t x, std::uint32_t y) const { return texels[(std::size_t)y * width + x]; }
+
+		// Texel with clamped coordinates, like Load through a clamp sampler
+		float Load(std::int32_t x, std::int32_t y) const;
+
+		// Bilinear sample with clamp addressing, like SampleLevel with the linear clamp sampler
+		float Sample(float u, float v) const;
+	};
+
+	struct Settings
+	{
+		float BlurRadius = 0.5f;
+		float BlurDropoff = 0.005f;
+	};
+
+	// Horizontal pass into a half resolution intermediate, then the vertical pass sampling it.
+	// a_occlusion and a_viewDepth are full resolution, the result covers the half resolution the passes write.
+	Image FilterTwoPass(const Image& a_occlusion, const Image& a_viewDepth, const Settings& a_settings);
+
+	// Both axes per tile, the horizontal result of the tile and its vertical apron is kept in a local array
+	// in place of group shared memory.
+	Image FilterFused(const Image& a_occlusion, const Image& a_viewDepth, const Settings& a_settings);
+}
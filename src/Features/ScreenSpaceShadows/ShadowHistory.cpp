@@ -0,0 +1,70 @@
+#include "ShadowHistory.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ShadowHistory
+{
+	// Value of (x, y) in the a_size x a_size ordered dither matrix, a_size being a power of two
+	static std::uint32_t GetBayerValue(std::uint32_t x, std::uint32_t y, std::uint32_t a_size)
+	{
+		std::uint32_t value = 0;
+		for (std::uint32_t bit = a_size >> 1; bit > 0; bit >>= 1) {
+			bool bx = x & bit;
+			bool by = y & bit;
+			value = (value << 2) | ((by ? 2u : 0u) ^ (bx != by ? 1u : 0u));
+		}
+		return value;
+	}
+
+	Jitter GetJitter(std::uint32_t a_frame, std::uint32_t a_scale)
+	{
+		if (a_scale <= 1)
+			return { 0, 0 };
+
+		auto index = a_frame % (a_scale * a_scale);
+		for (std::uint32_t y = 0; y < a_scale; y++) {
+			for (std::uint32_t x = 0; x < a_scale; x++) {
+				if (GetBayerValue(x, y, a_scale) == index)
+					return { x, y };
+			}
+		}
+		return { 0, 0 };
+	}
+
+	std::uint32_t GetDispatchSize(float a_resolution, std::uint32_t a_scale, std::uint32_t a_groupSize)
+	{
+		auto pixels = (std::uint32_t)std::ceil(a_resolution / std::max(a_scale, 1u));
+		return std::max((pixels + a_groupSize - 1) / a_groupSize, 1u);
+	}
+
+	static float Length(const float a_vector[3])
+	{
+		return std::sqrt(a_vector[0] * a_vector[0] + a_vector[1] * a_vector[1] + a_vector[2] * a_vector[2]);
+	}
+
+	float Tracker::Update(const Camera& a_camera)
+	{
+		bool keep = valid && a_camera.width == previous.width && a_camera.height == previous.height && a_camera.scale == previous.scale;
+		if (keep) {
+			float delta[3] = { a_camera.position[0] - previous.position[0], a_camera.position[1] - previous.position[1], a_camera.position[2] - previous.position[2] };
+			float lengths = Length(a_camera.forward) * Length(previous.forward);
+			float cosAngle = lengths > 0.0f ?
+			                     (a_camera.forward[0] * previous.forward[0] + a_camera.forward[1] * previous.forward[1] + a_camera.forward[2] * previous.forward[2]) / lengths :
+			                     1.0f;
+			keep = Length(delta) < CUT_DISTANCE && cosAngle > CUT_COS_ANGLE;
+		}
+
+		previous = a_camera;
+		valid = true;
+
+		if (!keep) {
+			resetCount++;
+			accumulatedFrames = 0;
+			return 0.0f;
+		}
+
+		accumulatedFrames = std::min(accumulatedFrames + 1, MAX_HISTORY_FRAMES - 1);
+		return 1.0f - 1.0f / (accumulatedFrames + 1);
+	}
+}
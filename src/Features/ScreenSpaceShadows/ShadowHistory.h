@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+
+// Frame to frame bookkeeping of the reduced resolution screen-space shadows: which pixel of each block is traced,
+// how many groups cover the traced pixels and how much of the accumulated history can be kept.
+namespace ShadowHistory
+{
+	struct Jitter
+	{
+		std::uint32_t x;
+		std::uint32_t y;
+	};
+
+	// Pixel of each a_scale x a_scale block traced this frame, every pixel of the block is visited once per a_scale^2 frames in ordered dither order
+	Jitter GetJitter(std::uint32_t a_frame, std::uint32_t a_scale);
+
+	// Thread groups needed along one axis to trace a_resolution pixels at 1/a_scale of the resolution
+	std::uint32_t GetDispatchSize(float a_resolution, std::uint32_t a_scale, std::uint32_t a_groupSize);
+
+	class Tracker
+	{
+	public:
+		static constexpr std::uint32_t MAX_HISTORY_FRAMES = 8;
+		static constexpr float CUT_DISTANCE = 256.0f;  // camera movement in a single frame treated as a cut
+		static constexpr float CUT_COS_ANGLE = 0.7f;   // camera rotation in a single frame treated as a cut
+
+		struct Camera
+		{
+			float position[3];
+			float forward[3];
+			std::uint32_t width;
+			std::uint32_t height;
+			std::uint32_t scale;
+		};
+
+		// Weight of the history in this frame's result, 0 when it has to be discarded
+		float Update(const Camera& a_camera);
+
+		// Discards the history on the next update, for example after a loading screen
+		void Invalidate() { valid = false; }
+
+		std::uint32_t GetAccumulatedFrames() const { return accumulatedFrames; }
+		std::uint64_t GetResetCount() const { return resetCount; }
+
+	private:
+		Camera previous{};
+		bool valid = false;
+		std::uint32_t accumulatedFrames = 0;
+		std::uint64_t resetCount = 0;
+	};
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Buffer.h"
+#include "SettingsBlock.h"
 #include "Feature.h"
 
 struct WaterBlending : Feature
@@ -33,7 +34,7 @@ public:
 
 	Settings settings;
 
-	std::unique_ptr<Buffer> perPass = nullptr;
+	std::unique_ptr<SettingsBlock<PerPass>> perPass = nullptr;
 
 	virtual void SetupResources();
 	virtual inline void Reset() {}
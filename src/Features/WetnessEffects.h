@@ -1,7 +1,9 @@
 #pragma once
 
 #include "Buffer.h"
+#include "SettingsBlock.h"
 #include "Feature.h"
+#include "Features/WetnessEffects/WetnessModel.h"
 
 struct WetnessEffects : Feature
 {
@@ -42,14 +44,11 @@ public:
 
 	Settings settings;
 
-	std::unique_ptr<Buffer> perPass = nullptr;
+	std::unique_ptr<SettingsBlock<PerPass>> perPass = nullptr;
 
 	bool requiresUpdate = true;
-	float wetnessDepth = 0.0f;
-	float puddleDepth = 0.0f;
-	float lastGameTimeValue = 0.0f;
-	uint32_t currentWeatherID = 0;
-	uint32_t lastWeatherID = 0;
+	bool worldDrawn = false;  // the model only advances on frames drawing the world, not in loading screens or frozen menus
+	WetnessModel model;
 
 	virtual void SetupResources();
 	virtual void Reset();
@@ -62,6 +61,6 @@ public:
 	virtual void Save(json& o_json);
 
 	virtual void RestoreDefaultSettings();
-	float CalculateWeatherTransitionPercentage(float skyCurrentWeatherPct, float beginFade, bool fadeIn);
-	void CalculateWetness(RE::TESWeather* weather, RE::Sky* sky, float seconds, float& wetness, float& puddleWetness);
+	static WetnessModel::Weather GetWeather(RE::TESWeather* weather);
+	void UpdateWetness();
 };
@@ -0,0 +1,108 @@
+#include "WetnessModel.h"
+
+#include <algorithm>
+#include <cmath>
+
+float WetnessModel::CalculateWeatherTransitionPercentage(float a_skyCurrentWeatherPct, float a_beginFade, bool a_fadeIn)
+{
+	float weatherTransitionPercentage = DEFAULT_TRANSITION_PERCENTAGE;
+	// Correct if beginFade is zero or negative
+	a_beginFade = a_beginFade > 0 ? a_beginFade : a_beginFade + TRANSITION_DENOMINATOR;
+	// Wait to start transition until precipitation begins/ends
+	float startPercentage = (TRANSITION_DENOMINATOR - a_beginFade) * (1.0f / TRANSITION_DENOMINATOR);
+
+	if (a_fadeIn) {
+		float currentPercentage = (a_skyCurrentWeatherPct - startPercentage) / (1 - startPercentage);
+		weatherTransitionPercentage = std::clamp(currentPercentage, 0.0f, 1.0f);
+	} else {
+		float currentPercentage = (startPercentage - a_skyCurrentWeatherPct) / (startPercentage);
+		weatherTransitionPercentage = 1 - std::clamp(currentPercentage, 0.0f, 1.0f);
+	}
+	return weatherTransitionPercentage;
+}
+
+void WetnessModel::CalculateWetness(Precipitation a_precipitation, float a_seconds, float& a_wetnessDepth, float& a_puddleDepth)
+{
+	float deltaPerSecond = CLEAR_DAY_DELTA_PER_SECOND;
+	switch (a_precipitation) {
+	case Precipitation::Rainy:
+		deltaPerSecond = RAIN_DELTA_PER_SECOND;
+		break;
+	case Precipitation::Snowy:
+		deltaPerSecond = SNOWY_DAY_DELTA_PER_SECOND;
+		break;
+	case Precipitation::Cloudy:
+		deltaPerSecond = CLOUDY_DAY_DELTA_PER_SECOND;
+		break;
+	default:
+		break;
+	}
+
+	float wetnessDepthDelta = deltaPerSecond * WETNESS_SCALE * a_seconds;
+	float puddleDepthDelta = deltaPerSecond * PUDDLE_SCALE * a_seconds;
+
+	a_wetnessDepth = wetnessDepthDelta > 0 ? std::min(a_wetnessDepth + wetnessDepthDelta, MAX_WETNESS_DEPTH) : std::max(a_wetnessDepth + wetnessDepthDelta, 0.0f);
+	a_puddleDepth = puddleDepthDelta > 0 ? std::min(a_puddleDepth + puddleDepthDelta, MAX_PUDDLE_DEPTH) : std::max(a_puddleDepth + puddleDepthDelta, 0.0f);
+}
+
+void WetnessModel::Update(const Input& a_input)
+{
+	wetness = DRY_WETNESS;
+	puddleWetness = DRY_WETNESS;
+	currentWeatherID = 0;
+	std::uint32_t previousLastWeatherID = lastWeatherID;
+	lastWeatherID = 0;
+
+	if (!a_input.active)
+		return;
+
+	currentWeatherID = a_input.currentWeather.id;
+	if (!a_input.hasGameTime)
+		return;
+
+	float currentWeatherWetnessDepth = wetnessDepth;
+	float currentWeatherPuddleDepth = puddleDepth;
+	float currentGameTime = a_input.gameTime;
+	lastGameTimeValue = lastGameTimeValue == 0 ? currentGameTime : lastGameTimeValue;
+	float seconds = currentGameTime - lastGameTimeValue;
+	lastGameTimeValue = currentGameTime;
+
+	if (std::abs(seconds) >= MAX_TIME_DELTA) {
+		// If too much time has passed, snap wetness depths to the current weather.
+		seconds = 0.0f;
+		currentWeatherWetnessDepth = 0.0f;
+		currentWeatherPuddleDepth = 0.0f;
+		CalculateWetness(a_input.currentWeather.precipitation, 1.0f, currentWeatherWetnessDepth, currentWeatherPuddleDepth);
+		wetnessDepth = currentWeatherWetnessDepth > 0 ? MAX_WETNESS_DEPTH : 0.0f;
+		puddleDepth = currentWeatherPuddleDepth > 0 ? MAX_PUDDLE_DEPTH : 0.0f;
+	}
+
+	if (seconds > 0 || (seconds < 0 && (wetnessDepth > 0 || puddleDepth > 0))) {
+		float weatherTransitionPercentage = DEFAULT_TRANSITION_PERCENTAGE;
+		float lastWeatherWetnessDepth = wetnessDepth;
+		float lastWeatherPuddleDepth = puddleDepth;
+		seconds *= a_input.transitionSpeed;
+		CalculateWetness(a_input.currentWeather.precipitation, seconds, currentWeatherWetnessDepth, currentWeatherPuddleDepth);
+		// If there is a lastWeather, figure out what type it is and set the wetness
+		if (a_input.hasLastWeather) {
+			lastWeatherID = a_input.lastWeather.id;
+			CalculateWetness(a_input.lastWeather.precipitation, seconds, lastWeatherWetnessDepth, lastWeatherPuddleDepth);
+			// If it was raining, wait to transition until precipitation ends, otherwise use the current weather's fade in
+			if (a_input.lastWeather.rainy) {
+				weatherTransitionPercentage = CalculateWeatherTransitionPercentage(a_input.currentWeatherPct, a_input.lastWeather.precipitationEndFadeOut, false);
+			} else {
+				weatherTransitionPercentage = CalculateWeatherTransitionPercentage(a_input.currentWeatherPct, a_input.currentWeather.precipitationBeginFadeIn, true);
+			}
+		}
+
+		// Transition between CurrentWeather and LastWeather depth values
+		wetnessDepth = std::lerp(lastWeatherWetnessDepth, currentWeatherWetnessDepth, weatherTransitionPercentage);
+		puddleDepth = std::lerp(lastWeatherPuddleDepth, currentWeatherPuddleDepth, weatherTransitionPercentage);
+	} else {
+		lastWeatherID = previousLastWeatherID;
+	}
+
+	// Calculate the wetness value from the water depth
+	wetness = std::min(wetnessDepth, MAX_WETNESS);
+	puddleWetness = std::min(puddleDepth, MAX_PUDDLE_WETNESS);
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+
+// Rain wetness and puddle depth integrated over game time and weather transitions.
+// Allocation free, tests/WetnessSimulator.cpp replays weather and time traces through it outside of the game.
+class WetnessModel
+{
+public:
+	static constexpr float MIN_START_PERCENTAGE = 0.05f;
+	static constexpr float DEFAULT_TRANSITION_PERCENTAGE = 1.0f;
+	static constexpr float TRANSITION_CURVE_MULTIPLIER = 2.0f;
+	static constexpr float TRANSITION_DENOMINATOR = 256.0f;
+	static constexpr float DRY_WETNESS = 0.0f;
+	static constexpr float RAIN_DELTA_PER_SECOND = 2.0f / 3600.0f;
+	static constexpr float SNOWY_DAY_DELTA_PER_SECOND = -0.489f / 3600.0f;  // Only doing evaporation until snow wetness feature is added
+	static constexpr float CLOUDY_DAY_DELTA_PER_SECOND = -0.735f / 3600.0f;
+	static constexpr float CLEAR_DAY_DELTA_PER_SECOND = -1.518f / 3600.0f;
+	static constexpr float WETNESS_SCALE = 2.0;  // Speed at which wetness builds up and drys.
+	static constexpr float PUDDLE_SCALE = 1.0;   // Speed at which puddles build up and dry
+	static constexpr float MAX_PUDDLE_DEPTH = 3.0f;
+	static constexpr float MAX_WETNESS_DEPTH = 2.0f;
+	static constexpr float MAX_PUDDLE_WETNESS = 1.0f;
+	static constexpr float MAX_WETNESS = 1.0f;
+	static constexpr float SECONDS_IN_A_DAY = 86400;
+	static constexpr float MAX_TIME_DELTA = SECONDS_IN_A_DAY - 30;
+
+	enum class Precipitation
+	{
+		Clear,
+		Cloudy,
+		Rainy,
+		Snowy
+	};
+
+	struct Weather
+	{
+		std::uint32_t id = 0;
+		Precipitation precipitation = Precipitation::Clear;
+		bool rainy = false;  // rain flag, also set on weathers without precipitation data
+		float precipitationBeginFadeIn = 0.0f;
+		float precipitationEndFadeOut = 0.0f;
+	};
+
+	struct Input
+	{
+		bool active = false;       // effect enabled, full sky and a current weather
+		bool hasGameTime = false;  // calendar available
+		float gameTime = 0.0f;     // game seconds
+		float currentWeatherPct = 1.0f;
+		float transitionSpeed = 1.0f;
+		Weather currentWeather;
+		bool hasLastWeather = false;
+		Weather lastWeather;
+	};
+
+	// Advances the model by the game time passed since the previous update, a skip of a day or more snaps to the current weather
+	void Update(const Input& a_input);
+
+	float GetWetness() const { return wetness; }
+	float GetPuddleWetness() const { return puddleWetness; }
+	float GetWetnessDepth() const { return wetnessDepth; }
+	float GetPuddleDepth() const { return puddleDepth; }
+	std::uint32_t GetCurrentWeatherID() const { return currentWeatherID; }
+	std::uint32_t GetLastWeatherID() const { return lastWeatherID; }
+
+	static float CalculateWeatherTransitionPercentage(float a_skyCurrentWeatherPct, float a_beginFade, bool a_fadeIn);
+	static void CalculateWetness(Precipitation a_precipitation, float a_seconds, float& a_wetnessDepth, float& a_puddleDepth);
+
+private:
+	float wetnessDepth = 0.0f;
+	float puddleDepth = 0.0f;
+	float lastGameTimeValue = 0.0f;
+	float wetness = DRY_WETNESS;
+	float puddleWetness = DRY_WETNESS;
+	std::uint32_t currentWeatherID = 0;
+	std::uint32_t lastWeatherID = 0;
+};
@@ -0,0 +1,121 @@
+#include "FrameCapture.h"
+
+namespace FrameCapture
+{
+	namespace
+	{
+		constexpr std::uint32_t FileMagic = 0x43464343;  // "CCFC"
+		constexpr std::uint32_t FileVersion = 1;
+	}
+
+	bool Writer::Start(const std::filesystem::path& a_path, std::uint32_t a_frameCount)
+	{
+		std::scoped_lock lock{ mutex };
+		if (capturing)
+			return false;
+
+		std::error_code ec;
+		std::filesystem::create_directories(a_path.parent_path(), ec);
+		file.open(a_path, std::ios::binary | std::ios::trunc);
+		if (!file)
+			return false;
+		file.write(reinterpret_cast<const char*>(&FileMagic), sizeof(FileMagic));
+		file.write(reinterpret_cast<const char*>(&FileVersion), sizeof(FileVersion));
+
+		capturing = true;
+		inFrame = false;
+		frameCount = a_frameCount;
+		capturedFrames = 0;
+		capturedBytes = sizeof(FileMagic) + sizeof(FileVersion);
+		return true;
+	}
+
+	void Writer::Stop()
+	{
+		std::scoped_lock lock{ mutex };
+		StopLocked();
+	}
+
+	void Writer::StopLocked()
+	{
+		if (!capturing)
+			return;
+		file.close();
+		capturing = false;
+		inFrame = false;
+	}
+
+	void Writer::BeginFrame(std::uint64_t a_frameIndex)
+	{
+		if (!capturing)
+			return;
+		std::scoped_lock lock{ mutex };
+		if (!capturing)
+			return;
+		if (inFrame && ++capturedFrames >= frameCount) {
+			StopLocked();
+			return;
+		}
+		inFrame = true;
+		WriteLocked(RecordType::Frame, &a_frameIndex, sizeof(a_frameIndex));
+	}
+
+	void Writer::Write(RecordType a_type, const void* a_data, std::size_t a_size)
+	{
+		if (!capturing)
+			return;
+		std::scoped_lock lock{ mutex };
+		WriteLocked(a_type, a_data, a_size);
+	}
+
+	void Writer::WriteLocked(RecordType a_type, const void* a_data, std::size_t a_size)
+	{
+		if (!capturing || !inFrame)
+			return;
+		auto size = static_cast<std::uint32_t>(a_size);
+		file.write(reinterpret_cast<const char*>(&a_type), sizeof(a_type));
+		file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+		file.write(static_cast<const char*>(a_data), size);
+		capturedBytes += sizeof(a_type) + sizeof(size) + size;
+	}
+
+	bool Reader::Open(const std::filesystem::path& a_path)
+	{
+		file.open(a_path, std::ios::binary);
+		std::uint32_t magic = 0;
+		std::uint32_t version = 0;
+		file.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+		file.read(reinterpret_cast<char*>(&version), sizeof(version));
+		hasPendingFrame = false;
+		return file && magic == FileMagic && version == FileVersion;
+	}
+
+	bool Reader::ReadRecord(Record& a_record)
+	{
+		std::uint32_t size = 0;
+		if (!file.read(reinterpret_cast<char*>(&a_record.type), sizeof(a_record.type)) || !file.read(reinterpret_cast<char*>(&size), sizeof(size)))
+			return false;
+		a_record.data.resize(size);
+		return size == 0 || file.read(reinterpret_cast<char*>(a_record.data.data()), size);
+	}
+
+	bool Reader::NextFrame(std::uint64_t& a_frameIndex, std::vector<Record>& a_records)
+	{
+		a_records.clear();
+		if (!hasPendingFrame && !(ReadRecord(pendingFrame) && pendingFrame.type == RecordType::Frame))
+			return false;
+		pendingFrame.Get(a_frameIndex);
+		hasPendingFrame = false;
+
+		Record record;
+		while (ReadRecord(record)) {
+			if (record.type == RecordType::Frame) {
+				pendingFrame = std::move(record);
+				hasPendingFrame = true;
+				break;
+			}
+			a_records.push_back(std::move(record));
+		}
+		return true;
+	}
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+// Per-frame inputs of the standard library only feature models (WetnessModel, CollisionGrid, ShadowHistory::Tracker,
+// LightGathering) recorded to a compact binary stream, so a session can be replayed against them by tests/FrameReplay.
+namespace FrameCapture
+{
+	enum class RecordType : std::uint16_t
+	{
+		Frame,             // uint64_t frame index, starts every frame
+		WetnessInput,      // WetnessModel::Input
+		CollisionSpheres,  // CollisionGrid::Sphere array
+		ShadowCamera,      // ShadowHistory::Tracker::Camera
+		LightCamera,       // LightGathering::Camera, posAdjust of both eyes and the light fade
+		LightSettings,     // LightGathering::Settings
+		PointLights,       // LightGathering::PointLight array
+		ParticleLights,    // LightGathering::ParticleLight array, particles of mesh particle systems and billboards
+	};
+
+	struct Record
+	{
+		RecordType type;
+		std::vector<std::uint8_t> data;
+
+		template <class T>
+		bool Get(T& a_value) const
+		{
+			static_assert(std::is_trivially_copyable_v<T>);
+			if (data.size() != sizeof(T))
+				return false;
+			std::memcpy(&a_value, data.data(), sizeof(T));
+			return true;
+		}
+
+		template <class T>
+		bool GetArray(std::vector<T>& a_values) const
+		{
+			static_assert(std::is_trivially_copyable_v<T>);
+			if (data.size() % sizeof(T))
+				return false;
+			a_values.resize(data.size() / sizeof(T));
+			std::memcpy(a_values.data(), data.data(), data.size());
+			return true;
+		}
+	};
+
+	class Writer
+	{
+	public:
+		// Records the next a_frameCount frames, the first frame starts with the next BeginFrame
+		bool Start(const std::filesystem::path& a_path, std::uint32_t a_frameCount);
+		void Stop();
+		// Safe to poll from any thread, a frame is only written while capturing
+		bool IsCapturing() const { return capturing; }
+		std::uint32_t GetCapturedFrames() const { return capturedFrames; }
+		std::uint64_t GetCapturedBytes() const { return capturedBytes; }
+
+		// Ends the previous frame and starts the next one, stops once enough frames were recorded
+		void BeginFrame(std::uint64_t a_frameIndex);
+
+		void Write(RecordType a_type, const void* a_data, std::size_t a_size);
+
+		template <class T>
+		void Write(RecordType a_type, const T& a_value)
+		{
+			static_assert(std::is_trivially_copyable_v<T>);
+			Write(a_type, &a_value, sizeof(T));
+		}
+
+		template <class T>
+		void WriteArray(RecordType a_type, const std::vector<T>& a_values)
+		{
+			static_assert(std::is_trivially_copyable_v<T>);
+			Write(a_type, a_values.data(), a_values.size() * sizeof(T));
+		}
+
+	private:
+		void StopLocked();
+		void WriteLocked(RecordType a_type, const void* a_data, std::size_t a_size);
+
+		// the file and inFrame are guarded by the mutex, the counters are atomic for the menu
+		std::ofstream file;
+		std::atomic<bool> capturing = false;
+		bool inFrame = false;
+		std::uint32_t frameCount = 0;
+		std::atomic<std::uint32_t> capturedFrames = 0;
+		std::atomic<std::uint64_t> capturedBytes = 0;
+		std::mutex mutex;
+	};
+
+	class Reader
+	{
+	public:
+		bool Open(const std::filesystem::path& a_path);
+
+		// Records of the next frame, false once the stream ends
+		bool NextFrame(std::uint64_t& a_frameIndex, std::vector<Record>& a_records);
+
+	private:
+		bool ReadRecord(Record& a_record);
+
+		std::ifstream file;
+		bool hasPendingFrame = false;
+		Record pendingFrame;
+	};
+}
@@ -4,77 +4,27 @@
 
 #include "Menu.h"
 #include "ShaderCache.h"
+#include "ShaderDump.h"
 #include "State.h"
 
 #include "ShaderTools/BSShaderHooks.h"
 
-std::unordered_map<void*, std::pair<std::unique_ptr<uint8_t[]>, size_t>> ShaderBytecodeMap;
-
-void RegisterShaderBytecode(void* Shader, const void* Bytecode, size_t BytecodeLength)
-{
-	// Grab a copy since the pointer isn't going to be valid forever
-	auto codeCopy = std::make_unique<uint8_t[]>(BytecodeLength);
-	memcpy(codeCopy.get(), Bytecode, BytecodeLength);
-	logger::debug(fmt::runtime("Saving shader at index {:x} with {} bytes:\t{:x}"), (std::uintptr_t)Shader, BytecodeLength, (std::uintptr_t)Bytecode);
-	ShaderBytecodeMap.emplace(Shader, std::make_pair(std::move(codeCopy), BytecodeLength));
-}
-
-const std::pair<std::unique_ptr<uint8_t[]>, size_t>& GetShaderBytecode(void* Shader)
-{
-	logger::debug(fmt::runtime("Loading shader at index {:x}"), (std::uintptr_t)Shader);
-	return ShaderBytecodeMap.at(Shader);
-}
-
-void DumpShader(const REX::BSShader* thisClass, const RE::BSGraphics::VertexShader* shader, const std::pair<std::unique_ptr<uint8_t[]>, size_t>& bytecode)
+void DumpShader(const REX::BSShader* thisClass, const RE::BSGraphics::VertexShader* shader)
 {
-	uint8_t* dxbcData = new uint8_t[bytecode.second];
-	size_t dxbcLen = bytecode.second;
-	memcpy(dxbcData, bytecode.first.get(), bytecode.second);
-
 	std::string dumpDir = std::format("Data\\ShaderDump\\{}\\{}.vs.bin", thisClass->m_LoaderType, shader->id);
 	auto directoryPath = std::format("Data\\ShaderDump\\{}", thisClass->m_LoaderType);
 	logger::debug(fmt::runtime("Dumping vertex shader {} with id {:x} at {}"), thisClass->m_LoaderType, shader->id, dumpDir);
 
-	if (!std::filesystem::is_directory(directoryPath)) {
-		try {
-			std::filesystem::create_directories(directoryPath);
-		} catch (std::filesystem::filesystem_error const& ex) {
-			logger::error("Failed to create folder: {}", ex.what());
-		}
-	}
-
-	if (FILE * file; fopen_s(&file, dumpDir.c_str(), "wb") == 0) {
-		fwrite(dxbcData, 1, dxbcLen, file);
-		fclose(file);
-	}
-
-	delete[] dxbcData;
+	ShaderDump::GetSingleton()->Dump(shader->shader, directoryPath, dumpDir);
 }
 
-void DumpShader(const REX::BSShader* thisClass, const RE::BSGraphics::PixelShader* shader, const std::pair<std::unique_ptr<uint8_t[]>, size_t>& bytecode)
+void DumpShader(const REX::BSShader* thisClass, const RE::BSGraphics::PixelShader* shader)
 {
-	uint8_t* dxbcData = new uint8_t[bytecode.second];
-	size_t dxbcLen = bytecode.second;
-	memcpy(dxbcData, bytecode.first.get(), bytecode.second);
-
 	std::string dumpDir = std::format("Data\\ShaderDump\\{}\\{:X}.ps.bin", thisClass->m_LoaderType, shader->id);
-
 	auto directoryPath = std::format("Data\\ShaderDump\\{}", thisClass->m_LoaderType);
 	logger::debug(fmt::runtime("Dumping pixel shader {} with id {:x} at {}"), thisClass->m_LoaderType, shader->id, dumpDir);
-	if (!std::filesystem::is_directory(directoryPath)) {
-		try {
-			std::filesystem::create_directories(directoryPath);
-		} catch (std::filesystem::filesystem_error const& ex) {
-			logger::error("Failed to create folder: {}", ex.what());
-		}
-	}
-
-	if (FILE * file; fopen_s(&file, dumpDir.c_str(), "wb") == 0) {
-		fwrite(dxbcData, 1, dxbcLen, file);
-		fclose(file);
-	}
 
-	delete[] dxbcData;
+	ShaderDump::GetSingleton()->Dump(shader->shader, directoryPath, dumpDir);
 }
 
 void hk_BSShader_LoadShaders(RE::BSShader* shader, std::uintptr_t stream);
@@ -85,12 +35,12 @@ void hk_BSShader_LoadShaders(RE::BSShader* shader, std::uintptr_t stream)
 {
 	(ptr_BSShader_LoadShaders)(shader, stream);
 	auto& shaderCache = SIE::ShaderCache::Instance();
+	shaderCache.AddLoadedShader(*shader);
 
 	if (shaderCache.IsDiskCache() || shaderCache.IsDump()) {
 		for (const auto& entry : shader->vertexShaders) {
 			if (entry->shader && shaderCache.IsDump()) {
-				auto& bytecode = GetShaderBytecode(entry->shader);
-				DumpShader((REX::BSShader*)shader, entry, bytecode);
+				DumpShader((REX::BSShader*)shader, entry);
 			}
 			auto vertexShaderDesriptor = entry->id;
 			auto pixelShaderDescriptor = entry->id;
@@ -99,8 +49,7 @@ void hk_BSShader_LoadShaders(RE::BSShader* shader, std::uintptr_t stream)
 		}
 		for (const auto& entry : shader->pixelShaders) {
 			if (entry->shader && shaderCache.IsDump()) {
-				auto& bytecode = GetShaderBytecode(entry->shader);
-				DumpShader((REX::BSShader*)shader, entry, bytecode);
+				DumpShader((REX::BSShader*)shader, entry);
 			}
 			auto vertexShaderDesriptor = entry->id;
 			auto pixelShaderDescriptor = entry->id;
@@ -151,7 +100,7 @@ HRESULT hk_CreateVertexShader(ID3D11Device* This, const void* pShaderBytecode, S
 	HRESULT hr = (This->*ptrCreateVertexShader)(pShaderBytecode, BytecodeLength, pClassLinkage, ppVertexShader);
 
 	if (SUCCEEDED(hr))
-		RegisterShaderBytecode(*ppVertexShader, pShaderBytecode, BytecodeLength);
+		ShaderDump::GetSingleton()->Register(*ppVertexShader, pShaderBytecode, BytecodeLength);
 
 	return hr;
 }
@@ -161,7 +110,7 @@ HRESULT STDMETHODCALLTYPE hk_CreatePixelShader(ID3D11Device* This, const void* p
 	HRESULT hr = (This->*ptrCreatePixelShader)(pShaderBytecode, BytecodeLength, pClassLinkage, ppPixelShader);
 
 	if (SUCCEEDED(hr))
-		RegisterShaderBytecode(*ppPixelShader, pShaderBytecode, BytecodeLength);
+		ShaderDump::GetSingleton()->Register(*ppPixelShader, pShaderBytecode, BytecodeLength);
 
 	return hr;
 }
@@ -322,6 +271,11 @@ namespace Hooks
 				auto& io = ImGui::GetIO();
 				io.ClearInputKeys();
 				io.ClearEventsQueue();
+			} else if (a_msg == WM_CLOSE || a_msg == WM_DESTROY) {
+				// the game is exiting, saves still waiting for the coalescing delay would be lost
+				State::GetSingleton()->settingsWriter.Flush();
+				if (SIE::ShaderCache::Instance().IsDiskCache())
+					SIE::ShaderCache::Instance().WriteCompileCosts();
 			}
 			return func(a_hwnd, a_msg, a_wParam, a_lParam);
 		}
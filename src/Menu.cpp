@@ -5,11 +5,14 @@
 #include <imgui_stdlib.h>
 #include <magic_enum.hpp>
 
+#include "Benchmarks.h"
 #include "ShaderCache.h"
+#include "ShaderDump.h"
 #include "State.h"
 
 #include "Feature.h"
-#include "Features/LightLimitFix/ParticleLights.h"
+#include "Features/LightLimitFIx/ParticleLights.h"
+#include "SettingsBlock.h"
 
 #define SETTING_MENU_TOGGLEKEY "Toggle Key"
 #define SETTING_MENU_SKIPKEY "Skip Compilation Key"
@@ -64,6 +67,7 @@ void SetupImGuiStyle()
 }
 
 bool IsEnabled = false;
+bool WasEnabled = false;
 ImVec4 TextColor = ImVec4{ 1.0f, 1.0f, 1.0f, 1.0f };
 
 Menu::~Menu()
@@ -300,6 +304,15 @@ void Menu::DrawSettings()
 			if (auto _tt = Util::HoverTooltipWrapper()) {
 				ImGui::Text("Dump shaders at startup. This should be used only when reversing shaders. Normal users don't need this.");
 			}
+			bool useHotReload = shaderCache.IsHotReload();
+			if (ImGui::Checkbox("Hot Reload Shaders", &useHotReload)) {
+				shaderCache.SetHotReload(useHotReload);
+			}
+			if (auto _tt = Util::HoverTooltipWrapper()) {
+				ImGui::Text(
+					"Watch Data/Shaders for changes and recompile only the shaders including a changed file in the background. "
+					"This should be used only when developing shaders. Normal users don't need this.");
+			}
 			spdlog::level::level_enum logLevel = State::GetSingleton()->GetLogLevel();
 			const char* items[] = {
 				"trace",
@@ -364,6 +377,32 @@ void Menu::DrawSettings()
 			if (ImGui::Button("Dump Ini Settings", { -1, 0 })) {
 				Util::DumpSettingsOptions();
 			}
+			if (State::GetSingleton()->IsDeveloperMode()) {
+				if (ImGui::Button("Run Benchmarks", { -1, 0 })) {
+					Benchmarks::Run();
+				}
+				if (auto _tt = Util::HoverTooltipWrapper()) {
+					ImGui::Text(
+						"Times shader key generation, shader lookup remapping, particle light config lookup and the feature models "
+						"against the loaded game and writes the results to Benchmarks.json. The game freezes for a few seconds. ");
+				}
+			}
+			auto& frameCapture = State::GetSingleton()->frameCapture;
+			if (frameCapture.IsCapturing()) {
+				auto captureButtonString = std::format("Stop Frame Capture ({}/{})", frameCapture.GetCapturedFrames(), State::FRAME_CAPTURE_FRAMES);
+				if (ImGui::Button(captureButtonString.c_str(), { -1, 0 })) {
+					frameCapture.Stop();
+				}
+			} else if (ImGui::Button("Capture Frames", { -1, 0 })) {
+				auto& path = State::GetSingleton()->frameCapturePath;
+				if (!frameCapture.Start(path, State::FRAME_CAPTURE_FRAMES))
+					logger::error("Failed to start frame capture to {}", path);
+			}
+			if (auto _tt = Util::HoverTooltipWrapper()) {
+				ImGui::Text(
+					"Records the per-frame inputs of the wetness, grass collision and screen-space shadow history models "
+					"for the next frames to FrameCapture.bin, so they can be replayed outside of the game. ");
+			}
 			if (!shaderCache.blockedKey.empty()) {
 				auto blockingButtonString = std::format("Stop Blocking {} Shaders", shaderCache.blockedIDs.size());
 				if (ImGui::Button(blockingButtonString.c_str(), { -1, 0 })) {
@@ -379,6 +418,23 @@ void Menu::DrawSettings()
 			}
 			if (ImGui::TreeNodeEx("Statistics", ImGuiTreeNodeFlags_DefaultOpen)) {
 				ImGui::Text(std::format("Shader Compiler : {}", shaderCache.GetShaderStatsString()).c_str());
+				ImGui::Text(std::format("Startup Stages : {}", shaderCache.GetStageStatsString()).c_str());
+				ImGui::Text(std::format("Shader Bytecode : {}", shaderCache.GetBytecodeStatsString()).c_str());
+				ImGui::Text(std::format("Shader Sources : {}", shaderCache.GetSourceStatsString()).c_str());
+				if (shaderCache.IsDump()) {
+					ImGui::Text(std::format("Shader Dump : {}", ShaderDump::GetSingleton()->GetStatsString()).c_str());
+				}
+				if (shaderCache.IsHotReload()) {
+					ImGui::Text(std::format("Hot Reload : {}", shaderCache.GetHotReloadStatsString()).c_str());
+				}
+				auto& settingsBlockStats = SettingsBlockBase::GetLastFrameStats();
+				auto settingsBlockString = std::format("{} uploads ({} unchanged) last frame",
+					settingsBlockStats.uploads, settingsBlockStats.skippedUploads);
+				ImGui::Text(std::format("Settings Blocks : {}", settingsBlockString).c_str());
+				auto settingsWriterStats = State::GetSingleton()->settingsWriter.GetStats();
+				auto settingsWriterString = std::format("{} requested, {} written, {} failed, last write {:.2f} ms",
+					settingsWriterStats.requests, settingsWriterStats.writes, settingsWriterStats.failures, settingsWriterStats.lastWriteMs);
+				ImGui::Text(std::format("Settings Saves : {}", settingsWriterString).c_str());
 				ImGui::TreePop();
 			}
 		}
@@ -493,6 +549,7 @@ void Menu::DrawOverlay()
 		}
 		ImGui::TextUnformatted(progressTitle.c_str());
 		ImGui::ProgressBar(percent, ImVec2(0.0f, 0.0f), progressOverlay.c_str());
+		ImGui::TextUnformatted(shaderCache.GetStageStatsString().c_str());
 		if (!shaderCache.backgroundCompilation && shaderCache.menuLoaded) {
 			auto skipShadersText = fmt::format(
 				"Press {} to proceed without completing shader compilation. "
@@ -527,6 +584,11 @@ void Menu::DrawOverlay()
 		ImGui::GetIO().MouseDrawCursor = false;
 	}
 
+	// saves made in the menu are written once it closes rather than after the coalescing delay, the game may be quit next
+	if (WasEnabled && !IsEnabled)
+		State::GetSingleton()->settingsWriter.Expedite();
+	WasEnabled = IsEnabled;
+
 	if (inTestMode) {  // In test mode
 		float seconds = (float)duration_cast<std::chrono::milliseconds>(high_resolution_clock::now() - lastTestSwitch).count() / 1000;
 		auto remaining = (float)testInterval - seconds;
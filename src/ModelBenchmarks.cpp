@@ -0,0 +1,161 @@
+#include "ModelBenchmarks.h"
+
+#include "Features/GrassCollision/CollisionGrid.h"
+#include "Features/GrassCollision/CollisionPacking.h"
+#include "Features/LightLimitFIx/LightGathering.h"
+#include "Features/LightLimitFIx/ParticleLightConfigs.h"
+#include "Features/ScreenSpaceShadows/ShadowHistory.h"
+#include "Features/WetnessEffects/WetnessModel.h"
+#include "TaskStateTable.h"
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+
+namespace
+{
+	// CompilationSet::Add, WaitTake and Complete without the shader tasks, which need the game: the sharded state table
+	// in front of one cost ordered queue under a single mutex
+	struct CompileQueue
+	{
+		TaskStateTable states;
+		std::mutex mutex;
+		std::multimap<double, std::size_t, std::greater<double>> available;
+
+		void Add(std::size_t a_id, double a_cost)
+		{
+			if (!states.TryAdd(a_id))
+				return;
+			std::scoped_lock lock{ mutex };
+			available.emplace(a_cost, a_id);
+		}
+
+		std::optional<std::size_t> Take()
+		{
+			std::scoped_lock lock{ mutex };
+			if (available.empty())
+				return std::nullopt;
+			auto id = available.extract(available.begin()).mapped();
+			states.Set(id, TaskStateTable::State::InProgress);
+			return id;
+		}
+
+		void Complete(std::size_t a_id, bool a_succeeded)
+		{
+			states.Finish(a_id, a_succeeded ? TaskStateTable::State::Completed : TaskStateTable::State::Failed);
+		}
+	};
+}
+
+void ModelBenchmarks::Add(BenchmarkSuite& a_suite)
+{
+	std::vector<CollisionGrid::Sphere> spheres;
+	for (int i = 0; i < 64; i++)
+		spheres.push_back({ (float)(i % 8) * 150.0f, (float)(i / 8) * 150.0f, 40.0f + (float)(i % 5) * 20.0f });
+	a_suite.Add("GrassCollision/BuildGrid", [spheres, grid = CollisionGrid()]() mutable {
+		grid.Build(spheres);
+		BenchmarkSuite::DoNotOptimize(grid.GetMaxCellCount());
+	});
+
+	// N actors of M bodies walking around the player: the gathered positions are moved on the calling thread as the game
+	// objects are read there, then packed in parallel and binned. The havok reads themselves only run in game.
+	for (std::uint32_t actorCount : { 1u, 16u, 64u }) {
+		for (std::uint32_t bodyCount : { 4u, 16u }) {
+			std::vector<std::vector<CollisionPacking::Bounds>> actors(actorCount, std::vector<CollisionPacking::Bounds>(bodyCount));
+			auto name = "GrassCollision/GatherAndPack/" + std::to_string(actorCount) + "x" + std::to_string(bodyCount);
+			a_suite.Add(name, [actors, frame = 0u, bodies = std::vector<const CollisionPacking::Bounds*>(), packed = std::vector<CollisionPacking::Sphere>(),
+								  gridSpheres = std::vector<CollisionGrid::Sphere>(), grid = CollisionGrid()]() mutable {
+				frame++;
+				bodies.clear();
+				for (std::uint32_t actor = 0; actor < actors.size(); actor++) {
+					float x = (float)(actor % 8) * 120.0f + (float)frame;
+					float y = (float)(actor / 8) * 120.0f;
+					for (std::uint32_t body = 0; body < actors[actor].size(); body++) {
+						auto& bounds = actors[actor][body];
+						CollisionPacking::Move(bounds, { x + (float)(body % 4) * 10.0f, y, (float)body * 8.0f }, 1.0f / 60.0f);
+						bounds.radius = 10.0f + (float)(body % 3) * 5.0f;
+						bodies.push_back(&bounds);
+					}
+				}
+				const CollisionPacking::Vector3 eyes[2]{ { 0.0f, 0.0f, 120.0f }, { 6.0f, 0.0f, 120.0f } };
+				CollisionPacking::Pack(bodies, eyes, 1, 0.008f, 2.0f, packed, gridSpheres);
+				grid.Build(gridSpheres);
+				BenchmarkSuite::DoNotOptimize(grid.GetMaxCellCount());
+			});
+		}
+	}
+
+	// eight threads standing in for the draw thread and the compile workers, each queueing ids that collide with the other
+	// threads', taking the most expensive queued task and completing it. One iteration is the whole batch.
+	constexpr std::uint32_t CompileThreads = 8;
+	constexpr std::uint32_t CompileOperations = 1024;
+	a_suite.Add("CompilationSet/AddTakeComplete/8x1024", [queue = std::make_shared<CompileQueue>()] {
+		queue->states.Clear();
+		queue->available.clear();
+		{
+			std::vector<std::jthread> threads;
+			for (std::uint32_t thread = 0; thread < CompileThreads; thread++) {
+				threads.emplace_back([&queue, thread] {
+					std::minstd_rand random{ thread + 1 };
+					for (std::uint32_t i = 0; i < CompileOperations; i++) {
+						auto id = random() % 4096;
+						queue->Add(id, (double)(id % 97));
+						if (auto taken = queue->Take())
+							queue->Complete(*taken, *taken % 7 != 0);
+					}
+				});
+			}
+		}
+		BenchmarkSuite::DoNotOptimize(queue->available.size());
+	});
+
+	// 1,000 configs as the Particle Lights mods ship them, looked up by texture path with every other path missing
+	ParticleLightConfigs::Map<float> particleConfigs;
+	std::vector<std::string> texturePaths;
+	for (int i = 0; i < 1000; i++) {
+		auto stem = "fxfire" + std::to_string(i);
+		particleConfigs.try_emplace(stem, 1.0f + (float)i);
+		texturePaths.push_back("Effects\\FXFire" + std::to_string(i) + ".dds");
+		texturePaths.push_back("Effects\\FXSmoke" + std::to_string(i) + ".dds");
+	}
+	a_suite.Add("ParticleLights/ConfigLookup1000", [particleConfigs, texturePaths, index = std::size_t(0)]() mutable {
+		char stemBuffer[ParticleLightConfigs::MAX_STEM];
+		auto stem = ParticleLightConfigs::GetStem(texturePaths[index++ % texturePaths.size()], stemBuffer);
+		BenchmarkSuite::DoNotOptimize(particleConfigs.find(stem) != particleConfigs.end());
+	});
+
+	a_suite.Add("WetnessEffects/UpdateModel", [model = WetnessModel(), gameTime = 0.0f]() mutable {
+		WetnessModel::Input input;
+		input.active = true;
+		input.hasGameTime = true;
+		input.gameTime = gameTime += 10.0f;
+		input.currentWeather.precipitation = WetnessModel::Precipitation::Rainy;
+		model.Update(input);
+		BenchmarkSuite::DoNotOptimize(model.GetWetness());
+	});
+
+	a_suite.Add("ScreenSpaceShadows/HistoryUpdate", [tracker = ShadowHistory::Tracker(), frame = 0u]() mutable {
+		ShadowHistory::Tracker::Camera camera{ { (float)(frame++ % 64), 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, 1920, 1080, 2 };
+		BenchmarkSuite::DoNotOptimize(tracker.Update(camera));
+	});
+
+	// a town at night: 128 point lights, four fires of 256 particles each and a row of torches
+	LightGathering::Camera camera{};
+	camera.lightFadeStart = 4000.0f * 4000.0f;
+	camera.lightFadeEnd = 5000.0f * 5000.0f;
+	std::vector<LightGathering::PointLight> pointLights;
+	for (int i = 0; i < 128; i++)
+		pointLights.push_back({ { (float)(i % 16) * 500.0f, (float)(i / 16) * 500.0f, 200.0f }, 400.0f, { 1.0f, 0.8f, 0.6f }, 0 });
+	std::vector<LightGathering::ParticleLight> particleLights;
+	for (int i = 0; i < 1024; i++)
+		particleLights.push_back({ { (float)(i / 256) * 1500.0f + (float)(i % 7) * 6.0f, (float)(i % 5) * 6.0f, (float)(i % 256) }, 20.0f, 1.0f, { 1.0f, 0.5f, 0.1f }, 0.5f, 0 });
+	for (int i = 0; i < 32; i++)
+		particleLights.push_back({ { (float)i * 250.0f, -400.0f, 150.0f }, 4.0f, 1.0f, { 1.0f, 0.6f, 0.2f }, 1.0f, 1 });
+	a_suite.Add("LightLimitFix/GatherLights", [camera, pointLights, particleLights, lights = std::vector<LightGathering::Light>()]() mutable {
+		lights.clear();
+		LightGathering::Gather(camera, {}, pointLights, particleLights, lights);
+		BenchmarkSuite::DoNotOptimize(lights.size());
+	});
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+#include "BenchmarkSuite.h"
+
+namespace ModelBenchmarks
+{
+	// Cases of the feature models that run on synthetic inputs, shared by the in-game benchmark and tests/CommunityShadersBench
+	void Add(BenchmarkSuite& a_suite);
+}
@@ -0,0 +1,141 @@
+#include "ReflectionRecordFile.h"
+
+#include <cstring>
+#include <fstream>
+
+namespace
+{
+	constexpr size_t MaxPayloadSize = sizeof(uint64_t) + sizeof(uint32_t) * 3 + sizeof(uint64_t) + sizeof(uint8_t) + ReflectionRecord::MaxConstants;
+
+	uint32_t GetChecksum(const char* a_data, size_t a_size)
+	{
+		uint32_t checksum = 0x811c9dc5u;
+		for (size_t i = 0; i < a_size; i++) {
+			checksum ^= static_cast<uint8_t>(a_data[i]);
+			checksum *= 0x01000193u;
+		}
+		return checksum;
+	}
+
+	template <class T>
+	void Put(std::string& a_buffer, const T& a_value)
+	{
+		a_buffer.append(reinterpret_cast<const char*>(&a_value), sizeof(T));
+	}
+
+	template <class T>
+	bool Take(const char*& a_data, const char* a_end, T& a_value)
+	{
+		if (a_end - a_data < (ptrdiff_t)sizeof(T))
+			return false;
+		std::memcpy(&a_value, a_data, sizeof(T));
+		a_data += sizeof(T);
+		return true;
+	}
+}
+
+std::string ReflectionRecordFile::SerializeHeader()
+{
+	std::string header;
+	Put(header, Magic);
+	Put(header, Version);
+	return header;
+}
+
+std::string ReflectionRecordFile::Serialize(uint64_t a_hash, const ReflectionRecord& a_record)
+{
+	std::string payload;
+	Put(payload, a_hash);
+	for (auto size : a_record.bufferSizes)
+		Put(payload, size);
+	Put(payload, a_record.vertexDesc);
+	Put(payload, a_record.constantCount);
+	payload.append(reinterpret_cast<const char*>(a_record.constantOffsets.data()), a_record.constantCount);
+
+	std::string record;
+	Put(record, static_cast<uint32_t>(payload.size()));
+	Put(record, GetChecksum(payload.data(), payload.size()));
+	record += payload;
+	return record;
+}
+
+ReflectionRecordFile::ReadResult ReflectionRecordFile::Read(std::istream& a_stream, const std::function<void(uint64_t, const ReflectionRecord&)>& a_callback, uint64_t& a_validSize)
+{
+	a_validSize = 0;
+	uint32_t magic = 0;
+	uint32_t version = 0;
+	a_stream.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+	a_stream.read(reinterpret_cast<char*>(&version), sizeof(version));
+	if (!a_stream || magic != Magic || version != Version)
+		return ReadResult::Invalid;
+	a_validSize = sizeof(magic) + sizeof(version);
+
+	char payload[MaxPayloadSize];
+	while (true) {
+		uint32_t size = 0;
+		uint32_t checksum = 0;
+		a_stream.read(reinterpret_cast<char*>(&size), sizeof(size));
+		if (a_stream.gcount() == 0 && a_stream.eof())
+			return ReadResult::Valid;
+		a_stream.read(reinterpret_cast<char*>(&checksum), sizeof(checksum));
+		if (!a_stream || size > MaxPayloadSize)
+			return ReadResult::Truncated;
+		a_stream.read(payload, size);
+		if (!a_stream || GetChecksum(payload, size) != checksum)
+			return ReadResult::Truncated;
+
+		uint64_t hash = 0;
+		ReflectionRecord record;
+		const char* data = payload;
+		const char* end = payload + size;
+		bool valid = Take(data, end, hash);
+		for (auto& bufferSize : record.bufferSizes)
+			valid = valid && Take(data, end, bufferSize);
+		valid = valid && Take(data, end, record.vertexDesc) && Take(data, end, record.constantCount);
+		if (!valid || record.constantCount > ReflectionRecord::MaxConstants || end - data != record.constantCount)
+			return ReadResult::Truncated;
+		std::memcpy(record.constantOffsets.data(), data, record.constantCount);
+
+		a_callback(hash, record);
+		a_validSize += sizeof(size) + sizeof(checksum) + size;
+	}
+}
+
+ReflectionRecordFile::ReadResult ReflectionRecordFile::Load(const std::filesystem::path& a_path, const std::function<void(uint64_t, const ReflectionRecord&)>& a_callback)
+{
+	uint64_t validSize = 0;
+	ReadResult result;
+	{
+		std::ifstream file{ a_path, std::ios::binary };
+		if (!file)
+			return ReadResult::Invalid;
+		result = Read(file, a_callback, validSize);
+	}
+
+	std::error_code ec;
+	if (result == ReadResult::Invalid) {
+		std::filesystem::remove(a_path, ec);
+	} else if (result == ReadResult::Truncated) {
+		// later appends would otherwise land behind the bad record and never be read
+		std::filesystem::resize_file(a_path, validSize, ec);
+	}
+	return result;
+}
+
+bool ReflectionRecordFile::Append(const std::filesystem::path& a_path, const std::string& a_records)
+{
+	std::error_code ec;
+	bool exists = std::filesystem::exists(a_path, ec);
+	if (!exists)
+		std::filesystem::create_directories(a_path.parent_path(), ec);
+
+	std::ofstream file{ a_path, std::ios::binary | std::ios::app };
+	if (!file)
+		return false;
+	if (!exists) {
+		auto header = SerializeHeader();
+		file.write(header.data(), header.size());
+	}
+	file.write(a_records.data(), a_records.size());
+	return (bool)file.flush();
+}
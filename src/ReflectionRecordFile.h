@@ -0,0 +1,48 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <istream>
+#include <string>
+
+// Result of reflecting a shader, shared by every descriptor that compiles to the same bytecode
+struct ReflectionRecord
+{
+	static constexpr size_t MaxConstants = 64;
+
+	std::array<uint32_t, 3> bufferSizes = { 0, 0, 0 };
+	std::array<int8_t, MaxConstants> constantOffsets{};
+	uint8_t constantCount = 0;
+	uint64_t vertexDesc = 0;
+};
+
+// Append only file of reflection records keyed by bytecode hash. Every record is length prefixed and
+// checksummed, so a torn or corrupt append only costs that record and the file is truncated back to
+// the last good one when it is read.
+class ReflectionRecordFile
+{
+public:
+	static constexpr uint32_t Magic = 0x46525343;  // "CSRF"
+	static constexpr uint32_t Version = 2;
+
+	static std::string SerializeHeader();
+	static std::string Serialize(uint64_t a_hash, const ReflectionRecord& a_record);
+
+	enum class ReadResult
+	{
+		Valid,
+		Truncated,  // stopped at a bad record, everything before it was read
+		Invalid     // missing or outdated header
+	};
+
+	// Calls a_callback for every record up to the first bad one, a_validSize is the size of the good prefix
+	static ReadResult Read(std::istream& a_stream, const std::function<void(uint64_t, const ReflectionRecord&)>& a_callback, uint64_t& a_validSize);
+
+	// Reads the file and cuts off anything after the last good record, an invalid file is removed
+	static ReadResult Load(const std::filesystem::path& a_path, const std::function<void(uint64_t, const ReflectionRecord&)>& a_callback);
+
+	// Appends serialized records, writing the header first if the file does not exist yet
+	static bool Append(const std::filesystem::path& a_path, const std::string& a_records);
+};
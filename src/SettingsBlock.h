@@ -0,0 +1,117 @@
+#pragma once
+
+#include "Buffer.h"
+
+// Upload bookkeeping shared by every settings block
+class SettingsBlockBase
+{
+public:
+	struct Stats
+	{
+		std::uint32_t uploads = 0;
+		std::uint32_t skippedUploads = 0;
+	};
+
+	// Called once per frame
+	static void NewFrame()
+	{
+		lastFrameStats = frameStats;
+		frameStats = {};
+	}
+
+	static const Stats& GetLastFrameStats() { return lastFrameStats; }
+
+protected:
+	static inline Stats frameStats;
+	static inline Stats lastFrameStats;
+};
+
+// Per-pass data of a feature that changes rarely, typically its settings.
+// Set() bumps a generation only when the contents change and Upload() only writes the buffer when the generation moved.
+// Callers still bind the buffer on every draw, other features and the game may have replaced the slot in between.
+template <typename T>
+class SettingsBlock : public SettingsBlockBase
+{
+public:
+	enum class Kind
+	{
+		Constant,   // constant buffer, bound with CB()
+		Structured  // single element structured buffer, bound with SRV()
+	};
+
+	explicit SettingsBlock(Kind a_kind) :
+		kind(a_kind)
+	{
+		if (kind == Kind::Constant) {
+			constantBuffer = std::make_unique<ConstantBuffer>(ConstantBufferDesc<T>());
+			return;
+		}
+
+		D3D11_BUFFER_DESC sbDesc{};
+		sbDesc.Usage = D3D11_USAGE_DYNAMIC;
+		sbDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+		sbDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+		sbDesc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+		sbDesc.StructureByteStride = sizeof(T);
+		sbDesc.ByteWidth = sizeof(T);
+		structuredBuffer = std::make_unique<Buffer>(sbDesc);
+
+		D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc;
+		srvDesc.Format = DXGI_FORMAT_UNKNOWN;
+		srvDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+		srvDesc.Buffer.FirstElement = 0;
+		srvDesc.Buffer.NumElements = 1;
+		structuredBuffer->CreateSRV(srvDesc);
+	}
+
+	// Stores new contents, the generation only moves when they differ from the current ones
+	void Set(const T& a_data)
+	{
+		if (generation != 0 && memcmp(&a_data, &data, sizeof(T)) == 0)
+			return;
+		data = a_data;
+		generation++;
+	}
+
+	// Writes the buffer if the contents changed since the last upload
+	void Upload()
+	{
+		if (uploadedGeneration == generation) {
+			frameStats.skippedUploads++;
+			return;
+		}
+		uploadedGeneration = generation;
+		frameStats.uploads++;
+
+		if (kind == Kind::Constant) {
+			constantBuffer->Update(data);
+			return;
+		}
+
+		auto context = RE::BSGraphics::Renderer::GetSingleton()->GetRuntimeData().context;
+		D3D11_MAPPED_SUBRESOURCE mapped;
+		DX::ThrowIfFailed(context->Map(structuredBuffer->resource.get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped));
+		memcpy_s(mapped.pData, sizeof(T), &data, sizeof(T));
+		context->Unmap(structuredBuffer->resource.get(), 0);
+	}
+
+	void Update(const T& a_data)
+	{
+		Set(a_data);
+		Upload();
+	}
+
+	const T& Get() const { return data; }
+	std::uint64_t GetGeneration() const { return generation; }
+
+	ID3D11Buffer* CB() const { return constantBuffer ? constantBuffer->CB() : nullptr; }
+	ID3D11ShaderResourceView* SRV() const { return structuredBuffer ? structuredBuffer->srv.get() : nullptr; }
+
+private:
+	Kind kind;
+	std::unique_ptr<ConstantBuffer> constantBuffer;
+	std::unique_ptr<Buffer> structuredBuffer;
+	T data{};
+	std::uint64_t generation = 0;
+	std::uint64_t uploadedGeneration = 0;
+};
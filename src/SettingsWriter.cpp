@@ -0,0 +1,129 @@
+#include "SettingsWriter.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+
+SettingsWriter::SettingsWriter(Clock::duration a_delay, Logger a_onError) :
+	delay(a_delay), onError(std::move(a_onError))
+{
+	thread = std::jthread([this](std::stop_token a_stop) { Run(a_stop); });
+}
+
+SettingsWriter::~SettingsWriter()
+{
+	thread.request_stop();
+	thread.join();
+	Flush();
+}
+
+void SettingsWriter::Write(const std::string& a_path, std::string a_contents)
+{
+	{
+		std::scoped_lock lock{ mutex };
+		pending.insert_or_assign(a_path, Pending{ std::move(a_contents), Clock::now() + delay });
+		stats.requests++;
+	}
+	condition.notify_all();
+}
+
+void SettingsWriter::Flush()
+{
+	std::unique_lock lock{ mutex };
+	// a write already taken off the queue by the background thread has to land first
+	condition.wait(lock, [this] { return !writing; });
+	WritePending(lock, true);
+}
+
+void SettingsWriter::Expedite()
+{
+	{
+		std::scoped_lock lock{ mutex };
+		auto now = Clock::now();
+		for (auto& [path, item] : pending)
+			item.due = std::min(item.due, now);
+	}
+	condition.notify_all();
+}
+
+SettingsWriter::Stats SettingsWriter::GetStats() const
+{
+	std::scoped_lock lock{ mutex };
+	return stats;
+}
+
+bool SettingsWriter::WriteAtomic(const std::string& a_path, const std::string& a_contents)
+{
+	auto temporaryPath = a_path + ".tmp";
+	{
+		std::ofstream file{ temporaryPath, std::ios::binary | std::ios::trunc };
+		if (!file)
+			return false;
+		file.write(a_contents.data(), a_contents.size());
+		file.flush();
+		if (!file)
+			return false;
+	}
+	std::error_code ec;
+	std::filesystem::rename(temporaryPath, a_path, ec);
+	if (ec) {
+		std::filesystem::remove(temporaryPath, ec);
+		return false;
+	}
+	return true;
+}
+
+void SettingsWriter::WritePending(std::unique_lock<std::mutex>& a_lock, bool a_all)
+{
+	auto now = Clock::now();
+	for (auto it = pending.begin(); it != pending.end();) {
+		if (!a_all && it->second.due > now) {
+			++it;
+			continue;
+		}
+		auto path = it->first;
+		auto contents = std::move(it->second.contents);
+		it = pending.erase(it);
+
+		writing = true;
+		a_lock.unlock();
+		auto start = Clock::now();
+		bool written = WriteAtomic(path, contents);
+		auto elapsed = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+		if (!written && onError)
+			onError(path);
+		a_lock.lock();
+		writing = false;
+
+		stats.lastWriteMs = elapsed;
+		if (written)
+			stats.writes++;
+		else
+			stats.failures++;
+		// the queue may have changed while unlocked
+		it = pending.begin();
+		condition.notify_all();
+	}
+}
+
+void SettingsWriter::Run(std::stop_token a_stop)
+{
+	std::unique_lock lock{ mutex };
+	while (!a_stop.stop_requested()) {
+		if (pending.empty()) {
+			condition.wait(lock, a_stop, [this] { return !pending.empty(); });
+			continue;
+		}
+		auto due = Clock::time_point::max();
+		for (auto& [path, item] : pending)
+			due = std::min(due, item.due);
+		if (due > Clock::now()) {
+			// a newer save only queues a later deadline, so sleep through it unless Expedite moved one earlier
+			condition.wait_until(lock, a_stop, due, [this, due] {
+				return std::ranges::any_of(pending, [due](auto& a_item) { return a_item.second.due < due; });
+			});
+			continue;
+		}
+		WritePending(lock, false);
+	}
+}
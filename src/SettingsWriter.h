@@ -0,0 +1,61 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Writes settings files on a background thread, saves of the same file arriving within the delay are coalesced into one write.
+// Each write goes to a temporary file first and is renamed over the target, so a crash never leaves a truncated file behind.
+class SettingsWriter
+{
+public:
+	using Clock = std::chrono::steady_clock;
+	using Logger = std::function<void(const std::string&)>;
+
+	explicit SettingsWriter(Clock::duration a_delay = std::chrono::milliseconds(500), Logger a_onError = {});
+	~SettingsWriter();
+
+	// Queues the contents, replacing any earlier contents for the same file that were not written yet
+	void Write(const std::string& a_path, std::string a_contents);
+
+	// Writes everything queued before returning
+	void Flush();
+
+	// Makes everything queued due now and returns without waiting for the write
+	void Expedite();
+
+	struct Stats
+	{
+		uint64_t requests = 0;
+		uint64_t writes = 0;
+		uint64_t failures = 0;
+		double lastWriteMs = 0;
+	};
+	Stats GetStats() const;
+
+	static bool WriteAtomic(const std::string& a_path, const std::string& a_contents);
+
+private:
+	struct Pending
+	{
+		std::string contents;
+		Clock::time_point due;
+	};
+
+	void Run(std::stop_token a_stop);
+	void WritePending(std::unique_lock<std::mutex>& a_lock, bool a_all);
+
+	Clock::duration delay;
+	Logger onError;
+	std::map<std::string, Pending> pending;
+	Stats stats;
+	bool writing = false;
+	mutable std::mutex mutex;
+	std::condition_variable_any condition;
+	std::jthread thread;
+};
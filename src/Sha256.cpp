@@ -0,0 +1,121 @@
+#include "Sha256.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+	constexpr std::uint32_t RoundConstants[64] = {
+		0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+		0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+		0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+		0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+		0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+		0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+		0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+		0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+	};
+
+	constexpr std::uint32_t RotateRight(std::uint32_t a_value, int a_bits) { return (a_value >> a_bits) | (a_value << (32 - a_bits)); }
+}
+
+void Sha256::Transform(const std::uint8_t* a_block)
+{
+	std::uint32_t w[64];
+	for (int i = 0; i < 16; i++)
+		w[i] = (std::uint32_t)a_block[i * 4] << 24 | (std::uint32_t)a_block[i * 4 + 1] << 16 | (std::uint32_t)a_block[i * 4 + 2] << 8 | a_block[i * 4 + 3];
+	for (int i = 16; i < 64; i++) {
+		auto s0 = RotateRight(w[i - 15], 7) ^ RotateRight(w[i - 15], 18) ^ (w[i - 15] >> 3);
+		auto s1 = RotateRight(w[i - 2], 17) ^ RotateRight(w[i - 2], 19) ^ (w[i - 2] >> 10);
+		w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+	}
+
+	auto [a, b, c, d, e, f, g, h] = state;
+	for (int i = 0; i < 64; i++) {
+		auto s1 = RotateRight(e, 6) ^ RotateRight(e, 11) ^ RotateRight(e, 25);
+		auto choice = (e & f) ^ (~e & g);
+		auto temp1 = h + s1 + choice + RoundConstants[i] + w[i];
+		auto s0 = RotateRight(a, 2) ^ RotateRight(a, 13) ^ RotateRight(a, 22);
+		auto majority = (a & b) ^ (a & c) ^ (b & c);
+		auto temp2 = s0 + majority;
+		h = g;
+		g = f;
+		f = e;
+		e = d + temp1;
+		d = c;
+		c = b;
+		b = a;
+		a = temp1 + temp2;
+	}
+
+	state[0] += a;
+	state[1] += b;
+	state[2] += c;
+	state[3] += d;
+	state[4] += e;
+	state[5] += f;
+	state[6] += g;
+	state[7] += h;
+}
+
+void Sha256::Update(const void* a_data, std::size_t a_size)
+{
+	auto data = static_cast<const std::uint8_t*>(a_data);
+	length += a_size;
+
+	if (bufferSize) {
+		auto count = std::min(a_size, buffer.size() - bufferSize);
+		std::memcpy(buffer.data() + bufferSize, data, count);
+		bufferSize += count;
+		data += count;
+		a_size -= count;
+		if (bufferSize < buffer.size())
+			return;
+		Transform(buffer.data());
+		bufferSize = 0;
+	}
+
+	for (; a_size >= buffer.size(); data += buffer.size(), a_size -= buffer.size())
+		Transform(data);
+
+	std::memcpy(buffer.data(), data, a_size);
+	bufferSize = a_size;
+}
+
+Sha256::Digest Sha256::Finish()
+{
+	auto bitLength = length * 8;
+	std::uint8_t padding[72] = { 0x80 };
+	auto paddingSize = (bufferSize < 56 ? 56 : 120) - bufferSize;
+	for (int i = 0; i < 8; i++)
+		padding[paddingSize + i] = (std::uint8_t)(bitLength >> (56 - i * 8));
+	Update(padding, paddingSize + 8);
+
+	Digest digest;
+	for (std::size_t i = 0; i < state.size(); i++) {
+		digest[i * 4] = (std::uint8_t)(state[i] >> 24);
+		digest[i * 4 + 1] = (std::uint8_t)(state[i] >> 16);
+		digest[i * 4 + 2] = (std::uint8_t)(state[i] >> 8);
+		digest[i * 4 + 3] = (std::uint8_t)state[i];
+	}
+	return digest;
+}
+
+Sha256::Digest Sha256::Hash(std::string_view a_data)
+{
+	Sha256 sha;
+	sha.Update(a_data);
+	return sha.Finish();
+}
+
+std::string Sha256::ToString(const Digest& a_digest)
+{
+	constexpr char Hex[] = "0123456789ABCDEF";
+	std::string result;
+	result.reserve(a_digest.size() * 2);
+	for (auto byte : a_digest) {
+		result += Hex[byte >> 4];
+		result += Hex[byte & 0xF];
+	}
+	return result;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Incremental SHA-256 (FIPS 180-4), for content keys where a collision would silently reuse the wrong data
+class Sha256
+{
+public:
+	using Digest = std::array<std::uint8_t, 32>;
+
+	void Update(const void* a_data, std::size_t a_size);
+	void Update(std::string_view a_data) { Update(a_data.data(), a_data.size()); }
+
+	// Pads the message and returns its digest, the object has to be reset before it is reused
+	Digest Finish();
+	void Reset() { *this = Sha256{}; }
+
+	static Digest Hash(std::string_view a_data);
+	static std::string ToString(const Digest& a_digest);
+
+private:
+	void Transform(const std::uint8_t* a_block);
+
+	std::array<std::uint32_t, 8> state = { 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 };
+	std::array<std::uint8_t, 64> buffer{};
+	std::size_t bufferSize = 0;
+	std::uint64_t length = 0;
+};
@@ -2,13 +2,18 @@
 
 #include <RE/V/VertexDesc.h>
 
+#include <charconv>
 #include <d3d11.h>
 #include <d3dcompiler.h>
 #include <fmt/std.h>
+#include <fstream>
 #include <wrl/client.h>
 
 #include "Feature.h"
+#include "ReflectionRecordFile.h"
+#include "ShaderDependencyGraph.h"
 #include "State.h"
+#include "Util.h"
 
 namespace SIE
 {
@@ -928,6 +933,112 @@ namespace SIE
 			mapBufferConsts("PerGeometry", bufferSizes[2]);
 		}
 
+		// Reflection records per shader file, persisted next to its blobs in the disk cache
+		class ReflectionCache
+		{
+		public:
+			static ReflectionCache& Instance()
+			{
+				static ReflectionCache instance;
+				return instance;
+			}
+
+			std::optional<ReflectionRecord> Get(const std::string& a_name, uint64_t a_hash, bool a_useDiskCache)
+			{
+				std::scoped_lock lock{ mutex };
+				if (a_useDiskCache && !loaded.contains(a_name)) {
+					Load(a_name);
+				}
+				auto& fileRecords = records[a_name];
+				if (auto it = fileRecords.find(a_hash); it != fileRecords.end()) {
+					hits++;
+					return it->second;
+				}
+				return std::nullopt;
+			}
+
+			void Add(const std::string& a_name, uint64_t a_hash, const ReflectionRecord& a_record, bool a_useDiskCache)
+			{
+				{
+					std::scoped_lock lock{ mutex };
+					misses++;
+					if (!records[a_name].emplace(a_hash, a_record).second || !a_useDiskCache)
+						return;
+				}
+
+				// appended under a separate lock so the other compile threads never wait on the file
+				auto serialized = ReflectionRecordFile::Serialize(a_hash, a_record);
+				std::scoped_lock fileLock{ fileMutex };
+				if (!ReflectionRecordFile::Append(GetPath(a_name), serialized)) {
+					logger::warn("Failed to append to reflection cache {}", GetPath(a_name).string());
+				}
+			}
+
+			std::atomic<uint64_t> hits = 0;
+			std::atomic<uint64_t> misses = 0;
+
+		private:
+			static std::filesystem::path GetPath(const std::string& a_name)
+			{
+				return std::filesystem::path(std::format("Data/ShaderCache/{}/Reflection.bin", a_name));
+			}
+
+			void Load(const std::string& a_name)
+			{
+				loaded.insert(a_name);
+				auto& fileRecords = records[a_name];
+				std::scoped_lock fileLock{ fileMutex };
+				auto result = ReflectionRecordFile::Load(GetPath(a_name), [&](uint64_t a_hash, const ReflectionRecord& a_record) {
+					fileRecords.insert_or_assign(a_hash, a_record);
+				});
+				if (result == ReflectionRecordFile::ReadResult::Truncated) {
+					logger::info("Truncated damaged reflection cache for {} after {} records", a_name, fileRecords.size());
+				}
+				logger::debug("Loaded {} reflection records for {}", fileRecords.size(), a_name);
+			}
+
+			std::unordered_map<std::string, std::unordered_map<uint64_t, ReflectionRecord>> records;
+			std::unordered_set<std::string> loaded;
+			std::mutex mutex;
+			std::mutex fileMutex;  // serializes appends and loads of the record files
+		};
+
+		template <size_t MaxOffsetsSize>
+		static bool GetReflection(const ShaderBytecode& shaderData, const RE::BSShader& shader, ShaderClass shaderClass, uint32_t descriptor,
+			std::array<size_t, 3>& bufferSizes, std::array<int8_t, MaxOffsetsSize>& constantOffsets, uint64_t& vertexDesc)
+		{
+			static_assert(MaxOffsetsSize <= ReflectionRecord::MaxConstants);
+			const auto type = shader.shaderType.get();
+			const auto useDiskCache = ShaderCache::Instance().IsDiskCache();
+			const auto hash = Util::GetBytecodeHash(shaderData.data, shaderData.size);
+			auto& reflectionCache = ReflectionCache::Instance();
+
+			if (auto record = reflectionCache.Get(shader.fxpFilename, hash, useDiskCache)) {
+				std::copy(record->bufferSizes.begin(), record->bufferSizes.end(), bufferSizes.begin());
+				std::copy_n(record->constantOffsets.begin(), MaxOffsetsSize, constantOffsets.begin());
+				vertexDesc = record->vertexDesc;
+				return true;
+			}
+
+			Microsoft::WRL::ComPtr<ID3D11ShaderReflection> reflector;
+			const auto reflectionResult = D3DReflect(shaderData.data, shaderData.size,
+				IID_PPV_ARGS(&reflector));
+			if (FAILED(reflectionResult)) {
+				logger::error("Failed to reflect {} shader {}::{}", magic_enum::enum_name(shaderClass), magic_enum::enum_name(type),
+					descriptor);
+				return false;
+			}
+			ReflectConstantBuffers(*reflector.Get(), bufferSizes, constantOffsets, vertexDesc, shaderClass, type, descriptor);
+
+			ReflectionRecord record;
+			std::transform(bufferSizes.begin(), bufferSizes.end(), record.bufferSizes.begin(), [](size_t size) { return (uint32_t)size; });
+			std::copy(constantOffsets.begin(), constantOffsets.end(), record.constantOffsets.begin());
+			record.constantCount = (uint8_t)MaxOffsetsSize;
+			record.vertexDesc = vertexDesc;
+			reflectionCache.Add(shader.fxpFilename, hash, record, useDiskCache);
+			return true;
+		}
+
 		std::wstring GetDiskPath(const std::string_view& name, uint32_t descriptor, ShaderClass shaderClass)
 		{
 			switch (shaderClass) {
@@ -939,6 +1050,15 @@ namespace SIE
 			return std::format(L"Data/ShaderCache/{}/{:X}.cso", std::wstring(name.begin(), name.end()), descriptor);
 		}
 
+		static uint64_t GetCostKey(ShaderClass shaderClass, RE::BSShader::Type type, uint32_t descriptor)
+		{
+			std::array<D3D_SHADER_MACRO, 64> defines{};
+			GetShaderDefines(type, descriptor, &defines[0]);
+			auto defineCount = std::find_if(defines.begin(), defines.end(), [](const D3D_SHADER_MACRO& define) { return define.Name == nullptr; }) - defines.begin();
+			auto technique = type == RE::BSShader::Type::Lighting ? GetTechnique(descriptor) : 0;
+			return CompileCostModel::MakeKey(static_cast<uint32_t>(shaderClass), static_cast<uint32_t>(type), technique, static_cast<uint32_t>(defineCount));
+		}
+
 		static std::string GetShaderString(ShaderClass shaderClass, const RE::BSShader& shader, uint32_t descriptor, bool hashkey)
 		{
 			auto sourceShaderFile = shader.fxpFilename;
@@ -952,24 +1072,86 @@ namespace SIE
 			return result;
 		}
 
-		static ID3DBlob* CompileShader(ShaderClass shaderClass, const RE::BSShader& shader, uint32_t descriptor, bool useDiskCache)
+		// serves includes from the shared source cache instead of reading them from disk for every permutation
+		class CachedInclude : public ID3DInclude
+		{
+		public:
+			CachedInclude(ShaderSourceCache& a_cache, const std::wstring& a_source) :
+				scope(a_cache, a_source) {}
+
+			HRESULT __stdcall Open(D3D_INCLUDE_TYPE, LPCSTR a_fileName, LPCVOID a_parentData, LPCVOID* a_data, UINT* a_bytes) override
+			{
+				auto contents = scope.Open(a_fileName, a_parentData);
+				if (!contents)
+					return E_FAIL;
+				*a_data = contents->data();
+				*a_bytes = static_cast<UINT>(contents->size());
+				return S_OK;
+			}
+
+			HRESULT __stdcall Close(LPCVOID a_data) override
+			{
+				scope.Close(a_data);
+				return S_OK;
+			}
+
+		private:
+			ShaderSourceCache::Scope scope;
+		};
+
+		// null if the source can not be read or preprocessed, compiling it reports the error in full
+		static winrt::com_ptr<ID3DBlob> PreprocessShader(const std::wstring& a_path, const D3D_SHADER_MACRO* a_defines)
+		{
+			auto& cache = ShaderCache::Instance();
+			auto source = cache.sourceCache.Get(a_path);
+			if (!source)
+				return nullptr;
+
+			CachedInclude include{ cache.sourceCache, a_path };
+			const std::string pathString = std::filesystem::path(a_path).string();
+			winrt::com_ptr<ID3DBlob> preprocessedBlob;
+			ID3DBlob* errorBlob = nullptr;
+			if (FAILED(D3DPreprocess(source->data(), source->size(), pathString.c_str(), a_defines, &include, preprocessedBlob.put(), &errorBlob)))
+				preprocessedBlob = nullptr;
+			if (errorBlob != nullptr) {
+				errorBlob->Release();
+			}
+			return preprocessedBlob;
+		}
+
+		static ShaderBytecode MakeBytecode(ID3DBlob* a_blob)
+		{
+			ShaderBytecode bytecode;
+			bytecode.blob.copy_from(a_blob);
+			bytecode.data = a_blob->GetBufferPointer();
+			bytecode.size = a_blob->GetBufferSize();
+			return bytecode;
+		}
+
+		static ShaderBytecode CompileShader(ShaderClass shaderClass, const RE::BSShader& shader, uint32_t descriptor, bool useDiskCache)
 		{
 			ID3DBlob* shaderBlob = nullptr;
 
 			// check hashmap
 			auto& cache = ShaderCache::Instance();
-			if (shaderBlob = cache.GetCompletedShader(shaderClass, shader, descriptor); shaderBlob) {
+			if (auto bytecode = cache.GetCompletedShader(shaderClass, shader, descriptor)) {
 				// already compiled before
 				logger::debug("Shader already compiled; using cache: {}", SShaderCache::GetShaderString(shaderClass, shader, descriptor));
 				cache.IncCacheHitTasks();
-				return shaderBlob;
+				return bytecode;
 			}
 			const auto type = shader.shaderType.get();
 
 			// check diskcache
 			auto diskPath = GetDiskPath(shader.fxpFilename, descriptor, shaderClass);
+			if (useDiskCache && !std::filesystem::exists(diskPath)) {
+				// bytecode shared with another descriptor was released after creating its shader, reload it from there
+				if (auto evictedPath = cache.GetEvictedShaderDiskPath(GetShaderString(shaderClass, shader, descriptor, true)); !evictedPath.empty()) {
+					diskPath = evictedPath;
+				}
+			}
 
-			if (!shaderBlob && useDiskCache && std::filesystem::exists(diskPath)) {
+			if (useDiskCache && std::filesystem::exists(diskPath)) {
 				shaderBlob = nullptr;
 				if (FAILED(D3DReadFileToBlob(diskPath.c_str(), &shaderBlob))) {
 					logger::error("Failed to load {} shader {}::{}", magic_enum::enum_name(shaderClass), magic_enum::enum_name(type), descriptor);
@@ -983,8 +1165,9 @@ namespace SIE
 						return (char)c;
 					});
 					logger::debug("Loaded shader from {}", str);
-					cache.AddCompletedShader(shaderClass, shader, descriptor, shaderBlob);
-					return shaderBlob;
+					auto bytecode = MakeBytecode(shaderBlob);
+					cache.AddCompletedShader(shaderClass, shader, descriptor, shaderBlob, diskPath);
+					return bytecode;
 				}
 			}
 
@@ -1012,45 +1195,95 @@ namespace SIE
 
 			logger::debug("Defines set for {}:{}:{:X} to {}", magic_enum::enum_name(type), magic_enum::enum_name(shaderClass), descriptor, MergeDefinesString(defines));
 
-			// compile shaders
+			// preprocess first, permutations whose defines make no difference to the source share a single compile
 			const std::wstring path = GetShaderPath(shader.fxpFilename);
-			ID3DBlob* errorBlob = nullptr;
-			const uint32_t flags = D3DCOMPILE_OPTIMIZATION_LEVEL3;
-			const HRESULT compileResult = D3DCompileFromFile(path.c_str(), defines.data(), D3D_COMPILE_STANDARD_FILE_INCLUDE, "main",
-				GetShaderProfile(shaderClass), flags, 0, &shaderBlob, &errorBlob);
-
-			if (FAILED(compileResult)) {
-				if (errorBlob != nullptr) {
-					logger::error("Failed to compile {} shader {}::{}: {}",
-						magic_enum::enum_name(shaderClass), magic_enum::enum_name(type), descriptor,
-						static_cast<char*>(errorBlob->GetBufferPointer()));
-					errorBlob->Release();
-				} else {
-					logger::error("Failed to compile {} shader {}::{}",
-						magic_enum::enum_name(shaderClass), magic_enum::enum_name(type), descriptor);
+			const std::string pathString = std::filesystem::path(path).string();
+			const auto profile = GetShaderProfile(shaderClass);
+			auto preprocessedBlob = PreprocessShader(path, defines.data());
+			std::string representativeKey;
+			if (preprocessedBlob) {
+				auto digest = ShaderSourceGroups::HashSource(profile,
+					{ static_cast<const char*>(preprocessedBlob->GetBufferPointer()), preprocessedBlob->GetBufferSize() });
+				representativeKey = cache.sourceGroups.Add(static_cast<uint32_t>(type), digest, GetShaderString(shaderClass, shader, descriptor, true));
+			}
+
+			bool reused = false;
+			if (!representativeKey.empty()) {
+				switch (cache.GetShaderStatus(representativeKey)) {
+				case ShaderCompilationTask::Status::Completed:
+					if (auto bytecode = cache.GetCompletedShader(representativeKey); bytecode.blob) {
+						bytecode.blob.copy_to(&shaderBlob);
+						reused = true;
+					} else if (bytecode && SUCCEEDED(D3DCreateBlob(bytecode.size, &shaderBlob))) {
+						std::memcpy(shaderBlob->GetBufferPointer(), bytecode.data, bytecode.size);
+						reused = true;
+					} else if (auto evictedPath = cache.GetEvictedShaderDiskPath(representativeKey); !evictedPath.empty()) {
+						reused = SUCCEEDED(D3DReadFileToBlob(evictedPath.c_str(), &shaderBlob));
+					}
+					break;
+				case ShaderCompilationTask::Status::Failed:
+					logger::error("Failed to compile {} shader {}::{}: same source as {}",
+						magic_enum::enum_name(shaderClass), magic_enum::enum_name(type), descriptor, representativeKey);
+					cache.AddCompletedShader(shaderClass, shader, descriptor, nullptr);
+					return {};
+				default:
+					break;  // still compiling elsewhere, not worth waiting for
 				}
-				if (shaderBlob != nullptr) {
-					shaderBlob->Release();
+			}
+
+			if (reused) {
+				logger::debug("Reusing shader {} for {}:{}:{:X}", representativeKey, magic_enum::enum_name(type), magic_enum::enum_name(shaderClass), descriptor);
+				cache.sourceReusedShaders++;
+			} else {
+				// compile shaders
+				ID3DBlob* errorBlob = nullptr;
+				const uint32_t flags = D3DCOMPILE_OPTIMIZATION_LEVEL3;
+				HRESULT compileResult;
+				const auto compileStart = high_resolution_clock::now();
+				if (preprocessedBlob) {
+					// defines and includes are already applied to the preprocessed source
+					compileResult = D3DCompile(preprocessedBlob->GetBufferPointer(), preprocessedBlob->GetBufferSize(), pathString.c_str(), nullptr, nullptr, "main",
+						profile, flags, 0, &shaderBlob, &errorBlob);
+				} else {
+					compileResult = D3DCompileFromFile(path.c_str(), defines.data(), D3D_COMPILE_STANDARD_FILE_INCLUDE, "main",
+						profile, flags, 0, &shaderBlob, &errorBlob);
 				}
+				cache.compileCosts.Record(GetCostKey(shaderClass, type, descriptor), duration<double, std::milli>(high_resolution_clock::now() - compileStart).count());
+
+				if (FAILED(compileResult)) {
+					if (errorBlob != nullptr) {
+						logger::error("Failed to compile {} shader {}::{}: {}",
+							magic_enum::enum_name(shaderClass), magic_enum::enum_name(type), descriptor,
+							static_cast<char*>(errorBlob->GetBufferPointer()));
+						errorBlob->Release();
+					} else {
+						logger::error("Failed to compile {} shader {}::{}",
+							magic_enum::enum_name(shaderClass), magic_enum::enum_name(type), descriptor);
+					}
+					if (shaderBlob != nullptr) {
+						shaderBlob->Release();
+					}
 
-				cache.AddCompletedShader(shaderClass, shader, descriptor, nullptr);
-				return nullptr;
-			}
-			logger::debug("Compiled shader {}:{}:{:X}", magic_enum::enum_name(type), magic_enum::enum_name(shaderClass), descriptor);
+					cache.AddCompletedShader(shaderClass, shader, descriptor, nullptr);
+					return {};
+				}
+				logger::debug("Compiled shader {}:{}:{:X}", magic_enum::enum_name(type), magic_enum::enum_name(shaderClass), descriptor);
 
-			// strip debug info
-			ID3DBlob* strippedShaderBlob = nullptr;
+				// strip debug info
+				ID3DBlob* strippedShaderBlob = nullptr;
 
-			const uint32_t stripFlags = D3DCOMPILER_STRIP_DEBUG_INFO |
-			                            D3DCOMPILER_STRIP_REFLECTION_DATA |
-			                            D3DCOMPILER_STRIP_TEST_BLOBS |
-			                            D3DCOMPILER_STRIP_PRIVATE_DATA;
+				const uint32_t stripFlags = D3DCOMPILER_STRIP_DEBUG_INFO |
+				                            D3DCOMPILER_STRIP_REFLECTION_DATA |
+				                            D3DCOMPILER_STRIP_TEST_BLOBS |
+				                            D3DCOMPILER_STRIP_PRIVATE_DATA;
 
-			D3DStripShader(shaderBlob->GetBufferPointer(), shaderBlob->GetBufferSize(), stripFlags, &strippedShaderBlob);
-			std::swap(shaderBlob, strippedShaderBlob);
-			strippedShaderBlob->Release();
+				D3DStripShader(shaderBlob->GetBufferPointer(), shaderBlob->GetBufferSize(), stripFlags, &strippedShaderBlob);
+				std::swap(shaderBlob, strippedShaderBlob);
+				strippedShaderBlob->Release();
+			}
 
 			// save shader to disk
+			bool savedToDisk = false;
 			if (useDiskCache) {
 				auto directoryPath = std::format("Data/ShaderCache/{}", shader.fxpFilename);
 				if (!std::filesystem::is_directory(directoryPath)) {
@@ -1074,14 +1307,16 @@ namespace SIE
 						return (char)c;
 					});
 					logger::debug("Saved shader to {}", str);
+					savedToDisk = true;
 				}
 			}
-			cache.AddCompletedShader(shaderClass, shader, descriptor, shaderBlob);
-			return shaderBlob;
+			auto bytecode = MakeBytecode(shaderBlob);
+			cache.AddCompletedShader(shaderClass, shader, descriptor, shaderBlob, savedToDisk ? diskPath : std::wstring{});
+			return bytecode;
 		}
 
-		std::unique_ptr<RE::BSGraphics::VertexShader> CreateVertexShader(ID3DBlob& shaderData,
-			RE::BSShader::Type type, uint32_t descriptor)
+		std::unique_ptr<RE::BSGraphics::VertexShader> CreateVertexShader(const ShaderBytecode& shaderData,
+			const RE::BSShader& shader, uint32_t descriptor)
 		{
 			static const auto device = REL::Relocation<ID3D11Device**>(RE::Offset::D3D11Device);
 			static const auto perTechniqueBuffersArray =
@@ -1092,30 +1327,23 @@ namespace SIE
 				REL::Relocation<ID3D11Buffer**>(RELOCATION_ID(524759, 411375));
 			static const auto bufferData = REL::Relocation<void*>(RELOCATION_ID(524965, 411446));
 
+			// the engine expects the bytecode right after the shader, this trailer becomes its only resident copy
 			auto rawPtr =
-				new uint8_t[sizeof(RE::BSGraphics::VertexShader) + shaderData.GetBufferSize()];
+				new uint8_t[sizeof(RE::BSGraphics::VertexShader) + shaderData.size];
 			auto shaderPtr = new (rawPtr) RE::BSGraphics::VertexShader;
-			memcpy(rawPtr + sizeof(RE::BSGraphics::VertexShader), shaderData.GetBufferPointer(),
-				shaderData.GetBufferSize());
+			memcpy(rawPtr + sizeof(RE::BSGraphics::VertexShader), shaderData.data,
+				shaderData.size);
 			auto newShader = std::unique_ptr<RE::BSGraphics::VertexShader>(shaderPtr);
-			newShader->byteCodeSize = (uint32_t)shaderData.GetBufferSize();
+			newShader->byteCodeSize = (uint32_t)shaderData.size;
 			newShader->id = descriptor;
 			newShader->shaderDesc = 0;
 
-			Microsoft::WRL::ComPtr<ID3D11ShaderReflection> reflector;
-			const auto reflectionResult = D3DReflect(shaderData.GetBufferPointer(), shaderData.GetBufferSize(),
-				IID_PPV_ARGS(&reflector));
-			if (FAILED(reflectionResult)) {
-				logger::error("Failed to reflect vertex shader {}::{}", magic_enum::enum_name(type),
-					descriptor);
-			} else {
-				std::array<size_t, 3> bufferSizes = { 0, 0, 0 };
+			std::array<size_t, 3> bufferSizes = { 0, 0, 0 };
 #pragma warning(push)
 #pragma warning(disable: 4244)
-				std::fill(newShader->constantTable.begin(), newShader->constantTable.end(), 0);
+			std::fill(newShader->constantTable.begin(), newShader->constantTable.end(), 0);
 #pragma warning(pop)
-				ReflectConstantBuffers(*reflector.Get(), bufferSizes, newShader->constantTable, newShader->shaderDesc,
-					ShaderClass::Vertex, type, descriptor);
+			if (GetReflection(shaderData, shader, ShaderClass::Vertex, descriptor, bufferSizes, newShader->constantTable, newShader->shaderDesc)) {
 				if (bufferSizes[0] != 0) {
 					newShader->constantBuffers[0].buffer =
 						(RE::ID3D11Buffer*)perTechniqueBuffersArray.get()[bufferSizes[0]];
@@ -1142,8 +1370,8 @@ namespace SIE
 			return newShader;
 		}
 
-		std::unique_ptr<RE::BSGraphics::PixelShader> CreatePixelShader(ID3DBlob& shaderData,
-			RE::BSShader::Type type, uint32_t descriptor)
+		std::unique_ptr<RE::BSGraphics::PixelShader> CreatePixelShader(const ShaderBytecode& shaderData,
+			const RE::BSShader& shader, uint32_t descriptor)
 		{
 			static const auto device = REL::Relocation<ID3D11Device**>(RE::Offset::D3D11Device);
 			static const auto perTechniqueBuffersArray =
@@ -1157,22 +1385,13 @@ namespace SIE
 			auto newShader = std::make_unique<RE::BSGraphics::PixelShader>();
 			newShader->id = descriptor;
 
-			Microsoft::WRL::ComPtr<ID3D11ShaderReflection> reflector;
-			const auto reflectionResult = D3DReflect(shaderData.GetBufferPointer(),
-				shaderData.GetBufferSize(), IID_PPV_ARGS(&reflector));
-			if (FAILED(reflectionResult)) {
-				logger::error("Failed to reflect vertex shader {}::{}", magic_enum::enum_name(type),
-					descriptor);
-			} else {
-				std::array<size_t, 3> bufferSizes = { 0, 0, 0 };
+			std::array<size_t, 3> bufferSizes = { 0, 0, 0 };
 #pragma warning(push)
 #pragma warning(disable: 4244)
-				std::fill(newShader->constantTable.begin(), newShader->constantTable.end(), 0);
+			std::fill(newShader->constantTable.begin(), newShader->constantTable.end(), 0);
 #pragma warning(pop)
-				uint64_t dummy;
-				ReflectConstantBuffers(*reflector.Get(), bufferSizes, newShader->constantTable,
-					dummy,
-					ShaderClass::Pixel, type, descriptor);
+			uint64_t dummy = 0;
+			if (GetReflection(shaderData, shader, ShaderClass::Pixel, descriptor, bufferSizes, newShader->constantTable, dummy)) {
 				if (bufferSizes[0] != 0) {
 					newShader->constantBuffers[0].buffer =
 						(RE::ID3D11Buffer*)perTechniqueBuffersArray.get()[bufferSizes[0]];
@@ -1208,6 +1427,10 @@ namespace SIE
 			return nullptr;
 		}
 
+		if (isRecordingCritical) {
+			RecordCriticalShader(ShaderClass::Vertex, shader, descriptor);
+		}
+
 		auto key = SIE::SShaderCache::GetShaderString(ShaderClass::Vertex, shader, descriptor, true);
 		if (blockedKeyIndex != -1 && !blockedKey.empty() && key == blockedKey) {
 			if (std::find(blockedIDs.begin(), blockedIDs.end(), descriptor) == blockedIDs.end()) {
@@ -1243,6 +1466,10 @@ namespace SIE
 			return nullptr;
 		}
 
+		if (isRecordingCritical) {
+			RecordCriticalShader(ShaderClass::Pixel, shader, descriptor);
+		}
+
 		auto key = SIE::SShaderCache::GetShaderString(ShaderClass::Pixel, shader, descriptor, true);
 		if (blockedKeyIndex != -1 && !blockedKey.empty() && key == blockedKey) {
 			if (std::find(blockedIDs.begin(), blockedIDs.end(), descriptor) == blockedIDs.end()) {
@@ -1276,6 +1503,15 @@ namespace SIE
 
 	void ShaderCache::Clear()
 	{
+		{
+			// drop views into the vertex shader trailers before releasing the shaders
+			std::unique_lock lock{ mapMutex };
+			shaderMap.clear();
+			blobBytecodeBytes = 0;
+			vertexBytecodeBytes = 0;
+			releasedBytecodeBytes = 0;
+		}
+
 		for (auto& shaders : vertexShaders) {
 			for (auto& [id, shader] : shaders) {
 				shader->shader->Release();
@@ -1288,41 +1524,62 @@ namespace SIE
 			}
 			shaders.clear();
 		}
+		for (auto& shader : retiredVertexShaders) {
+			shader->shader->Release();
+		}
+		retiredVertexShaders.clear();
+		for (auto& shader : retiredPixelShaders) {
+			shader->shader->Release();
+		}
+		retiredPixelShaders.clear();
 
 		compilationSet.Clear();
-		std::unique_lock lock{ mapMutex };
-		shaderMap.clear();
+		sourceGroups.Clear();
+		sourceReusedShaders = 0;
+		sourceCache.Clear();
 	}
 
-	bool ShaderCache::AddCompletedShader(ShaderClass shaderClass, const RE::BSShader& shader, uint32_t descriptor, ID3DBlob* a_blob)
+	bool ShaderCache::AddCompletedShader(ShaderClass shaderClass, const RE::BSShader& shader, uint32_t descriptor, ID3DBlob* a_blob, const std::wstring& a_diskPath)
 	{
 		auto key = SIE::SShaderCache::GetShaderString(shaderClass, shader, descriptor, true);
-		auto status = a_blob ? ShaderCompilationTask::Status::Completed : ShaderCompilationTask::Status::Failed;
+		ShaderMapEntry entry;
+		entry.status = a_blob ? ShaderCompilationTask::Status::Completed : ShaderCompilationTask::Status::Failed;
+		entry.diskPath = a_diskPath;
+		if (a_blob) {
+			// the map takes over the caller's reference
+			entry.blob.attach(a_blob);
+			entry.data = a_blob->GetBufferPointer();
+			entry.size = a_blob->GetBufferSize();
+		}
 		std::unique_lock lock{ mapMutex };
-		logger::debug("Adding {} shader to map: {}", magic_enum ::enum_name(status), key);
-		shaderMap.insert_or_assign(key, std::pair(a_blob, status));
+		logger::debug("Adding {} shader to map: {}", magic_enum ::enum_name(entry.status), key);
+		if (auto it = shaderMap.find(key); it != shaderMap.end() && it->second.blob) {
+			blobBytecodeBytes -= it->second.size;
+		}
+		blobBytecodeBytes += entry.size;
+		shaderMap.insert_or_assign(key, std::move(entry));
 		return (bool)a_blob;
 	}
 
-	ID3DBlob* ShaderCache::GetCompletedShader(const std::string a_key)
+	ShaderBytecode ShaderCache::GetCompletedShader(const std::string a_key)
 	{
 		std::scoped_lock lock{ mapMutex };
-		if (!shaderMap.empty() && shaderMap.contains(a_key)) {
-			auto status = shaderMap.at(a_key).second;
-			if (status != ShaderCompilationTask::Status::Pending)
-				return shaderMap.at(a_key).first;
+		if (auto it = shaderMap.find(a_key); it != shaderMap.end()) {
+			auto& entry = it->second;
+			if (entry.status != ShaderCompilationTask::Status::Pending)
+				return { entry.blob, entry.data, entry.size };
 		}
-		return nullptr;
+		return {};
 	}
 
-	ID3DBlob* ShaderCache::GetCompletedShader(ShaderClass shaderClass, const RE::BSShader& shader,
+	ShaderBytecode ShaderCache::GetCompletedShader(ShaderClass shaderClass, const RE::BSShader& shader,
 		uint32_t descriptor)
 	{
 		auto key = SIE::SShaderCache::GetShaderString(shaderClass, shader, descriptor, true);
 		return GetCompletedShader(key);
 	}
 
-	ID3DBlob* ShaderCache::GetCompletedShader(const ShaderCompilationTask& a_task)
+	ShaderBytecode ShaderCache::GetCompletedShader(const ShaderCompilationTask& a_task)
 	{
 		auto key = a_task.GetString();
 		return GetCompletedShader(key);
@@ -1331,15 +1588,134 @@ namespace SIE
 	ShaderCompilationTask::Status ShaderCache::GetShaderStatus(const std::string a_key)
 	{
 		std::scoped_lock lock{ mapMutex };
-		if (!shaderMap.empty() && shaderMap.contains(a_key)) {
-			return shaderMap.at(a_key).second;
+		if (auto it = shaderMap.find(a_key); it != shaderMap.end()) {
+			return it->second.status;
 		}
 		return ShaderCompilationTask::Status::Pending;
 	}
 
+	std::wstring ShaderCache::GetEvictedShaderDiskPath(const std::string a_key)
+	{
+		std::scoped_lock lock{ mapMutex };
+		if (auto it = shaderMap.find(a_key); it != shaderMap.end() && it->second.status == ShaderCompilationTask::Status::Completed && !it->second.data) {
+			return it->second.diskPath;
+		}
+		return {};
+	}
+
+	void ShaderCache::AdoptVertexShaderBytecode(const std::string a_key, const RE::BSGraphics::VertexShader& a_shader)
+	{
+		std::scoped_lock lock{ mapMutex };
+		auto it = shaderMap.find(a_key);
+		if (it == shaderMap.end() || !it->second.blob)
+			return;  // already pointing at another vertex shader
+
+		auto& entry = it->second;
+		blobBytecodeBytes -= entry.size;
+		releasedBytecodeBytes += entry.size;
+		entry.blob = nullptr;
+		entry.data = reinterpret_cast<const uint8_t*>(&a_shader) + sizeof(RE::BSGraphics::VertexShader);
+		entry.size = a_shader.byteCodeSize;
+	}
+
+	void ShaderCache::EvictCompletedShader(const std::string a_key)
+	{
+		std::scoped_lock lock{ mapMutex };
+		auto it = shaderMap.find(a_key);
+		if (it == shaderMap.end() || !it->second.blob || it->second.diskPath.empty())
+			return;  // nothing to reload the bytecode from
+
+		auto& entry = it->second;
+		blobBytecodeBytes -= entry.size;
+		releasedBytecodeBytes += entry.size;
+		entry.blob = nullptr;
+		entry.data = nullptr;
+		entry.size = 0;
+	}
+
+	void ShaderCache::DiscardCompletedShader(const std::string a_key)
+	{
+		std::scoped_lock lock{ mapMutex };
+		auto it = shaderMap.find(a_key);
+		if (it == shaderMap.end())
+			return;
+		if (it->second.blob)
+			blobBytecodeBytes -= it->second.size;
+		shaderMap.erase(it);
+	}
+
+	std::string ShaderCache::GetBytecodeStatsString()
+	{
+		auto resident = blobBytecodeBytes + vertexBytecodeBytes;
+		auto& reflectionCache = SShaderCache::ReflectionCache::Instance();
+		return std::format("{:.1f} MB resident ({:.1f} MB blobs, {:.1f} MB vertex shaders), {:.1f} MB released, {:.1f} MB without sharing\nReflection: {} cached, {} reflected",
+			resident / (1024.0 * 1024.0),
+			blobBytecodeBytes / (1024.0 * 1024.0),
+			vertexBytecodeBytes / (1024.0 * 1024.0),
+			releasedBytecodeBytes / (1024.0 * 1024.0),
+			(resident + releasedBytecodeBytes) / (1024.0 * 1024.0),
+			(uint64_t)reflectionCache.hits,
+			(uint64_t)reflectionCache.misses);
+	}
+
+	std::string ShaderCache::GetSourceStatsString()
+	{
+		std::string result;
+		for (uint32_t type = 0; type < static_cast<uint32_t>(RE::BSShader::Type::Total); type++) {
+			auto stats = sourceGroups.GetStats(type);
+			if (!stats.permutations)
+				continue;
+			result += std::format("{}{} {}/{}", result.empty() ? "" : ", ", magic_enum::enum_name(static_cast<RE::BSShader::Type>(type)), stats.uniqueSources, stats.permutations);
+		}
+		return std::format("{} unique sources per permutations, {} compiles reused\nSource Files: {} cached, {} reads, {} write time checks, {} cache hits",
+			result.empty() ? "none" : result,
+			(uint64_t)sourceReusedShaders,
+			sourceCache.GetFileCount(),
+			sourceCache.GetReadCount(),
+			sourceCache.GetStatCount(),
+			sourceCache.GetHitCount());
+	}
+
+	// Identifies the compiler build, Windows updates replace d3dcompiler_47.dll without changing its name
+	static const std::string& GetCompilerVersion()
+	{
+		static const std::string version = [] {
+			auto result = std::format("{}", D3D_COMPILER_VERSION);
+			wchar_t modulePath[MAX_PATH];
+			if (auto module = GetModuleHandleW(D3DCOMPILER_DLL_W); module && GetModuleFileNameW(module, modulePath, MAX_PATH)) {
+				std::error_code ec;
+				auto size = std::filesystem::file_size(modulePath, ec);
+				auto writeTime = std::filesystem::last_write_time(modulePath, ec);
+				result += std::format(":{}:{}", size, writeTime.time_since_epoch().count());
+			}
+			return result;
+		}();
+		return version;
+	}
+
+	std::wstring ShaderCache::GetUtilityShaderDiskPath(const std::wstring& a_path, const D3D_SHADER_MACRO* a_defines, const char* a_profile, const char* a_program, uint32_t a_flags)
+	{
+		if (!isDiskCache)
+			return {};
+
+		// the preprocessed source covers the defines and every include, so edited shaders get a new entry
+		auto preprocessedBlob = SShaderCache::PreprocessShader(a_path, a_defines);
+		if (!preprocessedBlob)
+			return {};
+		auto digest = ShaderSourceGroups::HashSource(std::format("{}:{}:{:X}:{}", a_profile, a_program, a_flags, GetCompilerVersion()),
+			{ static_cast<const char*>(preprocessedBlob->GetBufferPointer()), preprocessedBlob->GetBufferSize() });
+		auto name = Sha256::ToString(digest);
+		return std::format(L"Data/ShaderCache/Utility/{}/{}.cso", std::filesystem::path(a_path).stem().wstring(), std::wstring(name.begin(), name.end()));
+	}
+
 	std::string ShaderCache::GetShaderStatsString(bool a_timeOnly)
 	{
-		return compilationSet.GetStatsString(a_timeOnly);
+		if (a_timeOnly)
+			return compilationSet.GetStatsString(a_timeOnly);
+		return std::format("{}\nUtility Shaders: {} cache hits, {} compiled",
+			compilationSet.GetStatsString(a_timeOnly),
+			(uint64_t)utilityCacheHits,
+			(uint64_t)utilityCacheMisses);
 	}
 
 	bool ShaderCache::IsCompiling()
@@ -1347,6 +1723,14 @@ namespace SIE
 		return compilationSet.totalTasks && compilationSet.completedTasks + compilationSet.failedTasks < compilationSet.totalTasks;
 	}
 
+	bool ShaderCache::IsCompilingCritical()
+	{
+		// without a manifest from a previous session there is nothing to prioritise, so wait on everything
+		if (!compilationSet.HasCriticalTasks())
+			return IsCompiling();
+		return compilationSet.criticalProcessedTasks < compilationSet.criticalTotalTasks;
+	}
+
 	bool ShaderCache::IsEnabled() const
 	{
 		return isEnabled;
@@ -1377,6 +1761,117 @@ namespace SIE
 		isDump = value;
 	}
 
+	bool ShaderCache::IsHotReload() const
+	{
+		return isHotReload;
+	}
+
+	void ShaderCache::SetHotReload(bool value)
+	{
+		isHotReload = value;
+		if (isHotReload && !hotReloadThread.joinable()) {
+			hotReloadThread = std::jthread([this](std::stop_token stoken) { WatchShaderFiles(stoken); });
+		} else if (!isHotReload && hotReloadThread.joinable()) {
+			// the watcher may be in the middle of scanning the shader folders, join it without blocking the UI
+			hotReloadThread.request_stop();
+			std::thread([watcher = std::move(hotReloadThread)]() mutable { watcher.join(); }).detach();
+		}
+	}
+
+	void ShaderCache::AddLoadedShader(const RE::BSShader& shader)
+	{
+		loadedShaders[static_cast<size_t>(shader.shaderType.get())] = &shader;
+	}
+
+	void ShaderCache::WatchShaderFiles(std::stop_token stoken)
+	{
+		SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_LOWEST);
+		ShaderDependencyGraph graph{ "Data/Shaders" };
+		graph.Build();
+		watchedFiles = graph.GetFileCount();
+		logger::info("Watching {} shader files for changes", graph.GetFileCount());
+
+		std::mutex mutex;
+		std::condition_variable_any wakeup;
+		std::unique_lock lock{ mutex };
+		while (!stoken.stop_requested()) {
+			wakeup.wait_for(lock, stoken, 1s, [] { return false; });
+			if (stoken.stop_requested())
+				break;
+
+			auto changed = graph.Refresh();
+			watchedFiles = graph.GetFileCount();
+			if (changed.empty())
+				continue;
+			for (auto& file : changed) {
+				logger::info("Shader file changed: {}", file);
+			}
+			hotReloadedFiles += changed.size();
+			// the source cache only checks write times here, compiles read it without touching the disk
+			sourceCache.Refresh();
+			ReloadShaders(graph.GetAffectedShaders(changed));
+		}
+	}
+
+	void ShaderCache::ReloadShaders(const std::unordered_set<std::string>& a_names)
+	{
+		for (auto* shader : loadedShaders) {
+			if (!shader)
+				continue;
+			std::string name = shader->fxpFilename;
+			std::transform(name.begin(), name.end(), name.begin(), [](char c) { return (char)std::tolower((unsigned char)c); });
+			if (!a_names.contains(name))
+				continue;
+
+			const auto type = static_cast<size_t>(shader->shaderType.get());
+			std::vector<ShaderCompilationTask> tasks;
+			{
+				std::lock_guard lockGuard(vertexShadersMutex);
+				for (auto& [descriptor, vertexShader] : vertexShaders[type]) {
+					tasks.push_back({ ShaderClass::Vertex, *shader, descriptor });
+				}
+			}
+			{
+				std::lock_guard lockGuard(pixelShadersMutex);
+				for (auto& [descriptor, pixelShader] : pixelShaders[type]) {
+					tasks.push_back({ ShaderClass::Pixel, *shader, descriptor });
+				}
+			}
+
+			// forget every compiled permutation of this file so it is neither reused from memory nor from disk
+			auto prefix = std::format("{}:", shader->fxpFilename);
+			{
+				std::scoped_lock lock{ mapMutex };
+				std::erase_if(shaderMap, [&](const auto& item) {
+					if (!item.first.starts_with(prefix))
+						return false;
+					if (item.second.blob)
+						blobBytecodeBytes -= item.second.size;
+					return true;
+				});
+			}
+			sourceGroups.Remove(prefix);
+			std::error_code ec;
+			std::filesystem::remove_all(std::format("Data/ShaderCache/{}", shader->fxpFilename), ec);
+
+			logger::info("Hot reloading {} {} shaders", tasks.size(), shader->fxpFilename);
+			hotReloadedShaders += tasks.size();
+			for (auto& task : tasks) {
+				// the current shaders keep rendering until their replacement is swapped in
+				compilationSet.Invalidate(task);
+				compilationSet.Add(task);
+			}
+		}
+	}
+
+	std::string ShaderCache::GetHotReloadStatsString()
+	{
+		return std::format("watching {} files, {} changed, {} shaders recompiled",
+			(size_t)watchedFiles,
+			(uint64_t)hotReloadedFiles,
+			(uint64_t)hotReloadedShaders);
+	}
+
 	bool ShaderCache::IsDiskCache() const
 	{
 		return isDiskCache;
@@ -1417,6 +1912,8 @@ namespace SIE
 
 		if (valid) {
 			logger::info("Using disk cache");
+			LoadCriticalManifest();
+			LoadCompileCosts();
 		} else {
 			DeleteDiskCache();
 		}
@@ -1432,9 +1929,185 @@ namespace SIE
 		logger::info("Saved disk cache info");
 	}
 
+	void ShaderCache::MarkStage(StartupStage a_stage)
+	{
+		bool reached = false;
+		{
+			std::scoped_lock lock{ stageMutex };
+			auto& time = stageTimes[static_cast<size_t>(a_stage)];
+			if (!time.has_value()) {
+				time = high_resolution_clock::now();
+				reached = true;
+				logger::debug("Reached startup stage {}", magic_enum::enum_name(a_stage));
+			}
+		}
+		if (a_stage != StartupStage::BacklogReady)
+			return;
+		if (backlogInBackground.exchange(false)) {
+			backgroundCompilation = false;
+		}
+		// the info marks the disk cache as complete, so it is only written once every startup shader is in it
+		if (reached && IsDiskCache()) {
+			WriteDiskCacheInfo();
+		}
+	}
+
+	void ShaderCache::CompileBacklogInBackground()
+	{
+		// only restored once the backlog is done if it was not already chosen by the user
+		if (!backgroundCompilation) {
+			backlogInBackground = true;
+			backgroundCompilation = true;
+		}
+	}
+
+	std::string ShaderCache::GetStageStatsString()
+	{
+		std::scoped_lock lock{ stageMutex };
+		auto now = high_resolution_clock::now();
+		auto getStageMs = [&](StartupStage a_begin, StartupStage a_end) {
+			auto& begin = stageTimes[static_cast<size_t>(a_begin)];
+			auto& end = stageTimes[static_cast<size_t>(a_end)];
+			if (!begin.has_value())
+				return 0.0;
+			return (double)duration_cast<milliseconds>(end.value_or(now) - begin.value()).count();
+		};
+		auto isDone = [&](StartupStage a_stage) { return stageTimes[static_cast<size_t>(a_stage)].has_value(); };
+
+		return fmt::format("Startup: {}{}\tCritical ({}/{}): {}{}\tBackground: {}{}",
+			compilationSet.GetHumanTime(getStageMs(StartupStage::Startup, StartupStage::DataLoaded)),
+			isDone(StartupStage::DataLoaded) ? "" : "...",
+			(std::uint64_t)compilationSet.criticalProcessedTasks,
+			(std::uint64_t)compilationSet.criticalTotalTasks,
+			compilationSet.GetHumanTime(getStageMs(StartupStage::DataLoaded, StartupStage::CriticalReady)),
+			isDone(StartupStage::CriticalReady) ? "" : "...",
+			compilationSet.GetHumanTime(getStageMs(StartupStage::CriticalReady, StartupStage::BacklogReady)),
+			isDone(StartupStage::BacklogReady) ? "" : "...");
+	}
+
+	void ShaderCache::LoadCriticalManifest()
+	{
+		CSimpleIniA ini;
+		ini.SetUnicode();
+		if (ini.LoadFile(L"Data\\ShaderCache\\Critical.ini") < 0) {
+			logger::info("No critical shader manifest, waiting on the full compile backlog");
+			return;
+		}
+
+		std::unordered_set<size_t> ids;
+		CSimpleIniA::TNamesDepend keys;
+		ini.GetAllKeys("Critical", keys);
+		for (auto& key : keys) {
+			ids.insert(std::strtoull(key.pItem, nullptr, 16));
+		}
+		logger::info("Loaded critical shader manifest with {} shaders", ids.size());
+		compilationSet.SetCriticalTasks(std::move(ids));
+	}
+
+	void ShaderCache::WriteCriticalManifest()
+	{
+		CSimpleIniA ini;
+		ini.SetUnicode();
+		{
+			std::scoped_lock lock{ criticalMutex };
+			if (recordedCriticalShaders.empty())
+				return;
+			for (auto& [id, key] : recordedCriticalShaders) {
+				ini.SetValue("Critical", std::format("{:X}", id).c_str(), key.c_str());
+			}
+		}
+		std::error_code ec;
+		std::filesystem::create_directories("Data\\ShaderCache", ec);
+		if (ini.SaveFile(L"Data\\ShaderCache\\Critical.ini") < 0) {
+			logger::warn("Failed to save critical shader manifest");
+			return;
+		}
+		logger::info("Saved critical shader manifest");
+	}
+
+	void ShaderCache::LoadCompileCosts()
+	{
+		CSimpleIniA ini;
+		ini.SetUnicode();
+		if (ini.LoadFile(L"Data\\ShaderCache\\CompileCosts.ini") < 0)
+			return;
+
+		CSimpleIniA::TNamesDepend keys;
+		ini.GetAllKeys("Costs", keys);
+		for (auto& key : keys) {
+			// "count,meanMs"
+			std::string_view value = ini.GetValue("Costs", key.pItem, "");
+			auto separator = value.find(',');
+			if (separator == std::string_view::npos)
+				continue;
+			CompileCostModel::Entry entry;
+			auto countResult = std::from_chars(value.data(), value.data() + separator, entry.count);
+			auto meanResult = std::from_chars(value.data() + separator + 1, value.data() + value.size(), entry.meanMs);
+			if (countResult.ec == std::errc() && meanResult.ec == std::errc())
+				compileCosts.SetEntry(std::strtoull(key.pItem, nullptr, 16), entry);
+		}
+		logger::info("Loaded compile costs for {} shader groups", keys.size());
+	}
+
+	void ShaderCache::WriteCompileCosts()
+	{
+		std::scoped_lock lock{ compileCostsMutex };
+		auto samples = compileCosts.GetRecordedSamples();
+		if (samples <= writtenCostSamples)
+			return;
+		auto entries = compileCosts.GetEntries();
+
+		CSimpleIniA ini;
+		ini.SetUnicode();
+		for (auto& [key, entry] : entries) {
+			ini.SetValue("Costs", std::format("{:X}", key).c_str(), std::format("{},{:.2f}", entry.count, entry.meanMs).c_str());
+		}
+		std::error_code ec;
+		std::filesystem::create_directories("Data\\ShaderCache", ec);
+		if (ini.SaveFile(L"Data\\ShaderCache\\CompileCosts.ini") < 0) {
+			logger::warn("Failed to save compile costs");
+			return;
+		}
+		writtenCostSamples = samples;
+		logger::info("Saved compile costs for {} shader groups", entries.size());
+	}
+
+	void ShaderCache::StartCriticalRecording()
+	{
+		isRecordingCritical = true;
+	}
+
+	void ShaderCache::StopCriticalRecording()
+	{
+		// keep recording for a few more frames so the shaders of the loaded cell are included
+		criticalRecordingStopFrame = RE::BSGraphics::State::GetSingleton()->uiFrameCount + CRITICAL_RECORDING_FRAMES;
+	}
+
+	void ShaderCache::UpdateCriticalRecording()
+	{
+		if (!isRecordingCritical || !criticalRecordingStopFrame || RE::BSGraphics::State::GetSingleton()->uiFrameCount <= criticalRecordingStopFrame)
+			return;
+		if (isRecordingCritical.exchange(false)) {
+			WriteCriticalManifest();
+		}
+	}
+
+	void ShaderCache::RecordCriticalShader(ShaderClass shaderClass, const RE::BSShader& shader, uint32_t descriptor)
+	{
+		if (criticalRecordingStopFrame && RE::BSGraphics::State::GetSingleton()->uiFrameCount > criticalRecordingStopFrame)
+			return;
+
+		ShaderCompilationTask task{ shaderClass, shader, descriptor };
+		std::scoped_lock lock{ criticalMutex };
+		if (!recordedCriticalShaders.contains(task.GetId())) {
+			recordedCriticalShaders.emplace(task.GetId(), task.GetString());
+		}
+	}
+
 	ShaderCache::ShaderCache()
 	{
 		logger::debug("ShaderCache initialized with {} compiler threads", (int)compilationThreadCount);
+		MarkStage(StartupStage::Startup);
 		compilationPool.push_task(&ShaderCache::ManageCompilationSet, this, ssource.get_token());
 	}
 
@@ -1445,12 +2118,11 @@ namespace SIE
 				SShaderCache::CompileShader(ShaderClass::Vertex, shader, descriptor, isDiskCache)) {
 			static const auto device = REL::Relocation<ID3D11Device**>(RE::Offset::D3D11Device);
 
-			auto newShader = SShaderCache::CreateVertexShader(*shaderBlob, shader.shaderType.get(),
-				descriptor);
+			auto newShader = SShaderCache::CreateVertexShader(shaderBlob, shader, descriptor);
 
 			std::lock_guard lockGuard(vertexShadersMutex);
 
-			const auto result = (*device)->CreateVertexShader(shaderBlob->GetBufferPointer(),
+			const auto result = (*device)->CreateVertexShader(shaderBlob.data,
 				newShader->byteCodeSize, nullptr, &newShader->shader);
 			if (FAILED(result)) {
 				logger::error("Failed to create vertex shader {}::{}",
@@ -1459,9 +2131,14 @@ namespace SIE
 					newShader->shader->Release();
 				}
 			} else {
-				return vertexShaders[static_cast<size_t>(shader.shaderType.get())]
-				    .insert_or_assign(descriptor, std::move(newShader))
-				    .first->second.get();
+				vertexBytecodeBytes += newShader->byteCodeSize;
+				auto& typeCache = vertexShaders[static_cast<size_t>(shader.shaderType.get())];
+				if (auto it = typeCache.find(descriptor); it != typeCache.end()) {
+					retiredVertexShaders.push_back(std::move(it->second));
+				}
+				auto vertexShader = typeCache.insert_or_assign(descriptor, std::move(newShader)).first->second.get();
+				AdoptVertexShaderBytecode(SShaderCache::GetShaderString(ShaderClass::Vertex, shader, descriptor, true), *vertexShader);
+				return vertexShader;
 			}
 		}
 		return nullptr;
@@ -1474,12 +2151,11 @@ namespace SIE
 				SShaderCache::CompileShader(ShaderClass::Pixel, shader, descriptor, isDiskCache)) {
 			static const auto device = REL::Relocation<ID3D11Device**>(RE::Offset::D3D11Device);
 
-			auto newShader = SShaderCache::CreatePixelShader(*shaderBlob, shader.shaderType.get(),
-				descriptor);
+			auto newShader = SShaderCache::CreatePixelShader(shaderBlob, shader, descriptor);
 
 			std::lock_guard lockGuard(pixelShadersMutex);
-			const auto result = (*device)->CreatePixelShader(shaderBlob->GetBufferPointer(),
-				shaderBlob->GetBufferSize(), nullptr, &newShader->shader);
+			const auto result = (*device)->CreatePixelShader(shaderBlob.data,
+				shaderBlob.size, nullptr, &newShader->shader);
 			if (FAILED(result)) {
 				logger::error("Failed to create pixel shader {}::{}",
 					magic_enum::enum_name(shader.shaderType.get()),
@@ -1488,9 +2164,13 @@ namespace SIE
 					newShader->shader->Release();
 				}
 			} else {
-				return pixelShaders[static_cast<size_t>(shader.shaderType.get())]
-				    .insert_or_assign(descriptor, std::move(newShader))
-				    .first->second.get();
+				// the device has its own copy now and the disk cache can serve the bytecode again if needed
+				EvictCompletedShader(SShaderCache::GetShaderString(ShaderClass::Pixel, shader, descriptor, true));
+				auto& typeCache = pixelShaders[static_cast<size_t>(shader.shaderType.get())];
+				if (auto it = typeCache.find(descriptor); it != typeCache.end()) {
+					retiredPixelShaders.push_back(std::move(it->second));
+				}
+				return typeCache.insert_or_assign(descriptor, std::move(newShader)).first->second.get();
 			}
 		}
 		return nullptr;
@@ -1595,6 +2275,18 @@ namespace SIE
 		       (static_cast<size_t>(shaderClass) << 60);
 	}
 
+	void ShaderCompilationTask::Discard() const
+	{
+		ShaderCache::Instance().DiscardCompletedShader(GetString());
+		std::error_code ec;
+		std::filesystem::remove(SShaderCache::GetDiskPath(shader.fxpFilename, descriptor, shaderClass), ec);
+	}
+
+	uint64_t ShaderCompilationTask::GetCostKey() const
+	{
+		return SIE::SShaderCache::GetCostKey(shaderClass, shader.shaderType.get(), descriptor);
+	}
+
 	std::string ShaderCompilationTask::GetString() const
 	{
 		return SIE::SShaderCache::GetShaderString(shaderClass, shader, descriptor, true);
@@ -1611,7 +2303,7 @@ namespace SIE
 		auto& shaderCache = ShaderCache::Instance();
 		if (!conditionVariable.wait(
 				lock, stoken,
-				[this, &shaderCache]() { return !availableTasks.empty() &&
+				[this, &shaderCache]() { return (!availableCriticalTasks.empty() || !availableTasks.empty()) &&
 			                                    // check against all tasks in queue to trickle the work. It cannot be the active tasks count because the thread pool itself is maximum.
 			                                    (int)shaderCache.compilationPool.get_tasks_total() <=
 			                                        (!shaderCache.backgroundCompilation ? shaderCache.compilationThreadCount : shaderCache.backgroundCompilationThreadCount); })) {
@@ -1621,63 +2313,123 @@ namespace SIE
 		if (!ShaderCache::Instance().IsCompiling()) {  // we just got woken up because there's a task, start clock
 			lastCalculation = lastReset = high_resolution_clock::now();
 		}
-		auto node = availableTasks.extract(availableTasks.begin());
-		auto& task = node.value();
-		tasksInProgress.insert(std::move(node));
+		auto& queue = !availableCriticalTasks.empty() ? availableCriticalTasks : availableTasks;
+		// longest predicted compile first, so the expensive permutations do not end up alone at the tail
+		auto task = std::move(queue.extract(queue.begin()).mapped());
+		taskStates.Set(task.GetId(), TaskStateTable::State::InProgress);
 		return task;
 	}
 
 	void CompilationSet::Add(const ShaderCompilationTask& task)
 	{
-		std::unique_lock lock(compilationMutex);
-		auto inProgressIt = tasksInProgress.find(task);
-		auto processedIt = processedTasks.find(task);
-		if (inProgressIt == tasksInProgress.end() && processedIt == processedTasks.end() && !ShaderCache::Instance().GetCompletedShader(task)) {
-			auto [availableIt, wasAdded] = availableTasks.insert(task);
-			lock.unlock();
-			if (wasAdded) {
-				conditionVariable.notify_one();
-				totalTasks++;
-			}
+		// tasks seen before, the common case on the draw thread, are rejected by a single shard probe
+		const auto id = task.GetId();
+		if (!taskStates.TryAdd(id))
+			return;
+
+		if (ShaderCache::Instance().GetShaderStatus(task.GetString()) == ShaderCompilationTask::Status::Completed) {
+			taskStates.Set(id, TaskStateTable::State::Completed);
+			return;
 		}
+
+		const auto cost = ShaderCache::Instance().compileCosts.Predict(task.GetCostKey());
+		std::unique_lock lock(compilationMutex);
+		bool isCritical = criticalIds.contains(id);
+		(isCritical ? availableCriticalTasks : availableTasks).emplace(cost, task);
+		predictedCosts.insert_or_assign(id, cost);
+		remainingCostMs += cost;
+		lock.unlock();
+		conditionVariable.notify_one();
+		totalTasks++;
+		if (isCritical)
+			criticalTotalTasks++;
 	}
 
 	void CompilationSet::Complete(const ShaderCompilationTask& task)
 	{
 		auto& cache = ShaderCache::Instance();
 		auto key = task.GetString();
-		auto shaderBlob = cache.GetCompletedShader(task);
-		if (shaderBlob) {
+		const auto id = task.GetId();
+		bool isCurrent;
+		if (cache.GetShaderStatus(key) == ShaderCompilationTask::Status::Completed) {
 			logger::debug("Compiling Task succeeded: {}", key);
+			isCurrent = taskStates.Finish(id, TaskStateTable::State::Completed);
 			completedTasks++;
 		} else {
 			logger::debug("Compiling Task failed: {}", key);
+			isCurrent = taskStates.Finish(id, TaskStateTable::State::Failed);
 			failedTasks++;
 		}
 		auto now = high_resolution_clock::now();
 		totalMs += duration_cast<milliseconds>(now - lastCalculation).count();
 		lastCalculation = now;
-		std::scoped_lock lock(compilationMutex);
-		processedTasks.insert(task);
-		tasksInProgress.erase(task);
-		conditionVariable.notify_one();
+		bool backlogDone = false;
+		{
+			std::scoped_lock lock(compilationMutex);
+			if (auto it = predictedCosts.find(id); it != predictedCosts.end()) {
+				remainingCostMs -= it->second;
+				processedCostMs += it->second;
+				predictedCosts.erase(it);
+			}
+			if (criticalIds.contains(id))
+				criticalProcessedTasks++;
+			backlogDone = completedTasks + failedTasks >= totalTasks;
+			conditionVariable.notify_one();
+		}
+		if (backlogDone) {
+			// files are written outside of the lock the other workers take for every task
+			if (cache.menuLoaded)
+				cache.MarkStage(ShaderCache::StartupStage::BacklogReady);
+			// rewritten only when compiles were recorded since the last save
+			if (cache.IsDiskCache())
+				cache.WriteCompileCosts();
+		}
+
+		if (!isCurrent) {
+			// a source file changed while this was compiling, the result is outdated
+			logger::debug("Recompiling {} after its sources changed", key);
+			task.Discard();
+			Add(task);
+		}
 	}
 
 	void CompilationSet::Clear()
 	{
 		std::scoped_lock lock(compilationMutex);
+		availableCriticalTasks.clear();
 		availableTasks.clear();
-		tasksInProgress.clear();
-		processedTasks.clear();
+		taskStates.Clear();
+		predictedCosts.clear();
+		remainingCostMs = 0;
+		processedCostMs = 0;
 		totalTasks = 0;
 		completedTasks = 0;
 		failedTasks = 0;
 		cacheHitTasks = 0;
+		criticalTotalTasks = 0;
+		criticalProcessedTasks = 0;
 		lastReset = high_resolution_clock::now();
 		lastCalculation = high_resolution_clock::now();
 		totalMs = (double)duration_cast<std::chrono::milliseconds>(lastReset - lastReset).count();
 	}
 
+	void CompilationSet::Invalidate(const ShaderCompilationTask& task)
+	{
+		taskStates.Invalidate(task.GetId());
+	}
+
+	void CompilationSet::SetCriticalTasks(std::unordered_set<size_t> a_ids)
+	{
+		std::scoped_lock lock(compilationMutex);
+		criticalIds = std::move(a_ids);
+	}
+
+	bool CompilationSet::HasCriticalTasks()
+	{
+		std::scoped_lock lock(compilationMutex);
+		return !criticalIds.empty();
+	}
+
 	std::string CompilationSet::GetHumanTime(double a_totalms)
 	{
 		int milliseconds = (int)a_totalms;
@@ -1693,9 +2445,22 @@ namespace SIE
 
 	double CompilationSet::GetEta()
 	{
-		auto rate = completedTasks / totalMs;
-		auto remaining = totalTasks - completedTasks - failedTasks;
-		return std::max(remaining / rate, 0.0);
+		auto& cache = ShaderCache::Instance();
+		auto processed = completedTasks + failedTasks;
+		if (cache.compileCosts.IsEmpty() || !processed) {
+			// nothing learned yet, assume the remaining tasks take as long as the finished ones
+			auto rate = completedTasks / totalMs;
+			auto remaining = totalTasks - processed;
+			return std::max(remaining / rate, 0.0);
+		}
+
+		std::scoped_lock lock(compilationMutex);
+		auto threads = (double)std::max(!cache.backgroundCompilation ? cache.compilationThreadCount : cache.backgroundCompilationThreadCount, 1);
+		auto eta = remainingCostMs / threads;
+		// disk cache hits and thread contention make the elapsed time differ from the predictions, scale by what was observed so far
+		if (processed >= ETA_CALIBRATION_TASKS && processedCostMs > 0.0 && totalMs > 0.0)
+			eta *= std::clamp(totalMs / (processedCostMs / threads), 0.05, 20.0);
+		return std::max(eta, 0.0);
 	}
 
 	std::string CompilationSet::GetStatsString(bool a_timeOnly)
@@ -3,6 +3,10 @@
 #include <RE/B/BSShader.h>
 
 #include "BS_thread_pool.hpp"
+#include "CompileCostModel.h"
+#include "ShaderSourceCache.h"
+#include "ShaderSourceGroups.h"
+#include "TaskStateTable.h"
 #include <chrono>
 #include <condition_variable>
 #include <unordered_map>
@@ -36,6 +40,8 @@ namespace SIE
 		void Perform() const;
 
 		size_t GetId() const;
+		uint64_t GetCostKey() const;
+		void Discard() const;  // forgets the compiled result in memory and on disk so the next compile starts from source
 		std::string GetString() const;
 
 		bool operator==(const ShaderCompilationTask& other) const;
@@ -65,6 +71,9 @@ namespace SIE
 		void Add(const ShaderCompilationTask& task);
 		void Complete(const ShaderCompilationTask& task);
 		void Clear();
+		void Invalidate(const ShaderCompilationTask& task);
+		void SetCriticalTasks(std::unordered_set<size_t> a_ids);
+		bool HasCriticalTasks();
 		std::string GetHumanTime(double a_totalms);
 		double GetEta();
 		std::string GetStatsString(bool a_timeOnly = false);
@@ -72,18 +81,38 @@ namespace SIE
 		std::atomic<uint64_t> totalTasks = 0;
 		std::atomic<uint64_t> failedTasks = 0;
 		std::atomic<uint64_t> cacheHitTasks = 0;  // number of compiles of a previously seen shader combo
+		std::atomic<uint64_t> criticalTotalTasks = 0;
+		std::atomic<uint64_t> criticalProcessedTasks = 0;
 		std::mutex compilationMutex;
 
 	private:
-		std::unordered_set<ShaderCompilationTask> availableTasks;
-		std::unordered_set<ShaderCompilationTask> tasksInProgress;
-		std::unordered_set<ShaderCompilationTask> processedTasks;  // completed or failed
+		static constexpr uint64_t ETA_CALIBRATION_TASKS = 32;
+
+		// keyed by predicted compile time, longest first
+		std::multimap<double, ShaderCompilationTask, std::greater<double>> availableCriticalTasks;  // taken before availableTasks
+		std::multimap<double, ShaderCompilationTask, std::greater<double>> availableTasks;
+		std::unordered_map<size_t, double> predictedCosts;  // of the queued and in progress tasks
+		double remainingCostMs = 0.0;
+		double processedCostMs = 0.0;
+		TaskStateTable taskStates;  // queued, in progress, completed or failed, by task id
+		std::unordered_set<size_t> criticalIds;                    // task ids from the critical manifest
 		std::condition_variable_any conditionVariable;
 		std::chrono::steady_clock::time_point lastReset = high_resolution_clock::now();
 		std::chrono::steady_clock::time_point lastCalculation = high_resolution_clock::now();
 		double totalMs = (double)duration_cast<std::chrono::milliseconds>(lastReset - lastReset).count();
 	};
 
+	// View of a completed shader's bytecode. The blob reference keeps compiler output alive while it is used,
+	// vertex shader bytecode is instead owned by the trailer of the BSGraphics::VertexShader created from it.
+	struct ShaderBytecode
+	{
+		winrt::com_ptr<ID3DBlob> blob;
+		const void* data = nullptr;
+		size_t size = 0;
+
+		explicit operator bool() const { return data != nullptr; }
+	};
+
 	class ShaderCache
 	{
 	public:
@@ -115,12 +144,18 @@ namespace SIE
 		}
 
 		bool IsCompiling();
+		bool IsCompilingCritical();
 		bool IsEnabled() const;
 		void SetEnabled(bool value);
 		bool IsAsync() const;
 		void SetAsync(bool value);
 		bool IsDump() const;
 		void SetDump(bool value);
+		bool IsHotReload() const;
+		void SetHotReload(bool value);
+		void AddLoadedShader(const RE::BSShader& shader);
+		void ReloadShaders(const std::unordered_set<std::string>& a_names);
+		std::string GetHotReloadStatsString();
 
 		bool IsDiskCache() const;
 		void SetDiskCache(bool value);
@@ -129,12 +164,55 @@ namespace SIE
 		void WriteDiskCacheInfo();
 		void Clear();
 
-		bool AddCompletedShader(ShaderClass shaderClass, const RE::BSShader& shader, uint32_t descriptor, ID3DBlob* a_blob);
-		ID3DBlob* GetCompletedShader(const std::string a_key);
-		ID3DBlob* GetCompletedShader(const SIE::ShaderCompilationTask& a_task);
-		ID3DBlob* GetCompletedShader(ShaderClass shaderClass, const RE::BSShader& shader, uint32_t descriptor);
+		enum class StartupStage
+		{
+			Startup,
+			DataLoaded,
+			CriticalReady,
+			BacklogReady,
+			Total
+		};
+
+		// Records when a stage is first reached, first reaching BacklogReady writes the disk cache info
+		void MarkStage(StartupStage a_stage);
+		std::string GetStageStatsString();
+		void CompileBacklogInBackground();
+
+		void LoadCriticalManifest();
+		void WriteCriticalManifest();
+		void StartCriticalRecording();
+		void StopCriticalRecording();
+		void UpdateCriticalRecording();
+		void RecordCriticalShader(ShaderClass shaderClass, const RE::BSShader& shader, uint32_t descriptor);
+
+		void LoadCompileCosts();
+		// Saves the costs if compiles were recorded since the last save, at the end of every backlog and on exit
+		void WriteCompileCosts();
+
+		bool AddCompletedShader(ShaderClass shaderClass, const RE::BSShader& shader, uint32_t descriptor, ID3DBlob* a_blob, const std::wstring& a_diskPath = {});
+		ShaderBytecode GetCompletedShader(const std::string a_key);
+		ShaderBytecode GetCompletedShader(const SIE::ShaderCompilationTask& a_task);
+		ShaderBytecode GetCompletedShader(ShaderClass shaderClass, const RE::BSShader& shader, uint32_t descriptor);
 		ShaderCompilationTask::Status GetShaderStatus(const std::string a_key);
+		std::wstring GetEvictedShaderDiskPath(const std::string a_key);
+		void AdoptVertexShaderBytecode(const std::string a_key, const RE::BSGraphics::VertexShader& a_shader);
+		void EvictCompletedShader(const std::string a_key);
+		void DiscardCompletedShader(const std::string a_key);
 		std::string GetShaderStatsString(bool a_timeOnly = false);
+		std::string GetBytecodeStatsString();
+		std::string GetSourceStatsString();
+		std::wstring GetUtilityShaderDiskPath(const std::wstring& a_path, const D3D_SHADER_MACRO* a_defines, const char* a_profile, const char* a_program, uint32_t a_flags);
+
+		std::atomic<uint64_t> blobBytecodeBytes = 0;    // held by compiler blobs in the shader map
+		std::atomic<uint64_t> vertexBytecodeBytes = 0;  // held by vertex shader trailers
+		std::atomic<uint64_t> releasedBytecodeBytes = 0;
+
+		CompileCostModel compileCosts;    // learned per shader group, persisted with the disk cache
+		ShaderSourceGroups sourceGroups;  // permutations with identical preprocessed source
+		std::atomic<uint64_t> sourceReusedShaders = 0;
+		ShaderSourceCache sourceCache;  // sources and includes read once for every compilation thread
+		std::atomic<uint64_t> utilityCacheHits = 0;  // Util::CompileShader bytecode loaded from the disk cache
+		std::atomic<uint64_t> utilityCacheMisses = 0;
 
 		RE::BSGraphics::VertexShader* GetVertexShader(const RE::BSShader& shader, uint32_t descriptor);
 		RE::BSGraphics::PixelShader* GetPixelShader(const RE::BSShader& shader,
@@ -269,6 +347,7 @@ namespace SIE
 	private:
 		ShaderCache();
 		void ManageCompilationSet(std::stop_token stoken);
+		void WatchShaderFiles(std::stop_token stoken);
 		void ProcessCompilationSet(std::stop_token stoken, SIE::ShaderCompilationTask task);
 
 		~ShaderCache();
@@ -284,13 +363,46 @@ namespace SIE
 		bool isDiskCache = false;
 		bool isAsync = true;
 		bool isDump = false;
+		bool isHotReload = false;
 		bool hideError = false;
 
 		std::stop_source ssource;
 		std::mutex vertexShadersMutex;
 		std::mutex pixelShadersMutex;
 		CompilationSet compilationSet;
-		std::unordered_map<std::string, std::pair<ID3DBlob*, ShaderCompilationTask::Status>> shaderMap{};
+		struct ShaderMapEntry
+		{
+			winrt::com_ptr<ID3DBlob> blob;
+			const void* data = nullptr;  // blob contents or a vertex shader trailer, null once evicted
+			size_t size = 0;
+			ShaderCompilationTask::Status status = ShaderCompilationTask::Status::Pending;
+			std::wstring diskPath;  // where evicted bytecode can be reloaded from
+		};
+
+		std::unordered_map<std::string, ShaderMapEntry> shaderMap{};
 		std::mutex mapMutex;
+
+		// shaders requested between DataLoaded and the first loaded game, waited on at the next startup
+		static constexpr uint32_t CRITICAL_RECORDING_FRAMES = 300;
+		std::atomic<bool> isRecordingCritical = false;
+		std::atomic<uint32_t> criticalRecordingStopFrame = 0;
+		std::unordered_map<size_t, std::string> recordedCriticalShaders;
+		std::mutex criticalMutex;
+
+		std::array<std::optional<std::chrono::steady_clock::time_point>, static_cast<size_t>(StartupStage::Total)> stageTimes{};
+		std::mutex stageMutex;
+		std::atomic<bool> backlogInBackground = false;  // backgroundCompilation was only enabled for the startup backlog
+
+		uint64_t writtenCostSamples = 0;  // recorded samples of the model when CompileCosts.ini was last saved
+		std::mutex compileCostsMutex;
+
+		// shaders replaced by a hot reload, the engine may still reference them until the next Clear
+		std::vector<std::unique_ptr<RE::BSGraphics::VertexShader>> retiredVertexShaders;
+		std::vector<std::unique_ptr<RE::BSGraphics::PixelShader>> retiredPixelShaders;
+		std::array<const RE::BSShader*, static_cast<size_t>(RE::BSShader::Type::Total)> loadedShaders{};
+		std::atomic<uint64_t> hotReloadedFiles = 0;
+		std::atomic<uint64_t> hotReloadedShaders = 0;
+		std::atomic<size_t> watchedFiles = 0;
+		std::jthread hotReloadThread;
 	};
 }
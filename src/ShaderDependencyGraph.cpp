@@ -0,0 +1,143 @@
+#include "ShaderDependencyGraph.h"
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+
+ShaderDependencyGraph::ShaderDependencyGraph(std::filesystem::path a_root) :
+	root(a_root.lexically_normal())
+{}
+
+bool ShaderDependencyGraph::IsShaderSource(const std::filesystem::path& a_path)
+{
+	auto extension = a_path.extension();
+	return extension == ".hlsl" || extension == ".hlsli";
+}
+
+std::string ShaderDependencyGraph::GetKey(const std::filesystem::path& a_path) const
+{
+	auto key = a_path.lexically_normal().lexically_relative(root).generic_string();
+	std::transform(key.begin(), key.end(), key.begin(), [](char c) { return (char)std::tolower((unsigned char)c); });
+	return key;
+}
+
+std::vector<std::string> ShaderDependencyGraph::ParseIncludes(std::istream& a_stream)
+{
+	std::vector<std::string> result;
+	std::string line;
+	while (std::getline(a_stream, line)) {
+		auto start = line.find_first_not_of(" \t");
+		if (start == std::string::npos || line.compare(start, 8, "#include") != 0)
+			continue;
+		auto open = line.find('"', start + 8);
+		if (open == std::string::npos)
+			continue;
+		auto close = line.find('"', open + 1);
+		if (close == std::string::npos)
+			continue;
+		result.push_back(line.substr(open + 1, close - open - 1));
+	}
+	return result;
+}
+
+std::string ShaderDependencyGraph::ResolveInclude(const std::filesystem::path& a_includer, const std::string& a_include) const
+{
+	// same lookup order as the standard include handler: next to the including file, then the shader root
+	std::error_code ec;
+	auto local = a_includer.parent_path() / a_include;
+	if (std::filesystem::exists(local, ec))
+		return GetKey(local);
+	return GetKey(root / a_include);
+}
+
+void ShaderDependencyGraph::RemoveFile(const std::string& a_key)
+{
+	if (auto it = includes.find(a_key); it != includes.end()) {
+		for (auto& include : it->second) {
+			includedBy[include].erase(a_key);
+		}
+		includes.erase(it);
+	}
+	writeTimes.erase(a_key);
+}
+
+void ShaderDependencyGraph::UpdateFile(const std::string& a_key, const std::filesystem::path& a_path)
+{
+	if (auto it = includes.find(a_key); it != includes.end()) {
+		for (auto& include : it->second) {
+			includedBy[include].erase(a_key);
+		}
+		it->second.clear();
+	}
+
+	std::ifstream file{ a_path };
+	auto& fileIncludes = includes[a_key];
+	for (auto& include : ParseIncludes(file)) {
+		auto includeKey = ResolveInclude(a_path, include);
+		fileIncludes.insert(includeKey);
+		includedBy[includeKey].insert(a_key);
+	}
+}
+
+void ShaderDependencyGraph::Build()
+{
+	includes.clear();
+	includedBy.clear();
+	writeTimes.clear();
+	Refresh();
+}
+
+std::vector<std::string> ShaderDependencyGraph::Refresh()
+{
+	std::vector<std::string> changed;
+	std::unordered_set<std::string> seen;
+
+	std::error_code ec;
+	for (auto it = std::filesystem::recursive_directory_iterator(root, ec); !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+		if (!it->is_regular_file(ec) || !IsShaderSource(it->path()))
+			continue;
+		auto key = GetKey(it->path());
+		auto writeTime = it->last_write_time(ec);
+		seen.insert(key);
+		auto [timeIt, inserted] = writeTimes.try_emplace(key, writeTime);
+		if (inserted || timeIt->second != writeTime) {
+			timeIt->second = writeTime;
+			UpdateFile(key, it->path());
+			changed.push_back(key);
+		}
+	}
+
+	std::vector<std::string> removed;
+	for (auto& [key, time] : writeTimes) {
+		if (!seen.contains(key))
+			removed.push_back(key);
+	}
+	for (auto& key : removed) {
+		RemoveFile(key);
+		changed.push_back(key);
+	}
+
+	return changed;
+}
+
+std::unordered_set<std::string> ShaderDependencyGraph::GetAffectedShaders(const std::vector<std::string>& a_files) const
+{
+	std::unordered_set<std::string> affected;
+	std::unordered_set<std::string> visited;
+	std::vector<std::string> pending = a_files;
+	while (!pending.empty()) {
+		auto key = std::move(pending.back());
+		pending.pop_back();
+		if (!visited.insert(key).second)
+			continue;
+
+		std::filesystem::path path{ key };
+		if (!path.has_parent_path() && path.extension() == ".hlsl")
+			affected.insert(path.stem().string());
+
+		if (auto it = includedBy.find(key); it != includedBy.end()) {
+			pending.insert(pending.end(), it->second.begin(), it->second.end());
+		}
+	}
+	return affected;
+}
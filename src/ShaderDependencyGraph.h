@@ -0,0 +1,40 @@
+#pragma once
+
+#include <filesystem>
+#include <istream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Include graph of the shader sources below a root directory, used to find the shaders a hot reload has to recompile.
+class ShaderDependencyGraph
+{
+public:
+	explicit ShaderDependencyGraph(std::filesystem::path a_root);
+
+	// Scans every source below the root, recording include edges and write times
+	void Build();
+
+	// Files added, removed or written since the last Build or call, with their includes re-parsed
+	std::vector<std::string> Refresh();
+
+	// Names of the top level shaders (e.g. "Lighting" for Lighting.hlsl) that include any of the given files
+	std::unordered_set<std::string> GetAffectedShaders(const std::vector<std::string>& a_files) const;
+
+	static std::vector<std::string> ParseIncludes(std::istream& a_stream);
+
+	size_t GetFileCount() const { return writeTimes.size(); }
+
+private:
+	static bool IsShaderSource(const std::filesystem::path& a_path);
+	std::string GetKey(const std::filesystem::path& a_path) const;
+	std::string ResolveInclude(const std::filesystem::path& a_includer, const std::string& a_include) const;
+	void UpdateFile(const std::string& a_key, const std::filesystem::path& a_path);
+	void RemoveFile(const std::string& a_key);
+
+	std::filesystem::path root;
+	std::unordered_map<std::string, std::unordered_set<std::string>> includes;    // file to the files it includes
+	std::unordered_map<std::string, std::unordered_set<std::string>> includedBy;  // file to the files including it
+	std::unordered_map<std::string, std::filesystem::file_time_type> writeTimes;
+};
@@ -0,0 +1,168 @@
+#include "ShaderDump.h"
+#include "Util.h"
+
+ShaderDump::ShaderDump()
+{
+	writer = std::jthread([this](std::stop_token a_stoken) { ProcessWrites(a_stoken); });
+}
+
+const uint8_t* ShaderDump::Allocate(const void* a_bytecode, size_t a_length, std::list<Chunk>::iterator& a_chunk)
+{
+	if (chunks.empty() || chunks.back().size - chunks.back().used < a_length) {
+		Chunk chunk;
+		chunk.size = std::max(ARENA_CHUNK_SIZE, a_length);
+		chunk.data = std::make_unique<uint8_t[]>(chunk.size);
+		residentBytes += chunk.size;
+		chunks.push_back(std::move(chunk));
+	}
+
+	a_chunk = std::prev(chunks.end());
+	auto data = a_chunk->data.get() + a_chunk->used;
+	memcpy(data, a_bytecode, a_length);
+	a_chunk->used += a_length;
+	a_chunk->liveBlobs++;
+	return data;
+}
+
+void ShaderDump::Release(uint64_t a_hash)
+{
+	auto it = blobs.find(a_hash);
+	if (it == blobs.end() || --it->second.refCount > 0)
+		return;
+
+	auto chunk = it->second.chunk;
+	blobs.erase(it);
+	if (--chunk->liveBlobs == 0) {
+		if (chunk == std::prev(chunks.end())) {
+			chunk->used = 0;  // keep the active chunk around for the next shaders
+		} else {
+			residentBytes -= chunk->size;
+			chunks.erase(chunk);
+		}
+	}
+}
+
+void ShaderDump::EvictOldest(size_t a_length)
+{
+	while (residentBytes + a_length > MAX_RESIDENT_BYTES && !registrationOrder.empty()) {
+		auto [shader, sequence] = registrationOrder.front();
+		registrationOrder.pop_front();
+		auto it = shaders.find(shader);
+		if (it == shaders.end() || it->second.sequence != sequence)
+			continue;
+		Release(it->second.hash);
+		shaders.erase(it);
+		evictedShaders++;
+	}
+}
+
+void ShaderDump::Register(void* a_shader, const void* a_bytecode, size_t a_length)
+{
+	auto hash = Util::GetBytecodeHash(a_bytecode, a_length);
+	logger::debug(fmt::runtime("Saving shader at index {:x} with {} bytes:\t{:x}"), (std::uintptr_t)a_shader, a_length, hash);
+
+	std::scoped_lock lock{ mutex };
+	if (!isOpen)
+		return;
+
+	if (auto it = shaders.find(a_shader); it != shaders.end()) {
+		// address reused by a new shader before the old one was dumped
+		Release(it->second.hash);
+		shaders.erase(it);
+	}
+
+	// the hash is derived from the container checksum, only share blobs whose contents actually match
+	auto it = blobs.find(hash);
+	while (it != blobs.end() && (it->second.size != a_length || memcmp(it->second.data, a_bytecode, a_length) != 0)) {
+		it = blobs.find(++hash);
+	}
+
+	if (it == blobs.end()) {
+		EvictOldest(a_length);
+		auto& blob = blobs[hash];
+		blob.data = Allocate(a_bytecode, a_length, blob.chunk);
+		blob.size = a_length;
+		blob.refCount++;
+	} else {
+		dedupedBytes += a_length;
+		it->second.refCount++;
+	}
+	shaders.emplace(a_shader, Registration{ hash, nextSequence });
+	registrationOrder.emplace_back(a_shader, nextSequence++);
+}
+
+void ShaderDump::Dump(void* a_shader, std::string a_directory, std::string a_path)
+{
+	{
+		std::scoped_lock lock{ mutex };
+		auto it = shaders.find(a_shader);
+		if (it == shaders.end()) {
+			logger::warn(fmt::runtime("No bytecode registered for shader at index {:x}"), (std::uintptr_t)a_shader);
+			return;
+		}
+		// the write job takes over the reference, the shader itself will not be dumped again
+		writeQueue.push_back({ it->second.hash, std::move(a_directory), std::move(a_path) });
+		shaders.erase(it);
+		pendingWrites++;
+	}
+	condition.notify_one();
+}
+
+void ShaderDump::EvictUndumped()
+{
+	std::scoped_lock lock{ mutex };
+	logger::debug("Evicting {} undumped shaders", shaders.size());
+	for (auto& [shader, registration] : shaders) {
+		Release(registration.hash);
+	}
+	evictedShaders += shaders.size();
+	shaders.clear();
+	registrationOrder.clear();
+	isOpen = false;
+}
+
+void ShaderDump::ProcessWrites(std::stop_token a_stoken)
+{
+	SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_BELOW_NORMAL);
+	std::unique_lock lock{ mutex };
+	while (condition.wait(lock, a_stoken, [this]() { return !writeQueue.empty(); })) {
+		auto job = std::move(writeQueue.front());
+		writeQueue.pop_front();
+		// referenced blobs are never moved or freed, so the arena memory can be written without holding the lock
+		auto& blob = blobs.at(job.hash);
+		auto data = blob.data;
+		auto size = blob.size;
+		lock.unlock();
+
+		if (!std::filesystem::is_directory(job.directory)) {
+			try {
+				std::filesystem::create_directories(job.directory);
+			} catch (std::filesystem::filesystem_error const& ex) {
+				logger::error("Failed to create folder: {}", ex.what());
+			}
+		}
+
+		size_t written = 0;
+		if (FILE * file; fopen_s(&file, job.path.c_str(), "wb") == 0) {
+			written = fwrite(data, 1, size, file);
+			fclose(file);
+		} else {
+			logger::error("Failed to open {} for writing", job.path);
+		}
+
+		lock.lock();
+		writtenBytes += written;
+		pendingWrites--;
+		Release(job.hash);
+	}
+}
+
+std::string ShaderDump::GetStatsString()
+{
+	return std::format("{:.1f} MB held, {:.1f} MB deduplicated, {:.1f} MB written, {} pending writes, {} evicted undumped",
+		residentBytes / (1024.0 * 1024.0),
+		dedupedBytes / (1024.0 * 1024.0),
+		writtenBytes / (1024.0 * 1024.0),
+		(uint64_t)pendingWrites,
+		(uint64_t)evictedShaders);
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <unordered_map>
+
+// Holds the bytecode of shaders created while Dump Shaders is enabled until it has been written to disk.
+// Identical bytecode is stored once, blobs live in arena chunks and are evicted as soon as they are dumped.
+// Once the vanilla shaders have been dumped the registry is closed, and until then the oldest undumped blobs
+// are evicted when the arena grows past MAX_RESIDENT_BYTES.
+class ShaderDump
+{
+public:
+	static ShaderDump* GetSingleton()
+	{
+		static ShaderDump singleton;
+		return &singleton;
+	}
+
+	void Register(void* a_shader, const void* a_bytecode, size_t a_length);
+	void Dump(void* a_shader, std::string a_directory, std::string a_path);
+	void EvictUndumped();  // also closes the registry, later shaders are never dumped
+	std::string GetStatsString();
+
+	std::atomic<uint64_t> residentBytes = 0;
+	std::atomic<uint64_t> writtenBytes = 0;
+	std::atomic<uint64_t> dedupedBytes = 0;
+	std::atomic<uint64_t> pendingWrites = 0;
+	std::atomic<uint64_t> evictedShaders = 0;
+
+private:
+	static constexpr size_t ARENA_CHUNK_SIZE = 4 * 1024 * 1024;
+	static constexpr size_t MAX_RESIDENT_BYTES = 64 * ARENA_CHUNK_SIZE;
+
+	struct Chunk
+	{
+		std::unique_ptr<uint8_t[]> data;
+		size_t size = 0;
+		size_t used = 0;
+		uint32_t liveBlobs = 0;
+	};
+
+	struct Blob
+	{
+		std::list<Chunk>::iterator chunk;
+		const uint8_t* data = nullptr;
+		size_t size = 0;
+		uint32_t refCount = 0;
+	};
+
+	struct Registration
+	{
+		uint64_t hash;
+		uint64_t sequence;
+	};
+
+	struct WriteJob
+	{
+		uint64_t hash;
+		std::string directory;
+		std::string path;
+	};
+
+	ShaderDump();
+
+	const uint8_t* Allocate(const void* a_bytecode, size_t a_length, std::list<Chunk>::iterator& a_chunk);
+	void Release(uint64_t a_hash);
+	void EvictOldest(size_t a_length);
+	void ProcessWrites(std::stop_token a_stoken);
+
+	std::list<Chunk> chunks;
+	std::unordered_map<uint64_t, Blob> blobs;     // keyed by content hash
+	std::unordered_map<void*, Registration> shaders;           // created shader to content hash, until dumped
+	std::deque<std::pair<void*, uint64_t>> registrationOrder;  // oldest first, stale once dumped or replaced
+	uint64_t nextSequence = 0;
+	bool isOpen = true;
+	std::deque<WriteJob> writeQueue;
+	std::mutex mutex;
+	std::condition_variable_any condition;
+	std::jthread writer;
+};
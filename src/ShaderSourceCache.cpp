@@ -0,0 +1,133 @@
+#include "ShaderSourceCache.h"
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iterator>
+
+ShaderSourceCache::Entry ShaderSourceCache::Read(const std::filesystem::path& a_path)
+{
+	Entry entry;
+	std::error_code ec;
+	stats++;
+	entry.writeTime = std::filesystem::last_write_time(a_path, ec);
+	if (ec)
+		return entry;
+
+	std::ifstream file{ a_path, std::ios::binary };
+	if (!file)
+		return entry;
+	entry.contents = std::make_shared<const std::string>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	reads++;
+	return entry;
+}
+
+void ShaderSourceCache::Preload(const std::filesystem::path& a_root)
+{
+	std::error_code ec;
+	for (auto it = std::filesystem::recursive_directory_iterator(a_root, ec); !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+		if (!it->is_regular_file(ec))
+			continue;
+		auto extension = it->path().extension().string();
+		std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return (char)std::tolower((unsigned char)c); });
+		if (extension != ".hlsl" && extension != ".hlsli" && extension != ".h" && extension != ".fxh")
+			continue;
+
+		auto entry = Read(it->path());
+		std::scoped_lock lock{ mutex };
+		entries.insert_or_assign(GetKey(it->path()), std::move(entry));
+	}
+}
+
+ShaderSourceCache::Source ShaderSourceCache::Get(const std::filesystem::path& a_path)
+{
+	auto key = GetKey(a_path);
+	{
+		std::scoped_lock lock{ mutex };
+		if (auto it = entries.find(key); it != entries.end()) {
+			hits++;
+			return it->second.contents;
+		}
+	}
+
+	// read outside of the lock, another thread reading the same file at worst does the work twice
+	auto entry = Read(a_path);
+	auto contents = entry.contents;
+
+	std::scoped_lock lock{ mutex };
+	entries.try_emplace(key, std::move(entry));
+	return contents;
+}
+
+std::vector<std::string> ShaderSourceCache::Refresh()
+{
+	std::vector<std::pair<std::string, std::filesystem::file_time_type>> known;
+	{
+		std::scoped_lock lock{ mutex };
+		known.reserve(entries.size());
+		for (auto& [key, entry] : entries)
+			known.emplace_back(key, entry.contents ? entry.writeTime : std::filesystem::file_time_type::min());
+	}
+
+	std::vector<std::string> changed;
+	for (auto& [key, writeTime] : known) {
+		std::error_code ec;
+		stats++;
+		auto currentTime = std::filesystem::last_write_time(key, ec);
+		if (ec)
+			currentTime = std::filesystem::file_time_type::min();
+		if (currentTime == writeTime)
+			continue;
+
+		auto entry = Read(key);
+		std::scoped_lock lock{ mutex };
+		entries.insert_or_assign(key, std::move(entry));
+		changed.push_back(key);
+	}
+	return changed;
+}
+
+void ShaderSourceCache::Clear()
+{
+	std::scoped_lock lock{ mutex };
+	entries.clear();
+}
+
+size_t ShaderSourceCache::GetFileCount() const
+{
+	std::scoped_lock lock{ mutex };
+	return entries.size();
+}
+
+ShaderSourceCache::Scope::Scope(ShaderSourceCache& a_cache, std::filesystem::path a_source) :
+	cache(a_cache), source(std::move(a_source))
+{}
+
+const std::string* ShaderSourceCache::Scope::Open(const std::string& a_include, const void* a_parent)
+{
+	auto includer = source;
+	if (auto it = openFiles.find(a_parent); a_parent && it != openFiles.end())
+		includer = it->second.path;
+
+	// same lookup order as the standard include handler: next to the including file, then next to the source
+	auto path = includer.parent_path() / a_include;
+	auto contents = cache.Get(path);
+	if (!contents) {
+		path = source.parent_path() / a_include;
+		contents = cache.Get(path);
+	}
+	if (!contents)
+		return nullptr;
+
+	auto& openFile = openFiles[contents->data()];
+	openFile.contents = contents;
+	openFile.path = path;
+	openFile.references++;
+	return contents.get();
+}
+
+void ShaderSourceCache::Scope::Close(const void* a_data)
+{
+	if (auto it = openFiles.find(a_data); it != openFiles.end() && --it->second.references == 0)
+		openFiles.erase(it);
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Read-only cache of shader source files shared by every compilation thread. Sources are read once, up front by Preload or
+// on their first lookup, and then served without touching the file system until Refresh finds their write time changed.
+class ShaderSourceCache
+{
+public:
+	using Source = std::shared_ptr<const std::string>;
+
+	// Reads every shader source below a directory, so compiles never wait on the disk
+	void Preload(const std::filesystem::path& a_root);
+
+	// Contents of the file, null if it can not be read. Missing files are remembered as well.
+	Source Get(const std::filesystem::path& a_path);
+
+	// Checks the write time of every cached file once, re-reading the changed ones. Returns the keys of the changed files.
+	std::vector<std::string> Refresh();
+	void Clear();
+
+	uint64_t GetReadCount() const { return reads; }
+	uint64_t GetHitCount() const { return hits; }
+	uint64_t GetStatCount() const { return stats; }
+	size_t GetFileCount() const;
+
+	// Include lookups of a single compilation, mirrors the open and close calls a compiler makes to its include handler
+	class Scope
+	{
+	public:
+		Scope(ShaderSourceCache& a_cache, std::filesystem::path a_source);
+
+		// Opens an include requested by the file whose contents start at a_parent, or by the source itself when null
+		const std::string* Open(const std::string& a_include, const void* a_parent);
+		void Close(const void* a_data);
+
+	private:
+		struct OpenFile
+		{
+			Source contents;
+			std::filesystem::path path;
+			uint32_t references = 0;
+		};
+
+		ShaderSourceCache& cache;
+		std::filesystem::path source;
+		std::unordered_map<const void*, OpenFile> openFiles;
+	};
+
+private:
+	struct Entry
+	{
+		Source contents;  // null for a file that did not exist
+		std::filesystem::file_time_type writeTime;
+	};
+
+	static std::string GetKey(const std::filesystem::path& a_path) { return a_path.lexically_normal().generic_string(); }
+	Entry Read(const std::filesystem::path& a_path);
+
+	std::unordered_map<std::string, Entry> entries;
+	mutable std::mutex mutex;
+	std::atomic<uint64_t> reads = 0;
+	std::atomic<uint64_t> hits = 0;
+	std::atomic<uint64_t> stats = 0;
+};
@@ -0,0 +1,119 @@
+#include "ShaderSourceGroups.h"
+
+#include <cctype>
+#include <cstring>
+
+namespace
+{
+	// Feeds the normalized source to the digest in blocks instead of byte by byte
+	class DigestWriter
+	{
+	public:
+		void Put(char a_char)
+		{
+			if (size == sizeof(buffer))
+				Flush();
+			buffer[size++] = a_char;
+		}
+
+		Sha256::Digest Finish()
+		{
+			Flush();
+			return sha.Finish();
+		}
+
+	private:
+		void Flush()
+		{
+			sha.Update(buffer, size);
+			size = 0;
+		}
+
+		Sha256 sha;
+		char buffer[4096];
+		size_t size = 0;
+	};
+}
+
+size_t ShaderSourceGroups::DigestHash::operator()(const Digest& a_digest) const
+{
+	size_t hash;
+	std::memcpy(&hash, a_digest.data(), sizeof(hash));
+	return hash;
+}
+
+ShaderSourceGroups::Digest ShaderSourceGroups::HashSource(std::string_view a_profile, std::string_view a_source)
+{
+	DigestWriter writer;
+	for (auto c : a_profile)
+		writer.Put(c);
+	writer.Put(0);
+
+	// the preprocessor output keeps line directives naming the source files, which say nothing about the compiled code
+	bool pendingSpace = false;
+	size_t lineStart = 0;
+	while (lineStart < a_source.size()) {
+		auto lineEnd = a_source.find('\n', lineStart);
+		if (lineEnd == std::string_view::npos)
+			lineEnd = a_source.size();
+		auto line = a_source.substr(lineStart, lineEnd - lineStart);
+		lineStart = lineEnd + 1;
+
+		auto first = line.find_first_not_of(" \t\r");
+		if (first == std::string_view::npos || line.compare(first, 5, "#line") == 0)
+			continue;
+
+		// runs of whitespace, including line breaks, separate tokens the same way
+		pendingSpace = true;
+		for (auto c : line.substr(first)) {
+			if (std::isspace((unsigned char)c)) {
+				pendingSpace = true;
+				continue;
+			}
+			if (pendingSpace) {
+				writer.Put(' ');
+				pendingSpace = false;
+			}
+			writer.Put(c);
+		}
+	}
+	return writer.Finish();
+}
+
+std::string ShaderSourceGroups::Add(uint32_t a_type, const Digest& a_digest, const std::string& a_key)
+{
+	std::scoped_lock lock{ mutex };
+	auto [it, inserted] = groups.try_emplace(a_digest);
+	auto& group = it->second;
+	if (inserted) {
+		group.representative = a_key;
+		group.type = a_type;
+	}
+	group.members.insert(a_key);
+	return group.representative == a_key ? std::string{} : group.representative;
+}
+
+void ShaderSourceGroups::Remove(std::string_view a_keyPrefix)
+{
+	std::scoped_lock lock{ mutex };
+	std::erase_if(groups, [&](const auto& item) { return item.second.representative.starts_with(a_keyPrefix); });
+}
+
+void ShaderSourceGroups::Clear()
+{
+	std::scoped_lock lock{ mutex };
+	groups.clear();
+}
+
+ShaderSourceGroups::Stats ShaderSourceGroups::GetStats(uint32_t a_type) const
+{
+	std::scoped_lock lock{ mutex };
+	Stats stats;
+	for (auto& [digest, group] : groups) {
+		if (group.type != a_type)
+			continue;
+		stats.permutations += group.members.size();
+		stats.uniqueSources++;
+	}
+	return stats;
+}
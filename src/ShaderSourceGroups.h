@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "Sha256.h"
+
+// Groups shader permutations by the digest of their preprocessed source, so permutations whose defines
+// make no difference once the preprocessor has run are only compiled once.
+class ShaderSourceGroups
+{
+public:
+	using Digest = Sha256::Digest;
+
+	// SHA-256 of the profile and the preprocessed source, ignoring line directives and whitespace differences.
+	// Bytecode is shared on equal digests, so this is a content hash rather than a fast 64 bit one.
+	static Digest HashSource(std::string_view a_profile, std::string_view a_source);
+
+	// Registers a permutation, returns the key of the first permutation with the same source or an empty string if there is none
+	std::string Add(uint32_t a_type, const Digest& a_digest, const std::string& a_key);
+
+	// Forgets the groups started by permutations whose key begins with the prefix, e.g. after a source file changed
+	void Remove(std::string_view a_keyPrefix);
+	void Clear();
+
+	struct Stats
+	{
+		uint64_t permutations = 0;
+		uint64_t uniqueSources = 0;
+	};
+	Stats GetStats(uint32_t a_type) const;
+
+private:
+	struct Group
+	{
+		std::string representative;
+		uint32_t type = 0;
+		std::unordered_set<std::string> members;
+	};
+
+	struct DigestHash
+	{
+		size_t operator()(const Digest& a_digest) const;
+	};
+
+	std::unordered_map<Digest, Group, DigestHash> groups;
+	mutable std::mutex mutex;
+};
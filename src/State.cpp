@@ -7,6 +7,7 @@
 #include "ShaderCache.h"
 
 #include "Feature.h"
+#include "SettingsBlock.h"
 #include "Util.h"
 
 void State::Draw()
@@ -99,6 +100,13 @@ void State::DrawDeferred()
 void State::Reset()
 {
 	lightingDataRequiresUpdate = true;
+	SettingsBlockBase::NewFrame();
+	SIE::ShaderCache::Instance().UpdateCriticalRecording();
+	if (frameCapture.IsCapturing()) {
+		frameCapture.BeginFrame(RE::BSGraphics::State::GetSingleton()->uiFrameCount);
+		if (!frameCapture.IsCapturing())
+			logger::info("Captured {} frames ({} bytes) to {}", frameCapture.GetCapturedFrames(), frameCapture.GetCapturedBytes(), frameCapturePath);
+	}
 	for (auto* feature : Feature::GetFeatureList())
 		if (feature->loaded)
 			feature->Reset();
@@ -116,6 +124,9 @@ void State::Load(bool a_test)
 {
 	auto& shaderCache = SIE::ShaderCache::Instance();
 
+	// pick up saves still waiting to be written
+	settingsWriter.Flush();
+
 	std::string configPath = a_test ? testConfigPath : userConfigPath;
 	std::ifstream i(configPath);
 	if (!i.is_open()) {
@@ -145,6 +156,8 @@ void State::Load(bool a_test)
 		json& advanced = settings["Advanced"];
 		if (advanced["Dump Shaders"].is_boolean())
 			shaderCache.SetDump(advanced["Dump Shaders"]);
+		if (advanced["Hot Reload Shaders"].is_boolean())
+			shaderCache.SetHotReload(advanced["Hot Reload Shaders"]);
 		if (advanced["Log Level"].is_number_integer()) {
 			logLevel = static_cast<spdlog::level::level_enum>((int)advanced["Log Level"]);
 			//logLevel = static_cast<spdlog::level::level_enum>(max(spdlog::level::trace, min(spdlog::level::off, (int)advanced["Log Level"])));
@@ -192,13 +205,13 @@ void State::Load(bool a_test)
 void State::Save(bool a_test)
 {
 	auto& shaderCache = SIE::ShaderCache::Instance();
-	std::ofstream o{ a_test ? testConfigPath : userConfigPath };
 	json settings;
 
 	Menu::GetSingleton()->Save(settings);
 
 	json advanced;
 	advanced["Dump Shaders"] = shaderCache.IsDump();
+	advanced["Hot Reload Shaders"] = shaderCache.IsHotReload();
 	advanced["Log Level"] = logLevel;
 	advanced["Shader Defines"] = shaderDefinesString;
 	advanced["Compiler Threads"] = shaderCache.compilationThreadCount;
@@ -223,8 +236,9 @@ void State::Save(bool a_test)
 	for (auto* feature : Feature::GetFeatureList())
 		feature->Save(settings);
 
-	o << settings.dump(1);
-	logger::info("Saving settings to {}", userConfigPath);
+	const auto& configPath = a_test ? testConfigPath : userConfigPath;
+	settingsWriter.Write(configPath, settings.dump(1));
+	logger::info("Saving settings to {}", configPath);
 }
 
 void State::PostPostLoad()
@@ -419,6 +433,51 @@ void State::ModifyShaderLookup(const RE::BSShader& a_shader, uint& a_vertexDescr
 	}
 }
 
+void State::UpdateWaterHeights()
+{
+	auto shadowState = RE::BSGraphics::RendererShadowState::GetSingleton();
+	auto tes = RE::TES::GetSingleton();
+	if (!shadowState || !tes)
+		return;
+
+	auto position = !REL::Module::IsVR() ? shadowState->GetRuntimeData().posAdjust.getEye() : shadowState->GetVRRuntimeData().posAdjust.getEye();
+	auto worldKey = tes->interiorCell ? reinterpret_cast<std::uintptr_t>(tes->interiorCell) : reinterpret_cast<std::uintptr_t>(tes->worldSpace);
+	if (waterHeightsChanged.exchange(false))
+		waterHeights.Invalidate();
+
+	// Only cells entering the window around the camera, or not loaded when last queried, go through the cell lookup
+	waterHeights.Update(WaterHeightGrid::GetCellCoord(position.x), WaterHeightGrid::GetCellCoord(position.y), worldKey, [&](std::int32_t a_cellX, std::int32_t a_cellY) -> std::optional<float> {
+		RE::NiPoint3 cellCenter{ ((float)a_cellX + 0.5f) * WaterHeightGrid::CELL_SIZE, ((float)a_cellY + 0.5f) * WaterHeightGrid::CELL_SIZE, position.z };
+		if (auto cell = tes->GetCell(cellCenter))
+			return cell->GetExteriorWaterHeight();
+		return std::nullopt;
+	});
+}
+
+RE::BSEventNotifyControl CellAttachDetachEventHandler::ProcessEvent(const RE::TESCellAttachDetachEvent*, RE::BSTEventSource<RE::TESCellAttachDetachEvent>*)
+{
+	// A cell may have been queried before it was loaded, or unloaded with its water still cached
+	State::GetSingleton()->waterHeightsChanged = true;
+	return RE::BSEventNotifyControl::kContinue;
+}
+
+bool CellAttachDetachEventHandler::Register()
+{
+	static CellAttachDetachEventHandler singleton;
+	auto scripts = RE::ScriptEventSourceHolder::GetSingleton();
+
+	if (!scripts) {
+		logger::error("Script event source not found");
+		return false;
+	}
+
+	scripts->AddEventSink<RE::TESCellAttachDetachEvent>(&singleton);
+
+	logger::info("Registered {}", typeid(singleton).name());
+
+	return true;
+}
+
 void State::UpdateSharedData(const RE::BSShader* a_shader, const uint32_t)
 {
 	if (a_shader->shaderType.get() == RE::BSShader::Type::Lighting) {
@@ -439,11 +498,12 @@ void State::UpdateSharedData(const RE::BSShader* a_shader, const uint32_t)
 
 		if (lightingDataRequiresUpdate) {
 			lightingDataRequiresUpdate = false;
+			UpdateWaterHeights();
+			auto position = !REL::Module::IsVR() ? shadowState->GetRuntimeData().posAdjust.getEye() : shadowState->GetVRRuntimeData().posAdjust.getEye();
 			for (int i = -2; i < 3; i++) {
 				for (int k = -2; k < 3; k++) {
 					int waterTile = (i + 2) + ((k + 2) * 5);
-					auto position = !REL::Module::IsVR() ? shadowState->GetRuntimeData().posAdjust.getEye() : shadowState->GetVRRuntimeData().posAdjust.getEye();
-					lightingData.WaterHeight[waterTile] = Util::TryGetWaterHeight((float)i * 4096.0f, (float)k * 4096.0f) - position.z;
+					lightingData.WaterHeight[waterTile] = waterHeights.Get(i, k) - position.z;
 				}
 			}
 			updateBuffer = true;
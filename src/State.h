@@ -2,8 +2,20 @@
 
 #include <Buffer.h>
 #include <nlohmann/json.hpp>
+
+#include "FrameCapture.h"
+#include "SettingsWriter.h"
+#include "WaterHeightGrid.h"
 using json = nlohmann::json;
 
+// Loaded cells and their water change on attach and detach, the cached water heights are discarded then
+class CellAttachDetachEventHandler : public RE::BSTEventSink<RE::TESCellAttachDetachEvent>
+{
+public:
+	virtual RE::BSEventNotifyControl ProcessEvent(const RE::TESCellAttachDetachEvent* a_event, RE::BSTEventSource<RE::TESCellAttachDetachEvent>* a_eventSource);
+	static bool Register();
+};
+
 class State
 {
 public:
@@ -27,6 +39,14 @@ public:
 
 	bool upscalerLoaded = false;
 
+	// inputs of the feature models for replaying outside of the game
+	static constexpr uint32_t FRAME_CAPTURE_FRAMES = 600;
+	const std::string frameCapturePath = "Data\\SKSE\\Plugins\\CommunityShaders\\FrameCapture.bin";
+	FrameCapture::Writer frameCapture;
+
+	// saves are written in the background so clicking through the menu does not hitch on file IO
+	SettingsWriter settingsWriter{ std::chrono::milliseconds(500), [](const std::string& a_path) { logger::error("Failed to save settings to {}", a_path); } };
+
 	void Draw();
 	void DrawDeferred();
 	void Reset();
@@ -99,5 +119,12 @@ public:
 
 	LightingData lightingData{};
 
+	WaterHeightGrid waterHeights;                   // absolute heights of the cells around the camera, shared with the features
+	std::atomic<bool> waterHeightsChanged = false;  // set from the game thread on cell attach and detach, applied on the next update
+
+	void UpdateWaterHeights();
+	// Water height of the exterior cell containing a world position, NO_WATER outside the 5x5 cells around the camera
+	float GetWaterHeight(float a_x, float a_y) const { return waterHeights.GetCell(WaterHeightGrid::GetCellCoord(a_x), WaterHeightGrid::GetCellCoord(a_y)); }
+
 	std::unique_ptr<Buffer> lightingDataBuffer = nullptr;
 };
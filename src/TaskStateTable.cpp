@@ -0,0 +1,65 @@
+#include "TaskStateTable.h"
+
+bool TaskStateTable::TryAdd(std::size_t a_id)
+{
+	auto& shard = GetShard(a_id);
+	std::scoped_lock lock{ shard.mutex };
+	return shard.states.try_emplace(a_id, State::Queued).second;
+}
+
+void TaskStateTable::Set(std::size_t a_id, State a_state)
+{
+	auto& shard = GetShard(a_id);
+	std::scoped_lock lock{ shard.mutex };
+	shard.states.insert_or_assign(a_id, a_state);
+}
+
+std::optional<TaskStateTable::State> TaskStateTable::Get(std::size_t a_id) const
+{
+	auto& shard = GetShard(a_id);
+	std::scoped_lock lock{ shard.mutex };
+	if (auto it = shard.states.find(a_id); it != shard.states.end())
+		return it->second;
+	return std::nullopt;
+}
+
+bool TaskStateTable::Invalidate(std::size_t a_id)
+{
+	auto& shard = GetShard(a_id);
+	std::scoped_lock lock{ shard.mutex };
+	auto it = shard.states.find(a_id);
+	if (it == shard.states.end())
+		return true;
+	switch (it->second) {
+	case State::Completed:
+	case State::Failed:
+		shard.states.erase(it);
+		return true;
+	case State::InProgress:
+		it->second = State::Stale;
+		return false;
+	default:
+		return false;
+	}
+}
+
+bool TaskStateTable::Finish(std::size_t a_id, State a_state)
+{
+	auto& shard = GetShard(a_id);
+	std::scoped_lock lock{ shard.mutex };
+	auto it = shard.states.find(a_id);
+	if (it != shard.states.end() && it->second == State::Stale) {
+		shard.states.erase(it);
+		return false;
+	}
+	shard.states.insert_or_assign(a_id, a_state);
+	return true;
+}
+
+void TaskStateTable::Clear()
+{
+	for (auto& shard : shards) {
+		std::scoped_lock lock{ shard.mutex };
+		shard.states.clear();
+	}
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+
+// State of every task ever queued, split into independently locked shards so threads touching different tasks rarely meet.
+class TaskStateTable
+{
+public:
+	enum class State : std::uint8_t
+	{
+		Queued,
+		InProgress,
+		Completed,
+		Failed,
+		Stale  // in progress on sources that changed since it started
+	};
+
+	// Records a new task as queued, false if the task is already known in any state
+	bool TryAdd(std::size_t a_id);
+
+	void Set(std::size_t a_id, State a_state);
+	std::optional<State> Get(std::size_t a_id) const;
+
+	// Forgets a completed or failed task so it can be queued again and returns true. A task in progress is marked
+	// stale instead, queued tasks have not read their sources yet and are kept as they are.
+	bool Invalidate(std::size_t a_id);
+
+	// Records the result of a task in progress. A stale task is forgotten instead and false is returned, so it can be queued again.
+	bool Finish(std::size_t a_id, State a_state);
+
+	void Clear();
+
+private:
+	static constexpr std::size_t SHARD_COUNT = 64;
+
+	struct alignas(64) Shard
+	{
+		mutable std::mutex mutex;
+		std::unordered_map<std::size_t, State> states;
+	};
+
+	Shard& GetShard(std::size_t a_id) { return shards[(a_id * 0x9E3779B97F4A7C15ull) >> 58]; }
+	const Shard& GetShard(std::size_t a_id) const { return shards[(a_id * 0x9E3779B97F4A7C15ull) >> 58]; }
+
+	std::array<Shard, SHARD_COUNT> shards;
+};
@@ -1,4 +1,5 @@
 #include "Util.h"
+#include "ShaderCache.h"
 #include "State.h"
 
 #include <d3dcompiler.h>
@@ -155,47 +156,91 @@ namespace Util
 		// Compiler setup
 		uint32_t flags = D3DCOMPILE_ENABLE_STRICTNESS | D3DCOMPILE_OPTIMIZATION_LEVEL3;
 
-		ID3DBlob* shaderBlob;
-		ID3DBlob* shaderErrors;
+		ID3DBlob* shaderBlob = nullptr;
+		ID3DBlob* shaderErrors = nullptr;
 
 		std::string str;
 		std::wstring path{ FilePath };
 		std::transform(path.begin(), path.end(), std::back_inserter(str), [](wchar_t c) {
 			return (char)c;
 		});
+		// creates the shader of ProgramType from bytecode, null with a_result set if the device rejects it
+		auto createShader = [&](ID3DBlob* a_blob, HRESULT& a_result) -> ID3D11DeviceChild* {
+			auto bytecode = a_blob->GetBufferPointer();
+			auto size = a_blob->GetBufferSize();
+			if (!_stricmp(ProgramType, "ps_5_0")) {
+				ID3D11PixelShader* regShader = nullptr;
+				a_result = device->CreatePixelShader(bytecode, size, nullptr, &regShader);
+				return regShader;
+			} else if (!_stricmp(ProgramType, "vs_5_0")) {
+				ID3D11VertexShader* regShader = nullptr;
+				a_result = device->CreateVertexShader(bytecode, size, nullptr, &regShader);
+				return regShader;
+			} else if (!_stricmp(ProgramType, "hs_5_0")) {
+				ID3D11HullShader* regShader = nullptr;
+				a_result = device->CreateHullShader(bytecode, size, nullptr, &regShader);
+				return regShader;
+			} else if (!_stricmp(ProgramType, "ds_5_0")) {
+				ID3D11DomainShader* regShader = nullptr;
+				a_result = device->CreateDomainShader(bytecode, size, nullptr, &regShader);
+				return regShader;
+			} else if (!_stricmp(ProgramType, "cs_5_0") || !_stricmp(ProgramType, "cs_4_0")) {
+				ID3D11ComputeShader* regShader = nullptr;
+				a_result = device->CreateComputeShader(bytecode, size, nullptr, &regShader);
+				return regShader;
+			}
+			a_result = S_OK;
+			return nullptr;
+		};
+
+		// bytecode is kept in the disk cache keyed by the preprocessed source, flags and compiler, so warm starts skip the compiler
+		auto& shaderCache = SIE::ShaderCache::Instance();
+		const auto diskPath = shaderCache.GetUtilityShaderDiskPath(path, macros.data(), ProgramType, Program, flags);
+		if (!diskPath.empty() && std::filesystem::exists(diskPath) && SUCCEEDED(D3DReadFileToBlob(diskPath.c_str(), &shaderBlob))) {
+			HRESULT result;
+			auto shader = createShader(shaderBlob, result);
+			shaderBlob->Release();
+			shaderBlob = nullptr;
+			if (SUCCEEDED(result)) {
+				logger::debug("Loaded {} from disk cache", str);
+				shaderCache.utilityCacheHits++;
+				return shader;
+			}
+
+			// a damaged entry would otherwise fail the same way on every start
+			logger::warn("Discarding {} from disk cache, the device rejected it", str);
+			std::error_code ec;
+			std::filesystem::remove(diskPath, ec);
+		}
+
 		logger::debug("Compiling {} with {}", str, DefinesToString(macros));
 		if (FAILED(D3DCompileFromFile(FilePath, macros.data(), D3D_COMPILE_STANDARD_FILE_INCLUDE, Program, ProgramType, flags, 0, &shaderBlob, &shaderErrors))) {
 			logger::warn("Shader compilation failed:\n\n{}", shaderErrors ? (const char*)shaderErrors->GetBufferPointer() : "Unknown error");
 			return nullptr;
 		}
+		shaderCache.utilityCacheMisses++;
 
-		if (!_stricmp(ProgramType, "ps_5_0")) {
-			ID3D11PixelShader* regShader;
-			device->CreatePixelShader(shaderBlob->GetBufferPointer(), shaderBlob->GetBufferSize(), nullptr, &regShader);
-			return regShader;
-		} else if (!_stricmp(ProgramType, "vs_5_0")) {
-			ID3D11VertexShader* regShader;
-			device->CreateVertexShader(shaderBlob->GetBufferPointer(), shaderBlob->GetBufferSize(), nullptr, &regShader);
-			return regShader;
-		} else if (!_stricmp(ProgramType, "hs_5_0")) {
-			ID3D11HullShader* regShader;
-			device->CreateHullShader(shaderBlob->GetBufferPointer(), shaderBlob->GetBufferSize(), nullptr, &regShader);
-			return regShader;
-		} else if (!_stricmp(ProgramType, "ds_5_0")) {
-			ID3D11DomainShader* regShader;
-			device->CreateDomainShader(shaderBlob->GetBufferPointer(), shaderBlob->GetBufferSize(), nullptr, &regShader);
-			return regShader;
-		} else if (!_stricmp(ProgramType, "cs_5_0")) {
-			ID3D11ComputeShader* regShader;
-			DX::ThrowIfFailed(device->CreateComputeShader(shaderBlob->GetBufferPointer(), shaderBlob->GetBufferSize(), nullptr, &regShader));
-			return regShader;
-		} else if (!_stricmp(ProgramType, "cs_4_0")) {
-			ID3D11ComputeShader* regShader;
-			DX::ThrowIfFailed(device->CreateComputeShader(shaderBlob->GetBufferPointer(), shaderBlob->GetBufferSize(), nullptr, &regShader));
-			return regShader;
+		if (!diskPath.empty()) {
+			// written next to the entry and renamed over it, so an interrupted write never leaves a truncated entry behind
+			std::error_code ec;
+			std::filesystem::create_directories(std::filesystem::path(diskPath).parent_path(), ec);
+			const auto tempPath = std::format(L"{}.{}.tmp", diskPath, GetCurrentThreadId());
+			if (SUCCEEDED(D3DWriteBlobToFile(shaderBlob, tempPath.c_str(), true)))
+				std::filesystem::rename(tempPath, diskPath, ec);
+			else
+				ec = std::make_error_code(std::errc::io_error);
+			if (ec) {
+				logger::warn("Failed to save {} to disk cache", str);
+				std::filesystem::remove(tempPath, ec);
+			}
 		}
 
-		return nullptr;
+		HRESULT result;
+		auto shader = createShader(shaderBlob, result);
+		shaderBlob->Release();
+		if (!_stricmp(ProgramType, "cs_5_0") || !_stricmp(ProgramType, "cs_4_0"))
+			DX::ThrowIfFailed(result);
+		return shader;
 	}
 
 	std::string DefinesToString(std::vector<std::pair<const char*, const char*>>& defines)
@@ -233,18 +278,16 @@ namespace Util
 		return result;
 	}
 
-	float TryGetWaterHeight(float offsetX, float offsetY)
+	uint64_t GetBytecodeHash(const void* a_bytecode, size_t a_length)
 	{
-		if (auto shadowState = RE::BSGraphics::RendererShadowState::GetSingleton()) {
-			if (auto tes = RE::TES::GetSingleton()) {
-				auto position = !REL::Module::IsVR() ? shadowState->GetRuntimeData().posAdjust.getEye() : shadowState->GetVRRuntimeData().posAdjust.getEye();
-				position.x += offsetX;
-				position.y += offsetY;
-				if (auto cell = tes->GetCell(position))
-					return cell->GetExteriorWaterHeight();
-			}
+		// DXBC containers carry an MD5 of their contents right after the magic, use it instead of hashing everything
+		auto bytes = static_cast<const uint8_t*>(a_bytecode);
+		if (a_length >= 20 && memcmp(bytes, "DXBC", 4) == 0) {
+			uint64_t checksum[2];
+			memcpy(checksum, bytes + 4, sizeof(checksum));
+			return checksum[0] ^ (checksum[1] * 31) ^ a_length;
 		}
-		return -RE::NI_INFINITY;
+		return std::hash<std::string_view>{}(std::string_view(reinterpret_cast<const char*>(bytes), a_length)) ^ a_length;
 	}
 
 	void DumpSettingsOptions()
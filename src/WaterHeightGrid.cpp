@@ -0,0 +1,39 @@
+#include "WaterHeightGrid.h"
+
+void WaterHeightGrid::Update(std::int32_t a_cellX, std::int32_t a_cellY, std::uintptr_t a_worldKey, const Provider& a_provider)
+{
+	updateCount++;
+
+	bool keep = valid && worldKey == a_worldKey;
+	std::array<std::optional<float>, SIZE * SIZE> updated;
+	for (std::int32_t y = -RADIUS; y <= RADIUS; y++) {
+		for (std::int32_t x = -RADIUS; x <= RADIUS; x++) {
+			auto previousX = a_cellX + x - centerX;
+			auto previousY = a_cellY + y - centerY;
+			std::optional<float> height;
+			if (keep && InWindow(previousX, previousY))
+				height = heights[GetIndex(previousX, previousY)];
+			if (!height) {
+				height = a_provider(a_cellX + x, a_cellY + y);
+				queryCount++;
+			}
+			updated[GetIndex(x, y)] = height;
+		}
+	}
+
+	heights = updated;
+	centerX = a_cellX;
+	centerY = a_cellY;
+	worldKey = a_worldKey;
+	valid = true;
+}
+
+float WaterHeightGrid::Get(std::int32_t a_offsetX, std::int32_t a_offsetY) const
+{
+	return valid && InWindow(a_offsetX, a_offsetY) ? heights[GetIndex(a_offsetX, a_offsetY)].value_or(NO_WATER) : NO_WATER;
+}
+
+float WaterHeightGrid::GetCell(std::int32_t a_cellX, std::int32_t a_cellY) const
+{
+	return Get(a_cellX - centerX, a_cellY - centerY);
+}
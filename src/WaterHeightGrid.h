@@ -0,0 +1,53 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+
+// Exterior water heights of the 5x5 cells around the camera, moved as a sliding window so only cells entering it are queried.
+class WaterHeightGrid
+{
+public:
+	static constexpr std::int32_t RADIUS = 2;
+	static constexpr std::int32_t SIZE = RADIUS * 2 + 1;
+	static constexpr float CELL_SIZE = 4096.0f;
+	static constexpr float NO_WATER = std::numeric_limits<float>::lowest();  // also returned for cells that are not loaded, same as -NI_INFINITY
+
+	// Water height of a cell, nullopt when it is not loaded yet
+	using Provider = std::function<std::optional<float>(std::int32_t a_cellX, std::int32_t a_cellY)>;
+
+	static std::int32_t GetCellCoord(float a_position) { return (std::int32_t)std::floor(a_position / CELL_SIZE); }
+
+	// Centres the window on a cell. Cells that stay inside the window keep their height, the others and the ones not loaded
+	// yet are queried again. A different world key (worldspace or interior cell) discards everything.
+	void Update(std::int32_t a_cellX, std::int32_t a_cellY, std::uintptr_t a_worldKey, const Provider& a_provider);
+
+	// Discards every height, for example after the water level of a cell changed
+	void Invalidate() { valid = false; }
+
+	// Height of the cell at an offset of [-RADIUS, RADIUS] cells from the centre
+	float Get(std::int32_t a_offsetX, std::int32_t a_offsetY) const;
+
+	// Height of a cell by its coordinates, NO_WATER outside the window
+	float GetCell(std::int32_t a_cellX, std::int32_t a_cellY) const;
+
+	std::int32_t GetCenterX() const { return centerX; }
+	std::int32_t GetCenterY() const { return centerY; }
+	std::uint64_t GetQueryCount() const { return queryCount; }
+	std::uint64_t GetUpdateCount() const { return updateCount; }
+
+private:
+	static std::size_t GetIndex(std::int32_t a_offsetX, std::int32_t a_offsetY) { return (std::size_t)((a_offsetX + RADIUS) + (a_offsetY + RADIUS) * SIZE); }
+	static bool InWindow(std::int32_t a_offsetX, std::int32_t a_offsetY) { return std::abs(a_offsetX) <= RADIUS && std::abs(a_offsetY) <= RADIUS; }
+
+	std::array<std::optional<float>, SIZE * SIZE> heights{};
+	std::int32_t centerX = 0;
+	std::int32_t centerY = 0;
+	std::uintptr_t worldKey = 0;
+	bool valid = false;
+	std::uint64_t queryCount = 0;
+	std::uint64_t updateCount = 0;
+};
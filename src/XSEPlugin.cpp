@@ -2,6 +2,7 @@
 
 #include "Menu.h"
 #include "ShaderCache.h"
+#include "ShaderDump.h"
 #include "State.h"
 
 #include "ENB/ENBSeriesAPI.h"
@@ -96,6 +97,8 @@ void MessageHandler(SKSE::MessagingInterface::Message* message)
 				auto& shaderCache = SIE::ShaderCache::Instance();
 
 				shaderCache.ValidateDiskCache();
+				shaderCache.sourceCache.Preload("Data/Shaders");
+				logger::info("Preloaded {} shader source files", shaderCache.sourceCache.GetFileCount());
 
 				for (auto* feature : Feature::GetFeatureList()) {
 					if (feature->loaded) {
@@ -116,14 +119,28 @@ void MessageHandler(SKSE::MessagingInterface::Message* message)
 			if (errors.empty()) {
 				auto& shaderCache = SIE::ShaderCache::Instance();
 				shaderCache.menuLoaded = true;
-				while (shaderCache.IsCompiling() && !shaderCache.backgroundCompilation) {
+				shaderCache.MarkStage(SIE::ShaderCache::StartupStage::DataLoaded);
+				shaderCache.StartCriticalRecording();
+
+				// only block on the shaders recorded as critical, the rest finish on background threads while vanilla shaders are used
+				while (shaderCache.IsCompilingCritical() && !shaderCache.backgroundCompilation) {
 					std::this_thread::sleep_for(100ms);
 				}
+				shaderCache.MarkStage(SIE::ShaderCache::StartupStage::CriticalReady);
+				// the disk cache info is written when the backlog is ready, right away or once the background threads finish it
+				if (shaderCache.IsCompiling()) {
+					shaderCache.CompileBacklogInBackground();
+				} else {
+					shaderCache.MarkStage(SIE::ShaderCache::StartupStage::BacklogReady);
+				}
 
-				if (shaderCache.IsDiskCache()) {
-					shaderCache.WriteDiskCacheInfo();
+				if (shaderCache.IsDump()) {
+					// vanilla shaders have all been loaded and dumped by now, anything left was created by us
+					ShaderDump::GetSingleton()->EvictUndumped();
 				}
 
+				CellAttachDetachEventHandler::Register();
+
 				for (auto* feature : Feature::GetFeatureList()) {
 					if (feature->loaded) {
 						feature->DataLoaded();
@@ -131,6 +148,15 @@ void MessageHandler(SKSE::MessagingInterface::Message* message)
 				}
 			}
 
+			break;
+		}
+	case SKSE::MessagingInterface::kPostLoadGame:
+	case SKSE::MessagingInterface::kNewGame:
+		{
+			if (errors.empty()) {
+				SIE::ShaderCache::Instance().StopCriticalRecording();
+			}
+
 			break;
 		}
 	}
@@ -0,0 +1,132 @@
+#include "Features/GrassCollision/CollisionGrid.h"
+#include "Test.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace
+{
+	// Same lookup as GetDisplacedPosition in GrassCollision.hlsli, empty outside of the grid
+	std::vector<std::uint32_t> GetCandidates(const CollisionGrid& a_grid, float a_x, float a_y)
+	{
+		auto cellX = (int)std::floor((a_x - a_grid.GetOriginX()) / a_grid.GetCellSize());
+		auto cellY = (int)std::floor((a_y - a_grid.GetOriginY()) / a_grid.GetCellSize());
+		if (cellX < 0 || cellY < 0 || cellX >= (int)CollisionGrid::GRID_SIZE || cellY >= (int)CollisionGrid::GRID_SIZE)
+			return {};
+		auto range = a_grid.GetCells()[cellY * CollisionGrid::GRID_SIZE + cellX];
+		return { a_grid.GetIndices().begin() + range.offset, a_grid.GetIndices().begin() + range.offset + range.count };
+	}
+
+	bool Reaches(const CollisionGrid::Sphere& a_sphere, float a_x, float a_y)
+	{
+		return std::hypot(a_sphere.x - a_x, a_sphere.y - a_y) < a_sphere.radius;
+	}
+
+	// Cells cover the indices back to back, each cell lists a sphere at most once
+	bool IsPacked(const CollisionGrid& a_grid, std::size_t a_sphereCount)
+	{
+		std::uint32_t offset = 0;
+		std::uint32_t maxCount = 0;
+		for (auto& cell : a_grid.GetCells()) {
+			if (cell.offset != offset)
+				return false;
+			std::vector<std::uint32_t> cellIndices{ a_grid.GetIndices().begin() + cell.offset, a_grid.GetIndices().begin() + cell.offset + cell.count };
+			std::sort(cellIndices.begin(), cellIndices.end());
+			if (std::adjacent_find(cellIndices.begin(), cellIndices.end()) != cellIndices.end())
+				return false;
+			if (!cellIndices.empty() && cellIndices.back() >= a_sphereCount)
+				return false;
+			offset += cell.count;
+			maxCount = std::max(maxCount, cell.count);
+		}
+		return offset == a_grid.GetIndices().size() && maxCount == a_grid.GetMaxCellCount();
+	}
+}
+
+TEST_CASE(EmptyGridHasNoCandidates)
+{
+	CollisionGrid grid;
+	grid.Build({});
+	CHECK(grid.GetCells().size() == CollisionGrid::GRID_SIZE * CollisionGrid::GRID_SIZE);
+	CHECK(grid.GetIndices().empty());
+	CHECK(grid.GetMaxCellCount() == 0);
+	CHECK(GetCandidates(grid, 0.5f, 0.5f).empty());
+}
+
+TEST_CASE(FitsTheFootprintOfTheSpheres)
+{
+	CollisionGrid grid;
+	grid.Build({ { 100.0f, 50.0f, 10.0f }, { 420.0f, 90.0f, 20.0f } });
+
+	// the wider axis spans 90 to 440, split into GRID_SIZE cells
+	CHECK(grid.GetOriginX() == 90.0f && grid.GetOriginY() == 40.0f);
+	CHECK(grid.GetCellSize() == 350.0f / CollisionGrid::GRID_SIZE);
+	CHECK(IsPacked(grid, 2));
+	CHECK(GetCandidates(grid, 100.0f, 50.0f) == std::vector<std::uint32_t>{ 0 });
+	CHECK(GetCandidates(grid, 420.0f, 90.0f) == std::vector<std::uint32_t>{ 1 });
+	CHECK(GetCandidates(grid, 250.0f, 50.0f).empty());
+
+	// a single small sphere keeps cells of at least one unit
+	grid.Build({ { 0.0f, 0.0f, 0.25f } });
+	CHECK(grid.GetCellSize() == 1.0f);
+	CHECK(GetCandidates(grid, 0.0f, 0.0f) == std::vector<std::uint32_t>{ 0 });
+	CHECK(grid.GetIndices().size() == 1);
+}
+
+// Grass vertices anywhere around a crowd of actors, every collider reaching a vertex is among its cell's candidates
+TEST_CASE(NeverMissesAReachingSphere)
+{
+	std::mt19937 random{ 5 };
+	std::uniform_real_distribution<float> position{ -2000.0f, 2000.0f };
+	std::uniform_real_distribution<float> radius{ 5.0f, 150.0f };
+
+	CollisionGrid grid;
+	for (int round = 0; round < 20; round++) {
+		std::vector<CollisionGrid::Sphere> spheres(1 + random() % 128);
+		for (auto& sphere : spheres)
+			sphere = { position(random) * (round % 4 + 1) / 4.0f, position(random) / (round % 3 + 1), radius(random) };
+		grid.Build(spheres);
+		REQUIRE(IsPacked(grid, spheres.size()));
+
+		std::size_t tested = 0;
+		std::size_t candidates = 0;
+		bool complete = true;
+		for (int i = 0; i < 2000; i++) {
+			// half the samples next to a sphere so most of them are reached by something
+			float x = position(random);
+			float y = position(random);
+			if (i % 2) {
+				auto& sphere = spheres[random() % spheres.size()];
+				x = sphere.x + (position(random) / 2000.0f) * sphere.radius;
+				y = sphere.y + (position(random) / 2000.0f) * sphere.radius;
+			}
+			auto cellCandidates = GetCandidates(grid, x, y);
+			candidates += cellCandidates.size();
+			for (std::uint32_t index = 0; index < spheres.size(); index++) {
+				if (Reaches(spheres[index], x, y)) {
+					tested++;
+					complete = complete && std::find(cellCandidates.begin(), cellCandidates.end(), index) != cellCandidates.end();
+				}
+			}
+		}
+		CHECK(complete);
+		CHECK(tested > 0);
+		// the point of the grid: far fewer candidates than testing every sphere
+		CHECK(candidates < spheres.size() * 2000 / 2 || spheres.size() < 8);
+	}
+}
+
+TEST_CASE(RebuildForgetsPreviousSpheres)
+{
+	CollisionGrid grid;
+	std::vector<CollisionGrid::Sphere> crowd;
+	for (int i = 0; i < 64; i++)
+		crowd.push_back({ 0.0f, 0.0f, 50.0f });
+	grid.Build(crowd);
+	CHECK(grid.GetMaxCellCount() == 64);
+
+	grid.Build({ { 0.0f, 0.0f, 50.0f } });
+	CHECK(grid.GetMaxCellCount() == 1);
+	CHECK(IsPacked(grid, 1));
+}
@@ -0,0 +1,53 @@
+#include "Features/GrassCollision/CollisionPacking.h"
+#include "Test.h"
+
+#include <cmath>
+
+namespace
+{
+	bool Near(float a_value, float a_expected)
+	{
+		return std::abs(a_value - a_expected) < 1e-4f;
+	}
+}
+
+TEST_CASE(MovesWithTheGatheredVelocity)
+{
+	CollisionPacking::Bounds bounds{ { 10.0f, 20.0f, 30.0f }, {}, 5.0f };
+	CollisionPacking::Move(bounds, { 13.0f, 20.0f, 24.0f }, 0.5f);
+	CHECK(Near(bounds.velocity.x, 6.0f) && Near(bounds.velocity.y, 0.0f) && Near(bounds.velocity.z, -12.0f));
+	CHECK(bounds.centre.x == 13.0f && bounds.centre.z == 24.0f);
+
+	// the first gather of an actor has nothing to compare with
+	CollisionPacking::Move(bounds, { 100.0f, 0.0f, 0.0f }, 0.0f);
+	CHECK(bounds.velocity.x == 0.0f && bounds.velocity.y == 0.0f && bounds.velocity.z == 0.0f);
+	CHECK(bounds.centre.x == 100.0f);
+}
+
+TEST_CASE(PacksRelativeToEachEye)
+{
+	std::vector<CollisionPacking::Bounds> bounds{
+		{ { 100.0f, 200.0f, 50.0f }, { 10.0f, 0.0f, 0.0f }, 4.0f },
+		{ { -50.0f, 0.0f, 0.0f }, {}, 8.0f },
+	};
+	std::vector<const CollisionPacking::Bounds*> pointers{ &bounds[1], &bounds[0] };
+	const CollisionPacking::Vector3 eyes[2]{ { 1.0f, 2.0f, 3.0f }, { 5.0f, 2.0f, 3.0f } };
+
+	std::vector<CollisionPacking::Sphere> spheres;
+	std::vector<CollisionGrid::Sphere> gridSpheres;
+	CollisionPacking::Pack(pointers, eyes, 2, 0.5f, 2.0f, spheres, gridSpheres);
+	REQUIRE(spheres.size() == 2 && gridSpheres.size() == 2);
+
+	// in the order of the pointers, extrapolated by half a second and with the radius multiplier applied
+	CHECK(Near(spheres[0].centre[0].x, -51.0f) && Near(spheres[0].centre[1].x, -55.0f) && Near(spheres[0].radius, 16.0f));
+	CHECK(Near(spheres[1].centre[0].x, 104.0f) && Near(spheres[1].centre[0].y, 198.0f) && Near(spheres[1].centre[0].z, 47.0f));
+	CHECK(Near(spheres[1].centre[1].x, 100.0f));
+	CHECK(Near(gridSpheres[1].x, 105.0f) && Near(gridSpheres[1].y, 200.0f) && Near(gridSpheres[1].radius, 8.0f));
+
+	// a single eye leaves the second centre zeroed, as the shader never reads it
+	CollisionPacking::Pack(pointers, eyes, 1, 0.0f, 1.0f, spheres, gridSpheres);
+	CHECK(spheres[1].centre[1].x == 0.0f && Near(spheres[1].centre[0].x, 99.0f));
+
+	CollisionPacking::Pack({}, eyes, 1, 0.0f, 1.0f, spheres, gridSpheres);
+	CHECK(spheres.empty() && gridSpheres.empty());
+}
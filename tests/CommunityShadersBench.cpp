@@ -0,0 +1,46 @@
+// Runs the benchmark cases that need no game data on the build machine and prints them in the google-benchmark JSON layout,
+// the in-game benchmark from the Debug section of the menu adds the cases for the loaded shaders and particle light configs.
+//
+//   CommunityShadersBench [--min-time <milliseconds>] [--out <path>]
+
+#include "ModelBenchmarks.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+int main(int a_argc, char** a_argv)
+{
+	auto minTime = std::chrono::milliseconds(100);
+	const char* outPath = nullptr;
+	for (int i = 1; i < a_argc; i++) {
+		if (std::strcmp(a_argv[i], "--min-time") == 0 && i + 1 < a_argc) {
+			minTime = std::chrono::milliseconds(std::strtoul(a_argv[++i], nullptr, 10));
+		} else if (std::strcmp(a_argv[i], "--out") == 0 && i + 1 < a_argc) {
+			outPath = a_argv[++i];
+		} else {
+			std::fprintf(stderr, "usage: CommunityShadersBench [--min-time <milliseconds>] [--out <path>]\n");
+			return 2;
+		}
+	}
+
+	BenchmarkSuite suite;
+	ModelBenchmarks::Add(suite);
+	auto results = suite.Run(minTime);
+	for (auto& result : results)
+		std::fprintf(stderr, "%-36s %12.1f ns %12llu iterations\n", result.name.c_str(), result.nanoseconds, (unsigned long long)result.iterations);
+
+	auto json = BenchmarkSuite::ToJson(results, "host");
+	if (outPath) {
+		std::ofstream file{ outPath };
+		file << json;
+		if (!file) {
+			std::fprintf(stderr, "cannot write %s\n", outPath);
+			return 1;
+		}
+	} else {
+		std::fputs(json.c_str(), stdout);
+	}
+	return 0;
+}
@@ -0,0 +1,140 @@
+#include "CompileCostModel.h"
+#include "Test.h"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace
+{
+	// A group of permutations sharing a cost key, compiled in a lognormal time around its mean like real compiles
+	struct Group
+	{
+		std::uint64_t key;
+		double meanMs;
+	};
+
+	const std::vector<Group>& GetGroups()
+	{
+		static const std::vector<Group> groups{
+			{ CompileCostModel::MakeKey(0, 1, 0, 4), 40.0 },     // vertex lighting, few defines
+			{ CompileCostModel::MakeKey(1, 1, 0, 4), 180.0 },    // pixel lighting, few defines
+			{ CompileCostModel::MakeKey(1, 1, 0, 24), 900.0 },   // pixel lighting, many defines
+			{ CompileCostModel::MakeKey(1, 1, 3, 12), 450.0 },   // pixel lighting, another technique
+			{ CompileCostModel::MakeKey(1, 5, 0, 8), 120.0 },    // pixel water
+			{ CompileCostModel::MakeKey(2, 9, 0, 0), 2500.0 },   // compute, rare and slow
+		};
+		return groups;
+	}
+
+	double Sample(std::mt19937& a_random, double a_meanMs)
+	{
+		// mean of a lognormal is exp(mu + sigma^2 / 2)
+		constexpr double Sigma = 0.25;
+		std::lognormal_distribution<double> distribution{ std::log(a_meanMs) - Sigma * Sigma / 2.0, Sigma };
+		return distribution(a_random);
+	}
+
+	bool Within(double a_value, double a_expected, double a_tolerance)
+	{
+		return std::abs(a_value - a_expected) <= a_expected * a_tolerance;
+	}
+}
+
+TEST_CASE(BucketsDefineCounts)
+{
+	CHECK(CompileCostModel::MakeKey(1, 2, 3, 0) == CompileCostModel::MakeKey(1, 2, 3, CompileCostModel::DEFINE_BUCKET_SIZE - 1));
+	CHECK(CompileCostModel::MakeKey(1, 2, 3, 0) != CompileCostModel::MakeKey(1, 2, 3, CompileCostModel::DEFINE_BUCKET_SIZE));
+	CHECK(CompileCostModel::MakeKey(1, 2, 3, 100000) == CompileCostModel::MakeKey(1, 2, 3, 0xFF * CompileCostModel::DEFINE_BUCKET_SIZE));
+	CHECK(CompileCostModel::MakeKey(1, 2, 3, 0) != CompileCostModel::MakeKey(1, 2, 4, 0));
+}
+
+TEST_CASE(FallsBackToTypeThenTotal)
+{
+	CompileCostModel model;
+	CHECK(model.IsEmpty());
+	CHECK(model.Predict(CompileCostModel::MakeKey(1, 1, 0, 0)) == CompileCostModel::DEFAULT_COST_MS);
+
+	model.Record(CompileCostModel::MakeKey(1, 1, 0, 0), 100.0);
+	model.Record(CompileCostModel::MakeKey(1, 1, 2, 8), 300.0);
+	model.Record(CompileCostModel::MakeKey(0, 4, 0, 0), 20.0);
+
+	// same class and type: average of that type, otherwise of every shader
+	CHECK(model.Predict(CompileCostModel::MakeKey(1, 1, 0, 0)) == 100.0);
+	CHECK(Within(model.Predict(CompileCostModel::MakeKey(1, 1, 7, 40)), 200.0, 1e-9));
+	CHECK(Within(model.Predict(CompileCostModel::MakeKey(2, 9, 0, 0)), 140.0, 1e-9));
+}
+
+// A cold startup backlog: the groups' costs are learned from the compiles and predict the same backlog the next time
+TEST_CASE(LearnsASyntheticBacklog)
+{
+	std::mt19937 random{ 7 };
+	CompileCostModel model;
+	double actualMs = 0.0;
+	for (int i = 0; i < 3000; i++) {
+		auto& group = GetGroups()[random() % GetGroups().size()];
+		auto ms = Sample(random, group.meanMs);
+		model.Record(group.key, ms);
+		actualMs += ms;
+	}
+	CHECK(model.GetRecordedSamples() == 3000);
+
+	// the last MAX_AVERAGED samples dominate, a lognormal with sigma 0.25 keeps their mean within 15%
+	for (auto& group : GetGroups())
+		CHECK(Within(model.Predict(group.key), group.meanMs, 0.15));
+
+	// the ETA of the next backlog of the same mix is close to what it takes
+	std::mt19937 next{ 11 };
+	double predictedMs = 0.0;
+	double nextMs = 0.0;
+	for (int i = 0; i < 3000; i++) {
+		auto& group = GetGroups()[next() % GetGroups().size()];
+		predictedMs += model.Predict(group.key);
+		nextMs += Sample(next, group.meanMs);
+	}
+	CHECK(Within(predictedMs, nextMs, 0.1));
+	CHECK(Within(nextMs, actualMs, 0.1));
+}
+
+TEST_CASE(FollowsSourceChanges)
+{
+	auto key = CompileCostModel::MakeKey(1, 1, 0, 4);
+	CompileCostModel model;
+	for (int i = 0; i < 500; i++)
+		model.Record(key, 100.0);
+	CHECK(Within(model.Predict(key), 100.0, 1e-9));
+
+	// a shader edit doubles the cost, the capped average converges within a few MAX_AVERAGED samples
+	for (std::uint64_t i = 0; i < 3 * CompileCostModel::MAX_AVERAGED; i++)
+		model.Record(key, 200.0);
+	CHECK(Within(model.Predict(key), 200.0, 0.1));
+	CHECK(model.GetEntries().at(key).count == CompileCostModel::MAX_AVERAGED);
+}
+
+// The next startup loads the saved entries and predicts as the session that saved them, before compiling anything
+TEST_CASE(RestoresSavedEntries)
+{
+	std::mt19937 random{ 3 };
+	CompileCostModel saved;
+	for (int i = 0; i < 2000; i++) {
+		auto& group = GetGroups()[random() % GetGroups().size()];
+		saved.Record(group.key, Sample(random, group.meanMs));
+	}
+
+	CompileCostModel loaded;
+	for (auto& [key, entry] : saved.GetEntries())
+		loaded.SetEntry(key, entry);
+	loaded.SetEntry(CompileCostModel::MakeKey(3, 3, 3, 3), {});  // empty entries are skipped
+
+	CHECK(loaded.GetRecordedSamples() == 0);
+	CHECK(loaded.GetEntries().size() == GetGroups().size());
+	for (auto& group : GetGroups())
+		CHECK(loaded.Predict(group.key) == saved.Predict(group.key));
+
+	// an unseen define bucket of pixel lighting falls back to the loaded pixel lighting groups, not the default
+	auto unseen = loaded.Predict(CompileCostModel::MakeKey(1, 1, 0, 60));
+	CHECK(unseen > 180.0 * 0.8 && unseen < 900.0 * 1.2);
+
+	loaded.Record(GetGroups()[0].key, 40.0);
+	CHECK(loaded.GetRecordedSamples() == 1);
+}
@@ -0,0 +1,119 @@
+#include "Features/DynamicCubemaps/CubemapFilterSchedule.h"
+#include "Test.h"
+
+#include <array>
+
+namespace
+{
+	// Runs a pass to the end, returning the frames it took and whether every face of every mip was filtered once
+	bool RunPass(CubemapFilterSchedule& a_schedule, std::uint32_t a_size, std::uint32_t a_mipLevels, std::uint64_t a_budget, std::uint32_t& a_frames)
+	{
+		std::vector<std::array<std::uint32_t, CubemapFilterSchedule::FACES>> filtered(a_mipLevels);
+		a_schedule.Begin(a_size, a_mipLevels);
+		a_frames = 0;
+		bool valid = true;
+		while (a_schedule.IsActive()) {
+			auto dispatches = a_schedule.Next(a_budget);
+			valid = valid && !dispatches.empty();
+			std::uint64_t spent = 0;
+			for (auto& dispatch : dispatches) {
+				valid = valid && dispatch.mip > 0 && dispatch.mip < a_mipLevels && dispatch.size == std::max(a_size >> dispatch.mip, 1u);
+				valid = valid && dispatch.faceCount > 0 && dispatch.firstFace + dispatch.faceCount <= CubemapFilterSchedule::FACES;
+				for (auto face = dispatch.firstFace; valid && face < dispatch.firstFace + dispatch.faceCount; face++)
+					filtered[dispatch.mip][face]++;
+				spent += (std::uint64_t)dispatch.size * dispatch.size * dispatch.faceCount;
+			}
+			// over budget only with a single face that is larger than it
+			auto& first = dispatches.front();
+			valid = valid && (spent <= a_budget || (dispatches.size() == 1 && first.faceCount == 1));
+			a_frames++;
+		}
+		for (std::uint32_t mip = 1; mip < a_mipLevels; mip++)
+			for (auto count : filtered[mip])
+				valid = valid && count == 1;
+		return valid;
+	}
+}
+
+TEST_CASE(SplitsMipsIntoFaces)
+{
+	CubemapFilterSchedule schedule;
+	schedule.Begin(128, 8);
+	CHECK(schedule.IsActive());
+
+	// mips 1 to 7: 64^2 + 32^2 + ... + 1^2 texels on each of the six faces
+	std::uint64_t perFace = 0;
+	for (std::uint32_t size = 64; size; size /= 2)
+		perFace += (std::uint64_t)size * size;
+	CHECK(schedule.GetTotalCost() == perFace * CubemapFilterSchedule::FACES);
+
+	// an unlimited budget filters everything in one frame, one dispatch per mip
+	auto dispatches = schedule.Next(schedule.GetTotalCost());
+	REQUIRE(dispatches.size() == 7);
+	CHECK(dispatches[0].mip == 1 && dispatches[0].size == 64 && dispatches[0].firstFace == 0 && dispatches[0].faceCount == 6);
+	CHECK(dispatches[6].mip == 7 && dispatches[6].size == 1);
+	CHECK(!schedule.IsActive());
+	CHECK(schedule.Next(schedule.GetTotalCost()).empty());
+}
+
+TEST_CASE(KeepsFacesWithinTheBudget)
+{
+	CubemapFilterSchedule schedule;
+	schedule.Begin(128, 8);
+
+	// a single mip 1 face per frame, mip 1 takes six frames and the smaller mips share the next two
+	auto budget = 64ull * 64ull;
+	for (std::uint32_t face = 0; face < 6; face++) {
+		auto dispatches = schedule.Next(budget);
+		REQUIRE(dispatches.size() == 1);
+		CHECK(dispatches[0].mip == 1 && dispatches[0].firstFace == face && dispatches[0].faceCount == 1);
+	}
+	auto seventh = schedule.Next(budget);
+	REQUIRE(seventh.size() == 1);
+	CHECK(seventh[0].mip == 2 && seventh[0].firstFace == 0 && seventh[0].faceCount == 4);
+
+	// the rest of mip 2 and all of mips 3 to 7 are 4094 texels
+	auto last = schedule.Next(budget);
+	REQUIRE(last.size() == 6);
+	CHECK(last[0].mip == 2 && last[0].firstFace == 4 && last[0].faceCount == 2);
+	CHECK(last[5].mip == 7 && last[5].faceCount == 6);
+	CHECK(!schedule.IsActive());
+}
+
+TEST_CASE(AlwaysMakesProgress)
+{
+	CubemapFilterSchedule schedule;
+	schedule.Begin(256, 9);
+	auto dispatches = schedule.Next(0);
+	REQUIRE(dispatches.size() == 1);
+	CHECK(dispatches[0].mip == 1 && dispatches[0].faceCount == 1);
+
+	std::uint32_t frames = 0;
+	CHECK(RunPass(schedule, 256, 9, 0, frames));
+	CHECK(frames == 8 * CubemapFilterSchedule::FACES);
+}
+
+// Every budget the settings slider can produce filters each face once and finishes within the bound shown in the menu
+TEST_CASE(FinishesWithinTheFrameBound)
+{
+	CubemapFilterSchedule schedule;
+	for (std::uint32_t size : { 1u, 7u, 64u, 128u, 512u }) {
+		for (std::uint32_t mipLevels : { 1u, 2u, 8u, 10u }) {
+			schedule.Begin(size, mipLevels);
+			auto total = schedule.GetTotalCost();
+			for (std::uint32_t percent = 1; percent <= 100; percent += 3) {
+				auto budget = total * percent / 100;
+				schedule.Begin(size, mipLevels);
+				auto bound = schedule.GetFrameBound(budget);
+				std::uint32_t frames = 0;
+				CHECK(RunPass(schedule, size, mipLevels, budget, frames));
+				CHECK(frames == bound);
+			}
+		}
+	}
+
+	// a cubemap without mips below the top level has nothing to prefilter
+	schedule.Begin(128, 1);
+	CHECK(!schedule.IsActive());
+	CHECK(schedule.GetFrameBound(1) == 0);
+}
@@ -0,0 +1,118 @@
+#include "FrameCapture.h"
+#include "Test.h"
+
+#include <thread>
+
+namespace
+{
+	std::filesystem::path GetCapturePath(const char* a_name)
+	{
+		return std::filesystem::temp_directory_path() / "CommunityShadersTests" / a_name;
+	}
+
+	struct Payload
+	{
+		std::uint32_t thread;
+		std::uint32_t sequence;
+		float value;
+	};
+}
+
+TEST_CASE(RoundTripsFrames)
+{
+	auto path = GetCapturePath("RoundTrip.bin");
+	FrameCapture::Writer writer;
+	REQUIRE(writer.Start(path, 3));
+	CHECK(!writer.Start(path, 3));
+
+	// dropped, no frame has begun yet
+	writer.Write(FrameCapture::RecordType::WetnessInput, 1.0f);
+
+	for (std::uint64_t frame = 10; frame < 20; frame++) {
+		writer.BeginFrame(frame);
+		writer.Write(FrameCapture::RecordType::ShadowCamera, Payload{ 0, (std::uint32_t)frame, 0.5f });
+		writer.WriteArray(FrameCapture::RecordType::CollisionSpheres, std::vector<float>(frame - 10, 2.0f));
+	}
+	CHECK(!writer.IsCapturing());
+	CHECK(writer.GetCapturedFrames() == 3);
+
+	FrameCapture::Reader reader;
+	REQUIRE(reader.Open(path));
+	std::uint64_t frameIndex = 0;
+	std::vector<FrameCapture::Record> records;
+	for (std::uint64_t frame = 10; frame < 13; frame++) {
+		REQUIRE(reader.NextFrame(frameIndex, records));
+		CHECK(frameIndex == frame);
+		REQUIRE(records.size() == 2);
+
+		Payload payload{};
+		CHECK(records[0].type == FrameCapture::RecordType::ShadowCamera);
+		CHECK(records[0].Get(payload) && payload.sequence == frame && payload.value == 0.5f);
+
+		std::vector<float> values;
+		CHECK(records[1].type == FrameCapture::RecordType::CollisionSpheres);
+		CHECK(records[1].GetArray(values) && values.size() == frame - 10);
+		CHECK(!records[1].Get(payload));
+	}
+	CHECK(!reader.NextFrame(frameIndex, records));
+	CHECK(std::filesystem::file_size(path) == writer.GetCapturedBytes());
+}
+
+TEST_CASE(RefusesForeignFiles)
+{
+	auto path = GetCapturePath("Foreign.bin");
+	{
+		std::ofstream file{ path, std::ios::binary | std::ios::trunc };
+		file << "not a capture";
+	}
+	FrameCapture::Reader reader;
+	CHECK(!reader.Open(path));
+	CHECK(!reader.Open(GetCapturePath("Missing.bin")));
+}
+
+// Features write from the render thread and worker threads while the frame loop begins frames and the menu polls
+TEST_CASE(WritesFromSeveralThreads)
+{
+	constexpr std::uint32_t Threads = 4;
+	constexpr std::uint32_t Frames = 50;
+
+	auto path = GetCapturePath("Threads.bin");
+	FrameCapture::Writer writer;
+	REQUIRE(writer.Start(path, Frames));
+	writer.BeginFrame(0);
+
+	std::vector<std::jthread> threads;
+	for (std::uint32_t thread = 0; thread < Threads; thread++) {
+		threads.emplace_back([&writer, thread] {
+			for (std::uint32_t sequence = 0; writer.IsCapturing(); sequence++)
+				writer.Write(FrameCapture::RecordType::WetnessInput, Payload{ thread, sequence, 1.0f });
+		});
+	}
+	for (std::uint64_t frame = 1; writer.IsCapturing(); frame++) {
+		writer.BeginFrame(frame);
+		std::this_thread::yield();
+	}
+	threads.clear();
+	CHECK(writer.GetCapturedFrames() == Frames);
+
+	// every record is complete and each thread's records stay in order
+	FrameCapture::Reader reader;
+	REQUIRE(reader.Open(path));
+	std::uint64_t frameIndex = 0;
+	std::vector<FrameCapture::Record> records;
+	std::vector<std::int64_t> lastSequence(Threads, -1);
+	std::uint32_t frames = 0;
+	bool ordered = true;
+	while (reader.NextFrame(frameIndex, records)) {
+		CHECK(frameIndex == frames);
+		for (auto& record : records) {
+			Payload payload{};
+			REQUIRE(record.Get(payload) && payload.thread < Threads);
+			ordered = ordered && (std::int64_t)payload.sequence > lastSequence[payload.thread];
+			lastSequence[payload.thread] = payload.sequence;
+		}
+		frames++;
+	}
+	CHECK(ordered);
+	CHECK(frames == Frames);
+}
@@ -0,0 +1,314 @@
+// Replays a frame capture through the feature models and prints one CSV line per frame, followed by the buffer updates
+// and dispatches the frames would have issued and the CPU time spent in every model.
+// Captures are written from the Debug section of the menu to Data\SKSE\Plugins\CommunityShaders\FrameCapture.bin.
+//
+//   FrameReplay <capture>                         replays a capture
+//   FrameReplay --synthetic <frames> <capture>    writes a synthetic capture of a walk through rain first, then replays it
+//
+// The mock render context stands in for the D3D11 context: it only tracks the sizes of the structured buffers the
+// features keep, when they would be recreated, and the dispatches, so the replay needs no GPU.
+
+#include "FrameCapture.h"
+
+#include "Features/GrassCollision/CollisionGrid.h"
+#include "Features/GrassCollision/CollisionPacking.h"
+#include "Features/LightLimitFIx/LightGathering.h"
+#include "Features/ScreenSpaceShadows/ShadowHistory.h"
+#include "Features/WetnessEffects/WetnessModel.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+
+namespace
+{
+	// sizes of the GPU structs the features upload, they are not std-only so are not included here
+	constexpr std::uint32_t LightDataStride = 68;      // LightLimitFix::LightData
+	constexpr std::uint32_t CollisionDataStride = sizeof(CollisionPacking::Sphere);
+
+	class MockRenderContext
+	{
+	public:
+		enum class Resize
+		{
+			OnChange,  // recreated whenever the element count changes, as the light and collision buffers
+			OnGrow,    // recreated only when it has to grow, as the collision grid buffers
+		};
+
+		// Map with WRITE_DISCARD of a dynamic structured buffer of a_count elements, at least one element is kept
+		void UpdateBuffer(const std::string& a_name, std::uint32_t a_stride, std::uint32_t a_count, Resize a_resize)
+		{
+			auto& buffer = buffers[a_name];
+			auto count = std::max(a_count, 1u);
+			if (!buffer.capacity || (a_resize == Resize::OnChange ? count != buffer.capacity : count > buffer.capacity)) {
+				buffer.capacity = count;
+				buffer.creations++;
+			}
+			buffer.updates++;
+			buffer.bytes += (std::uint64_t)a_stride * count;
+			buffer.maxCount = std::max(buffer.maxCount, a_count);
+		}
+
+		void Dispatch(const std::string& a_name, std::uint32_t a_x, std::uint32_t a_y, std::uint32_t a_z)
+		{
+			auto& dispatch = dispatches[a_name];
+			dispatch.count++;
+			dispatch.groups += (std::uint64_t)a_x * a_y * a_z;
+		}
+
+		void Print() const
+		{
+			std::printf("buffer,updates,creations,bytes,max elements\n");
+			for (auto& [name, buffer] : buffers)
+				std::printf("%s,%llu,%llu,%llu,%u\n", name.c_str(), (unsigned long long)buffer.updates, (unsigned long long)buffer.creations, (unsigned long long)buffer.bytes, buffer.maxCount);
+			std::printf("dispatch,count,groups\n");
+			for (auto& [name, dispatch] : dispatches)
+				std::printf("%s,%llu,%llu\n", name.c_str(), (unsigned long long)dispatch.count, (unsigned long long)dispatch.groups);
+		}
+
+	private:
+		struct Buffer
+		{
+			std::uint32_t capacity = 0;
+			std::uint32_t maxCount = 0;
+			std::uint64_t updates = 0;
+			std::uint64_t creations = 0;
+			std::uint64_t bytes = 0;
+		};
+
+		struct DispatchStats
+		{
+			std::uint64_t count = 0;
+			std::uint64_t groups = 0;
+		};
+
+		std::map<std::string, Buffer> buffers;
+		std::map<std::string, DispatchStats> dispatches;
+	};
+
+	class Replay
+	{
+	public:
+		bool Frame(const std::vector<FrameCapture::Record>& a_records)
+		{
+			bool hasLights = false;
+			for (auto& record : a_records) {
+				bool valid = true;
+				switch (record.type) {
+				case FrameCapture::RecordType::WetnessInput:
+					{
+						WetnessModel::Input input{};
+						valid = record.Get(input);
+						Time(wetnessTime, [&] { wetness.Update(input); });
+						break;
+					}
+				case FrameCapture::RecordType::CollisionSpheres:
+					valid = record.GetArray(spheres);
+					Time(collisionTime, [&] { collisionGrid.Build(spheres); });
+					context.UpdateBuffer("GrassCollision/Collisions", CollisionDataStride, (std::uint32_t)spheres.size(), MockRenderContext::Resize::OnChange);
+					context.UpdateBuffer("GrassCollision/GridCells", sizeof(CollisionGrid::CellRange), (std::uint32_t)collisionGrid.GetCells().size(), MockRenderContext::Resize::OnGrow);
+					context.UpdateBuffer("GrassCollision/GridIndices", sizeof(std::uint32_t), (std::uint32_t)collisionGrid.GetIndices().size(), MockRenderContext::Resize::OnGrow);
+					break;
+				case FrameCapture::RecordType::ShadowCamera:
+					{
+						ShadowHistory::Tracker::Camera camera{};
+						valid = record.Get(camera) && camera.scale;
+						if (!valid)
+							break;
+						Time(shadowTime, [&] { historyWeight = shadowHistory.Update(camera); });
+						context.Dispatch("ScreenSpaceShadows/Raymarch", ShadowHistory::GetDispatchSize((float)camera.width, camera.scale, 32), ShadowHistory::GetDispatchSize((float)camera.height, camera.scale, 32), 1);
+						break;
+					}
+				case FrameCapture::RecordType::LightCamera:
+					valid = record.Get(lightCamera);
+					hasLights = true;
+					break;
+				case FrameCapture::RecordType::LightSettings:
+					valid = record.Get(lightSettings);
+					break;
+				case FrameCapture::RecordType::PointLights:
+					valid = record.GetArray(pointLights);
+					break;
+				case FrameCapture::RecordType::ParticleLights:
+					valid = record.GetArray(particleLights);
+					break;
+				default:
+					break;
+				}
+				if (!valid) {
+					std::fprintf(stderr, "record of type %u has an unexpected size of %zu bytes\n", (unsigned)record.type, record.data.size());
+					return false;
+				}
+			}
+
+			lights.clear();
+			if (hasLights)
+				GatherLights();
+
+			std::printf("%llu,%.4f,%.4f,%zu,%u,%.3f,%zu,%zu\n", (unsigned long long)frameIndex, wetness.GetWetness(), wetness.GetPuddleWetness(),
+				spheres.size(), collisionGrid.GetMaxCellCount(), historyWeight, pointLights.size() + particleLights.size(), lights.size());
+			return true;
+		}
+
+		void Print() const
+		{
+			context.Print();
+			std::printf("model,milliseconds\n");
+			std::printf("WetnessModel,%.3f\n", wetnessTime * 1e3);
+			std::printf("CollisionGrid,%.3f\n", collisionTime * 1e3);
+			std::printf("ShadowHistory,%.3f\n", shadowTime * 1e3);
+			std::printf("LightGathering,%.3f\n", lightTime * 1e3);
+		}
+
+		std::uint64_t frameIndex = 0;
+
+	private:
+		template <class Function>
+		static void Time(double& a_total, Function a_function)
+		{
+			auto start = std::chrono::steady_clock::now();
+			a_function();
+			a_total += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		}
+
+		// Same uploads and dispatches as LightLimitFix::UpdateLights, the clusters are only rebuilt when the light range changes
+		void GatherLights()
+		{
+			Time(lightTime, [&] { LightGathering::Gather(lightCamera, lightSettings, pointLights, particleLights, lights); });
+			context.UpdateBuffer("LightLimitFix/Lights", LightDataStride, (std::uint32_t)lights.size(), MockRenderContext::Resize::OnChange);
+			if (!clustersBuilt || lightCamera.lightsNear != lightsNear || lightCamera.lightsFar != lightsFar) {
+				context.Dispatch("LightLimitFix/ClusterBuilding", 16, 16, 16);
+				clustersBuilt = true;
+				lightsNear = lightCamera.lightsNear;
+				lightsFar = lightCamera.lightsFar;
+			}
+			context.Dispatch("LightLimitFix/ClusterCulling", 1, 1, 4);
+		}
+
+		MockRenderContext context;
+
+		WetnessModel wetness;
+		CollisionGrid collisionGrid;
+		std::vector<CollisionGrid::Sphere> spheres;
+		ShadowHistory::Tracker shadowHistory;
+		float historyWeight = 0.0f;
+
+		LightGathering::Camera lightCamera;
+		LightGathering::Settings lightSettings;
+		std::vector<LightGathering::PointLight> pointLights;
+		std::vector<LightGathering::ParticleLight> particleLights;
+		std::vector<LightGathering::Light> lights;
+		bool clustersBuilt = false;
+		float lightsNear = 0.0f;
+		float lightsFar = 0.0f;
+
+		double wetnessTime = 0.0;
+		double collisionTime = 0.0;
+		double shadowTime = 0.0;
+		double lightTime = 0.0;
+	};
+
+	// The player walks along x through a rainy evening, with eight colliders around them, lights along the road,
+	// a smoke column and a few torches. The camera turns around half way through.
+	bool WriteSynthetic(const char* a_path, std::uint32_t a_frames)
+	{
+		FrameCapture::Writer writer;
+		if (!writer.Start(a_path, a_frames))
+			return false;
+
+		WetnessModel::Weather rain{ 0x10A241, WetnessModel::Precipitation::Rainy, true, 0.2f, 0.2f };
+		for (std::uint32_t frame = 0; frame <= a_frames; frame++) {
+			writer.BeginFrame(frame);
+			if (!writer.IsCapturing())
+				break;
+
+			float t = (float)frame;
+			float playerX = t * 5.0f;
+
+			WetnessModel::Input input{};
+			input.active = true;
+			input.hasGameTime = true;
+			input.gameTime = 18.0f * 3600.0f + t * 60.0f;
+			input.currentWeather = rain;
+			input.currentWeatherPct = std::min(1.0f, t / 100.0f);
+			writer.Write(FrameCapture::RecordType::WetnessInput, input);
+
+			std::vector<CollisionGrid::Sphere> spheres;
+			for (int i = 0; i < 8; i++)
+				spheres.push_back({ playerX + 200.0f * std::cos(t * 0.05f + i), 200.0f * std::sin(t * 0.05f + i), 20.0f + i * 4.0f });
+			writer.WriteArray(FrameCapture::RecordType::CollisionSpheres, spheres);
+
+			float forward = frame < a_frames / 2 ? 1.0f : -1.0f;
+			ShadowHistory::Tracker::Camera shadowCamera{ { playerX, 0.0f, 120.0f }, { forward, 0.0f, 0.0f }, 1920, 1080, 2 };
+			writer.Write(FrameCapture::RecordType::ShadowCamera, shadowCamera);
+
+			LightGathering::Camera lightCamera{};
+			lightCamera.posAdjust[0] = { playerX, 0.0f, 120.0f };
+			lightCamera.lightsFar = frame < a_frames / 2 ? 16384.0f : 8192.0f;
+			lightCamera.lightFadeStart = 4000.0f * 4000.0f;
+			lightCamera.lightFadeEnd = 5000.0f * 5000.0f;
+			writer.Write(FrameCapture::RecordType::LightCamera, lightCamera);
+			writer.Write(FrameCapture::RecordType::LightSettings, LightGathering::Settings{});
+
+			std::vector<LightGathering::PointLight> pointLights;
+			for (int i = 0; i < 64; i++)
+				pointLights.push_back({ { i * 1000.0f, 500.0f, 300.0f }, 600.0f, { 1.0f, 0.8f, 0.6f }, 0 });
+			writer.WriteArray(FrameCapture::RecordType::PointLights, pointLights);
+
+			std::vector<LightGathering::ParticleLight> particleLights;
+			for (int i = 0; i < 200; i++)
+				particleLights.push_back({ { 2000.0f + (i % 5) * 8.0f, (i / 40) * 200.0f, 100.0f + i * 0.5f }, 30.0f, 1.0f, { 0.9f, 0.4f, 0.1f }, 0.5f, 0 });
+			for (int i = 0; i < 6; i++)
+				particleLights.push_back({ { 500.0f + i * 700.0f, -300.0f, 150.0f }, 4.0f, 1.0f, { 1.0f, 0.6f, 0.2f }, 1.0f, 1 });
+			writer.WriteArray(FrameCapture::RecordType::ParticleLights, particleLights);
+		}
+		writer.Stop();
+		return true;
+	}
+}
+
+int main(int a_argc, char** a_argv)
+{
+	const char* path = nullptr;
+	std::uint32_t syntheticFrames = 0;
+	if (a_argc == 2) {
+		path = a_argv[1];
+	} else if (a_argc == 4 && std::strcmp(a_argv[1], "--synthetic") == 0) {
+		syntheticFrames = (std::uint32_t)std::strtoul(a_argv[2], nullptr, 10);
+		path = a_argv[3];
+	} else {
+		std::fprintf(stderr, "usage: FrameReplay <capture>\n       FrameReplay --synthetic <frames> <capture>\n");
+		return 2;
+	}
+
+	if (syntheticFrames && !WriteSynthetic(path, syntheticFrames)) {
+		std::fprintf(stderr, "cannot write %s\n", path);
+		return 1;
+	}
+
+	FrameCapture::Reader reader;
+	if (!reader.Open(path)) {
+		std::fprintf(stderr, "%s is not a frame capture\n", path);
+		return 1;
+	}
+
+	Replay replay;
+	std::vector<FrameCapture::Record> records;
+	std::uint32_t frames = 0;
+	std::printf("frame,wetness,puddle wetness,colliders,max colliders per cell,shadow history weight,light inputs,lights\n");
+	while (reader.NextFrame(replay.frameIndex, records)) {
+		if (!replay.Frame(records))
+			return 1;
+		frames++;
+	}
+	replay.Print();
+
+	if (syntheticFrames && frames != syntheticFrames) {
+		std::fprintf(stderr, "replayed %u of %u frames\n", frames, syntheticFrames);
+		return 1;
+	}
+	return 0;
+}
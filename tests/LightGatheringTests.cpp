@@ -0,0 +1,139 @@
+#include "Features/LightLimitFIx/LightGathering.h"
+#include "Test.h"
+
+#include <cmath>
+
+namespace
+{
+	bool Near(float a_left, float a_right)
+	{
+		return std::abs(a_left - a_right) < 1e-3f;
+	}
+
+	// Fade between 500 and 1000 units, lights up to 2000 units
+	LightGathering::Camera MakeCamera()
+	{
+		LightGathering::Camera camera{};
+		camera.posAdjust[0] = { 100.0f, 200.0f, 0.0f };
+		camera.lightsFar = 2000.0f;
+		camera.lightFadeStart = 500.0f * 500.0f;
+		camera.lightFadeEnd = 1000.0f * 1000.0f;
+		return camera;
+	}
+
+	LightGathering::ParticleLight MakeParticle(float a_x, float a_radius)
+	{
+		return { { a_x, 200.0f, 0.0f }, a_radius, 1.0f, { 1.0f, 0.5f, 0.25f }, 1.0f, 0 };
+	}
+}
+
+TEST_CASE(KeepsSaturationOneAndGreysAtZero)
+{
+	LightGathering::Vector3 color{ 1.0f, 0.5f, 0.0f };
+	auto same = LightGathering::Saturation(color, 1.0f);
+	CHECK(same.x == 1.0f && same.y == 0.5f && same.z == 0.0f);
+
+	auto grey = LightGathering::Saturation(color, 0.0f);
+	CHECK(Near(grey.x, 0.595f) && Near(grey.y, 0.595f) && Near(grey.z, 0.595f));
+
+	// oversaturating never goes negative
+	CHECK(LightGathering::Saturation(color, 2.0f).z == 0.0f);
+}
+
+TEST_CASE(FadesPointLightsTowardsTheFarPlane)
+{
+	auto camera = MakeCamera();
+	std::vector<LightGathering::PointLight> pointLights{
+		{ { 100.0f, 200.0f, 0.0f }, 100.0f, { 1.0f, 1.0f, 1.0f }, 1 },
+		{ { 100.0f + 1500.0f, 200.0f, 0.0f }, 100.0f, { 1.0f, 1.0f, 1.0f }, 0 },
+		{ { 100.0f + 3000.0f, 200.0f, 0.0f }, 100.0f, { 1.0f, 1.0f, 1.0f }, 0 },
+		{ { 100.0f, 200.0f, 0.0f }, 0.0f, { 1.0f, 1.0f, 1.0f }, 0 },
+	};
+	std::vector<LightGathering::Light> lights;
+	LightGathering::Gather(camera, {}, pointLights, {}, lights);
+
+	// the point lights skip the game's fade, only the distant fade from 1/4 to all of lightsFar^2 applies
+	REQUIRE(lights.size() == 2);
+	CHECK(lights[0].source == LightGathering::Source::PointLight && lights[0].index == 0);
+	CHECK(lights[0].color.x == 1.0f && lights[0].firstPersonShadow == 1);
+	CHECK(lights[0].positionWS[0].x == 0.0f && lights[0].positionWS[0].y == 0.0f);
+
+	float distance = 1500.0f * 1500.0f - 100.0f * 100.0f;
+	float expected = 1.0f - (distance - 1000000.0f) / (4000000.0f - 1000000.0f);
+	CHECK(lights[1].index == 1 && Near(lights[1].color.y, expected));
+	CHECK(lights[1].positionWS[0].x == 1500.0f);
+}
+
+TEST_CASE(MergesNearbyMeshParticles)
+{
+	auto camera = MakeCamera();
+	std::vector<LightGathering::ParticleLight> particles;
+	for (int i = 0; i < 10; i++)
+		particles.push_back(MakeParticle(100.0f + i, 10.0f));
+	// too far from the running average, starts the next cluster
+	particles.push_back(MakeParticle(300.0f, 10.0f));
+
+	std::vector<LightGathering::Light> lights;
+	LightGathering::Gather(camera, {}, {}, particles, lights);
+	REQUIRE(lights.size() == 2);
+	CHECK(lights[0].source == LightGathering::Source::Cluster);
+	CHECK(Near(lights[0].color.x, 10.0f) && Near(lights[0].color.y, 5.0f));
+	CHECK(Near(lights[0].radius, 10.0f));
+	CHECK(Near(lights[0].positionWS[0].x, 4.5f));
+	CHECK(Near(lights[1].positionWS[0].x, 200.0f) && Near(lights[1].color.x, 1.0f));
+
+	LightGathering::Settings unmerged{};
+	unmerged.enableParticleLightsOptimization = 0;
+	lights.clear();
+	LightGathering::Gather(camera, unmerged, {}, particles, lights);
+	CHECK(lights.size() == particles.size());
+}
+
+TEST_CASE(EmitsBillboardsWithoutEndingTheCluster)
+{
+	auto camera = MakeCamera();
+	std::vector<LightGathering::ParticleLight> particles{ MakeParticle(100.0f, 10.0f), MakeParticle(101.0f, 10.0f), MakeParticle(102.0f, 10.0f) };
+	particles[1].billboard = 1;
+	particles[1].alpha = 0.5f;
+
+	LightGathering::Settings settings{};
+	settings.particleLightsRadiusBillboards = 2.0f;
+	std::vector<LightGathering::Light> lights;
+	LightGathering::Gather(camera, settings, {}, particles, lights);
+
+	REQUIRE(lights.size() == 2);
+	CHECK(lights[0].source == LightGathering::Source::Billboard && lights[0].index == 1);
+	CHECK(lights[0].radius == 20.0f && lights[0].color.x == 0.5f);
+	CHECK(lights[1].source == LightGathering::Source::Cluster && Near(lights[1].positionWS[0].x, 1.0f));
+}
+
+TEST_CASE(AppliesTheGameFadeToParticles)
+{
+	auto camera = MakeCamera();
+	std::vector<LightGathering::ParticleLight> particles{ MakeParticle(100.0f + 750.0f, 0.0f), MakeParticle(100.0f + 1200.0f, 0.0f) };
+	particles[0].radius = particles[1].radius = 1.0f;
+	particles[1].billboard = 1;
+
+	std::vector<LightGathering::Light> lights;
+	LightGathering::Gather(camera, {}, {}, particles, lights);
+
+	// half way through the game's fade, the second is past its end
+	REQUIRE(lights.size() == 1);
+	float distance = 750.0f * 750.0f - 1.0f;
+	CHECK(Near(lights[0].color.x, 1.0f - (distance - 250000.0f) / 750000.0f));
+}
+
+TEST_CASE(OffsetsTheSecondEyeOfClusters)
+{
+	auto camera = MakeCamera();
+	camera.eyeCount = 2;
+	camera.posAdjust[1] = { 94.0f, 200.0f, 0.0f };
+	std::vector<LightGathering::ParticleLight> particles{ MakeParticle(100.0f, 10.0f), MakeParticle(102.0f, 10.0f) };
+	std::vector<LightGathering::Light> lights;
+	LightGathering::Gather(camera, {}, {}, particles, lights);
+
+	// matches the plugin before the extraction, the eye offset is divided by the particle count
+	REQUIRE(lights.size() == 1);
+	CHECK(Near(lights[0].positionWS[0].x, 1.0f));
+	CHECK(Near(lights[0].positionWS[1].x, 1.0f + 6.0f / 2.0f));
+}
@@ -0,0 +1,221 @@
+#include "Features/LightLimitFIx/ParticleLightConfigs.h"
+#include "Test.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace
+{
+	struct Config
+	{
+		float radiusMult = 1.0f;
+		float colorMultRed = 1.0f;
+	};
+
+	struct GradientConfig
+	{
+		std::uint32_t color = 0;
+	};
+
+	constexpr int ConfigCount = 1000;
+	constexpr int GradientCount = 100;
+
+	void WriteFile(const std::filesystem::path& a_path, const std::string& a_contents)
+	{
+		std::filesystem::create_directories(a_path.parent_path());
+		std::ofstream file{ a_path, std::ios::binary | std::ios::trunc };
+		file << a_contents;
+	}
+
+	// Stands in for CSimpleIniA, only reads the keys the synthetic inis use
+	std::optional<Config> ParseConfig(const std::string& a_path)
+	{
+		std::ifstream file{ a_path };
+		if (!file)
+			return std::nullopt;
+		Config config;
+		std::string line;
+		while (std::getline(file, line)) {
+			if (line.starts_with("RadiusMult="))
+				config.radiusMult = std::stof(line.substr(11));
+			else if (line.starts_with("ColorMultRed="))
+				config.colorMultRed = std::stof(line.substr(13));
+			else if (line == "Broken")
+				return std::nullopt;
+		}
+		return config;
+	}
+
+	std::optional<GradientConfig> ParseGradientConfig(const std::string& a_path)
+	{
+		std::ifstream file{ a_path };
+		std::string line;
+		if (!std::getline(file, line) || !line.starts_with("Color=0x"))
+			return std::nullopt;
+		return GradientConfig{ (std::uint32_t)std::stoul(line.substr(8), nullptr, 16) };
+	}
+
+	// Like clib_util::distribution::get_configs: every ini below the directory, sorted by path
+	std::vector<std::string> GetConfigs(const std::filesystem::path& a_directory)
+	{
+		std::vector<std::string> paths;
+		for (auto& entry : std::filesystem::recursive_directory_iterator(a_directory))
+			if (entry.is_regular_file() && entry.path().extension() == ".ini")
+				paths.push_back(entry.path().string());
+		std::sort(paths.begin(), paths.end());
+		return paths;
+	}
+
+	// 1000 configs spread over effect packs with mixed case names, the last pack repeats ten stems of the first one.
+	// Every tenth config of the first pack sets ColorMultRed, one config does not parse.
+	std::filesystem::path MakeConfigDirectory(const char* a_name)
+	{
+		auto directory = std::filesystem::temp_directory_path() / "CommunityShadersTests" / a_name;
+		std::filesystem::remove_all(directory);
+		for (int i = 0; i < ConfigCount - 10; i++) {
+			std::ostringstream contents;
+			contents << "[Light]\nRadiusMult=" << (1.0f + i / 1000.0f) << "\n";
+			if (i % 10 == 0)
+				contents << "ColorMultRed=0.5\n";
+			if (i == 500)
+				contents << "Broken\n";
+			auto pack = "Pack" + std::to_string(i / 100);
+			WriteFile(directory / "ParticleLights" / pack / ("FXFire" + std::to_string(i) + ".ini"), contents.str());
+		}
+		for (int i = 0; i < 10; i++)
+			WriteFile(directory / "ParticleLights" / "ZOverrides" / ("fxfire" + std::to_string(i) + ".ini"), "[Light]\nRadiusMult=9\n");
+		for (int i = 0; i < GradientCount; i++) {
+			char color[16];
+			std::snprintf(color, sizeof(color), "0x%06X", i * 0x10101);
+			WriteFile(directory / "Gradients" / ("Gradient" + std::to_string(i) + ".ini"), std::string("Color=") + color + "\n");
+		}
+		return directory;
+	}
+
+	struct Loaded
+	{
+		ParticleLightConfigs::Map<Config> configs;
+		ParticleLightConfigs::Map<GradientConfig> gradientConfigs;
+		bool fromCache = false;
+	};
+
+	// Same steps as ParticleLights::GetConfigs
+	Loaded Load(const std::filesystem::path& a_directory)
+	{
+		auto configs = GetConfigs(a_directory / "ParticleLights");
+		auto gradientConfigs = GetConfigs(a_directory / "Gradients");
+		const std::vector<std::string>* lists[] = { &configs, &gradientConfigs };
+		auto key = ParticleLightConfigs::GetKey(lists);
+		auto cachePath = a_directory / "ParticleLights.bin";
+
+		Loaded loaded;
+		if (ParticleLightConfigs::ReadCache(cachePath, key, loaded.configs, loaded.gradientConfigs)) {
+			loaded.fromCache = true;
+			return loaded;
+		}
+
+		loaded.configs.insert({ "default", Config{} });
+		auto parsed = ParticleLightConfigs::ParseAll<Config>(configs, &ParseConfig);
+		CHECK(ParticleLightConfigs::Insert(loaded.configs, configs, parsed).empty());
+		auto parsedGradients = ParticleLightConfigs::ParseAll<GradientConfig>(gradientConfigs, &ParseGradientConfig);
+		CHECK(ParticleLightConfigs::Insert(loaded.gradientConfigs, gradientConfigs, parsedGradients).empty());
+		CHECK(ParticleLightConfigs::WriteCache(cachePath, key, loaded.configs, loaded.gradientConfigs));
+		return loaded;
+	}
+
+	bool Equal(const Loaded& a_left, const Loaded& a_right)
+	{
+		if (a_left.configs.size() != a_right.configs.size() || a_left.gradientConfigs.size() != a_right.gradientConfigs.size())
+			return false;
+		for (auto& [stem, config] : a_left.configs) {
+			auto other = a_right.configs.find(stem);
+			if (other == a_right.configs.end() || other->second.radiusMult != config.radiusMult || other->second.colorMultRed != config.colorMultRed)
+				return false;
+		}
+		for (auto& [stem, config] : a_left.gradientConfigs) {
+			auto other = a_right.gradientConfigs.find(stem);
+			if (other == a_right.gradientConfigs.end() || other->second.color != config.color)
+				return false;
+		}
+		return true;
+	}
+}
+
+TEST_CASE(GetsLowercaseStems)
+{
+	char buffer[ParticleLightConfigs::MAX_STEM];
+	CHECK(ParticleLightConfigs::GetStem("Effects\\FXFire01.dds", buffer) == "fxfire01");
+	CHECK(ParticleLightConfigs::GetStem("Data/ParticleLights/Pack/FXSmoke.ini", buffer) == "fxsmoke");
+	CHECK(ParticleLightConfigs::GetStem("NoDirectory.dds", buffer).empty());
+	CHECK(ParticleLightConfigs::GetStem("Effects\\.x", buffer).empty());
+
+	char small[4];
+	CHECK(ParticleLightConfigs::GetStem("Effects\\TooLong.dds", small).empty());
+}
+
+TEST_CASE(LoadsSyntheticDirectory)
+{
+	auto directory = MakeConfigDirectory("ParticleLightConfigs");
+
+	auto start = std::chrono::steady_clock::now();
+	auto parsed = Load(directory);
+	auto parseTime = std::chrono::steady_clock::now() - start;
+	REQUIRE(!parsed.fromCache);
+
+	// 990 stems of the packs, the broken one skipped, plus the default
+	CHECK(parsed.configs.size() == ConfigCount - 10 - 1 + 1);
+	CHECK(parsed.gradientConfigs.size() == GradientCount);
+	CHECK(!parsed.configs.contains("fxfire500"));
+	CHECK(parsed.configs.find(std::string_view("fxfire20"))->second.colorMultRed == 0.5f);
+	CHECK(parsed.gradientConfigs.at("gradient17").color == 17u * 0x10101);
+
+	// the first ini of a stem wins, the override pack sorts last
+	CHECK(std::abs(parsed.configs.at("fxfire3").radiusMult - 1.003f) < 1e-6f);
+	CHECK(parsed.configs.at("default").radiusMult == 1.0f);
+
+	start = std::chrono::steady_clock::now();
+	auto cached = Load(directory);
+	auto cacheTime = std::chrono::steady_clock::now() - start;
+	CHECK(cached.fromCache);
+	CHECK(Equal(parsed, cached));
+	CHECK(!std::filesystem::exists(directory / "ParticleLights.bin.tmp"));
+
+	std::printf("%d inis parsed in %.2f ms, loaded from the cache in %.2f ms\n", ConfigCount + GradientCount,
+		std::chrono::duration<double, std::milli>(parseTime).count(), std::chrono::duration<double, std::milli>(cacheTime).count());
+}
+
+TEST_CASE(EditedIniInvalidatesCache)
+{
+	auto directory = MakeConfigDirectory("ParticleLightConfigsEdit");
+	CHECK(!Load(directory).fromCache);
+	CHECK(Load(directory).fromCache);
+
+	WriteFile(directory / "ParticleLights" / "Pack4" / "FXFire400.ini", "[Light]\nRadiusMult=2.5\n");
+	auto edited = Load(directory);
+	CHECK(!edited.fromCache);
+	CHECK(edited.configs.at("fxfire400").radiusMult == 2.5f);
+
+	std::filesystem::remove(directory / "Gradients" / "Gradient5.ini");
+	auto removed = Load(directory);
+	CHECK(!removed.fromCache);
+	CHECK(!removed.gradientConfigs.contains("gradient5"));
+	CHECK(Load(directory).fromCache);
+}
+
+TEST_CASE(RefusesTruncatedCache)
+{
+	auto directory = MakeConfigDirectory("ParticleLightConfigsTruncated");
+	auto parsed = Load(directory);
+	auto cachePath = directory / "ParticleLights.bin";
+	auto contents = *ParticleLightConfigs::ReadFile(cachePath);
+
+	for (size_t size : { size_t{ 0 }, size_t{ 12 }, contents.size() / 2, contents.size() - 1 }) {
+		WriteFile(cachePath, contents.substr(0, size));
+		auto loaded = Load(directory);
+		CHECK(!loaded.fromCache);
+		CHECK(Equal(parsed, loaded));
+	}
+}
@@ -0,0 +1,126 @@
+#include "ReflectionRecordFile.h"
+#include "Test.h"
+
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+
+namespace
+{
+	ReflectionRecord MakeRecord(uint8_t a_seed)
+	{
+		ReflectionRecord record;
+		record.bufferSizes = { a_seed, uint32_t(a_seed) * 2, uint32_t(a_seed) * 3 };
+		record.constantCount = a_seed % 20;
+		for (uint8_t i = 0; i < record.constantCount; i++)
+			record.constantOffsets[i] = int8_t(i * 3 - a_seed % 7);
+		record.vertexDesc = 0x1234567800000000ull | a_seed;
+		return record;
+	}
+
+	bool Equal(const ReflectionRecord& a_left, const ReflectionRecord& a_right)
+	{
+		return a_left.bufferSizes == a_right.bufferSizes && a_left.constantCount == a_right.constantCount &&
+		       a_left.vertexDesc == a_right.vertexDesc &&
+		       std::equal(a_left.constantOffsets.begin(), a_left.constantOffsets.begin() + a_left.constantCount, a_right.constantOffsets.begin());
+	}
+
+	std::filesystem::path GetTempPath(const char* a_name)
+	{
+		auto directory = std::filesystem::temp_directory_path() / "CommunityShadersTests";
+		std::filesystem::create_directories(directory);
+		auto path = directory / a_name;
+		std::filesystem::remove(path);
+		return path;
+	}
+
+	using Records = std::unordered_map<uint64_t, ReflectionRecord>;
+
+	ReflectionRecordFile::ReadResult LoadAll(const std::filesystem::path& a_path, Records& a_records)
+	{
+		return ReflectionRecordFile::Load(a_path, [&](uint64_t a_hash, const ReflectionRecord& a_record) { a_records.insert_or_assign(a_hash, a_record); });
+	}
+}
+
+TEST_CASE(RoundTripsRecords)
+{
+	std::string data = ReflectionRecordFile::SerializeHeader();
+	for (uint8_t i = 0; i < 50; i++)
+		data += ReflectionRecordFile::Serialize(1000 + i, MakeRecord(i));
+
+	std::istringstream stream{ data };
+	Records records;
+	uint64_t validSize = 0;
+	auto result = ReflectionRecordFile::Read(
+		stream, [&](uint64_t a_hash, const ReflectionRecord& a_record) { records.emplace(a_hash, a_record); }, validSize);
+
+	CHECK(result == ReflectionRecordFile::ReadResult::Valid);
+	CHECK(validSize == data.size());
+	REQUIRE(records.size() == 50);
+	for (uint8_t i = 0; i < 50; i++)
+		CHECK(Equal(records.at(1000 + i), MakeRecord(i)));
+}
+
+TEST_CASE(RejectsOutdatedHeader)
+{
+	auto path = GetTempPath("Outdated.bin");
+	{
+		std::ofstream file{ path, std::ios::binary };
+		uint32_t header[2] = { ReflectionRecordFile::Magic, ReflectionRecordFile::Version - 1 };
+		file.write(reinterpret_cast<const char*>(header), sizeof(header));
+	}
+
+	Records records;
+	CHECK(LoadAll(path, records) == ReflectionRecordFile::ReadResult::Invalid);
+	CHECK(records.empty());
+	CHECK(!std::filesystem::exists(path));
+}
+
+TEST_CASE(TruncatesTornAppendAndKeepsAppending)
+{
+	auto path = GetTempPath("Torn.bin");
+	CHECK(ReflectionRecordFile::Append(path, ReflectionRecordFile::Serialize(1, MakeRecord(1))));
+	CHECK(ReflectionRecordFile::Append(path, ReflectionRecordFile::Serialize(2, MakeRecord(2))));
+	auto goodSize = std::filesystem::file_size(path);
+
+	// a record cut short by the process exiting in the middle of the write
+	auto torn = ReflectionRecordFile::Serialize(3, MakeRecord(3));
+	{
+		std::ofstream file{ path, std::ios::binary | std::ios::app };
+		file.write(torn.data(), torn.size() / 2);
+	}
+
+	Records records;
+	CHECK(LoadAll(path, records) == ReflectionRecordFile::ReadResult::Truncated);
+	CHECK(records.size() == 2);
+	CHECK(std::filesystem::file_size(path) == goodSize);
+
+	// records appended after the truncation are read again
+	CHECK(ReflectionRecordFile::Append(path, ReflectionRecordFile::Serialize(4, MakeRecord(4))));
+	records.clear();
+	CHECK(LoadAll(path, records) == ReflectionRecordFile::ReadResult::Valid);
+	REQUIRE(records.size() == 3);
+	CHECK(Equal(records.at(4), MakeRecord(4)));
+}
+
+TEST_CASE(StopsAtCorruptRecord)
+{
+	auto path = GetTempPath("Corrupt.bin");
+	CHECK(ReflectionRecordFile::Append(path, ReflectionRecordFile::Serialize(1, MakeRecord(1))));
+	auto goodSize = std::filesystem::file_size(path);
+	CHECK(ReflectionRecordFile::Append(path, ReflectionRecordFile::Serialize(2, MakeRecord(2))));
+	CHECK(ReflectionRecordFile::Append(path, ReflectionRecordFile::Serialize(3, MakeRecord(3))));
+
+	// flip a byte in the payload of the second record
+	{
+		std::fstream file{ path, std::ios::binary | std::ios::in | std::ios::out };
+		file.seekp(goodSize + 12);
+		file.put('\x7F');
+	}
+
+	Records records;
+	CHECK(LoadAll(path, records) == ReflectionRecordFile::ReadResult::Truncated);
+	CHECK(records.size() == 1);
+	CHECK(records.contains(1));
+	CHECK(std::filesystem::file_size(path) == goodSize);
+}
@@ -0,0 +1,81 @@
+#include "BenchmarkSuite.h"
+#include "SettingsWriter.h"
+#include "Test.h"
+
+#include <nlohmann/json.hpp>
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+namespace
+{
+	// Shaped like CommunityShadersUSER.json: a few global sections and one object of mostly floats per feature
+	nlohmann::json MakeSettings()
+	{
+		nlohmann::json settings;
+		settings["Version"] = "0-7-4";
+		settings["General"] = { { "Enable Shaders", true }, { "Enable Disk Cache", true }, { "Enable Async", false } };
+		settings["Advanced"] = { { "Log Level", 2 }, { "Shader Defines", "" }, { "Compiler Threads", 11u } };
+		settings["Menu"] = { { "Toggle Key", 45 }, { "Theme", { { "FontScale", -0.25f }, { "Palette", { 0.1f, 0.2f, 0.3f, 1.0f } } } } };
+		for (int feature = 0; feature < 24; feature++) {
+			auto& object = settings["Feature " + std::to_string(feature)];
+			for (int setting = 0; setting < 16; setting++)
+				object["Setting " + std::to_string(setting)] = feature * 0.37f + setting / 3.0f;
+			object["Enabled"] = feature % 2 == 0;
+			object["Curve"] = nlohmann::json::array({ 0.0, 0.5, 1.0, 1.5, 2.0, 2.5, 3.0, 3.5, 4.0, 4.5, 5.0, 5.5 });
+		}
+		return settings;
+	}
+
+	std::filesystem::path MakeDirectory(const char* a_name)
+	{
+		auto directory = std::filesystem::temp_directory_path() / "CommunityShadersTests" / a_name;
+		std::filesystem::remove_all(directory);
+		std::filesystem::create_directories(directory);
+		return directory;
+	}
+}
+
+// State::Save and State::Load: dumped with an indent of 1, written by the writer and parsed back unchanged
+TEST_CASE(RoundTripsThroughTheWriter)
+{
+	auto path = (MakeDirectory("SettingsFile") / "CommunityShadersUSER.json").string();
+	auto settings = MakeSettings();
+	settings["Nested"] = nlohmann::json::parse(R"([[1, [2, {}]], { "a/b": "slash", "": "empty key", "Text": "line\nbreak é" }])");
+	{
+		SettingsWriter writer{ std::chrono::hours(1) };
+		writer.Write(path, settings.dump(1));
+	}
+
+	std::ifstream file{ path };
+	auto loaded = nlohmann::json::parse(file);
+	CHECK(loaded == settings);
+	CHECK(loaded.dump(1) == settings.dump(1));
+	CHECK(loaded["Advanced"]["Log Level"].is_number_integer());
+	CHECK(loaded["Advanced"]["Compiler Threads"].is_number_unsigned());
+	CHECK(loaded["Menu"]["Theme"]["FontScale"].is_number_float());
+}
+
+// What a save costs the UI thread with the background writer against writing the file in place, and what a load costs
+TEST_CASE(LoadSaveLatency)
+{
+	auto path = (MakeDirectory("SettingsFileLatency") / "CommunityShadersUSER.json").string();
+	auto settings = MakeSettings();
+	auto text = settings.dump(1);
+	SettingsWriter writer{ std::chrono::milliseconds(500) };
+
+	BenchmarkSuite suite;
+	suite.Add("Settings/SaveQueued", [&] { writer.Write(path, settings.dump(1)); });
+	suite.Add("Settings/SaveInPlace", [&] { BenchmarkSuite::DoNotOptimize(SettingsWriter::WriteAtomic(path, settings.dump(1))); });
+	suite.Add("Settings/Load", [&] { BenchmarkSuite::DoNotOptimize(nlohmann::json::parse(text)); });
+	auto results = suite.Run(std::chrono::milliseconds(20));
+	writer.Flush();
+
+	auto stats = writer.GetStats();
+	std::printf("%zu bytes of JSON, %llu queued saves written %llu times\n%s", text.size(), (unsigned long long)stats.requests,
+		(unsigned long long)stats.writes, BenchmarkSuite::ToJson(results, "").c_str());
+	CHECK(results.size() == 3);
+	CHECK(stats.writes < stats.requests);
+	CHECK(stats.failures == 0);
+}
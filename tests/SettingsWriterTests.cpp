@@ -0,0 +1,80 @@
+#include "SettingsWriter.h"
+#include "Test.h"
+
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+using namespace std::literals;
+
+namespace
+{
+	std::string ReadFile(const std::filesystem::path& a_path)
+	{
+		std::ifstream file{ a_path, std::ios::binary };
+		return { std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+	}
+
+	std::filesystem::path MakeDirectory(const char* a_name)
+	{
+		auto directory = std::filesystem::temp_directory_path() / "CommunityShadersTests" / a_name;
+		std::filesystem::remove_all(directory);
+		std::filesystem::create_directories(directory);
+		return directory;
+	}
+}
+
+TEST_CASE(CoalescesAndFlushes)
+{
+	auto directory = MakeDirectory("SettingsWriter");
+	auto path = (directory / "Settings.json").string();
+
+	SettingsWriter writer{ 10s };
+	for (int i = 0; i < 100; i++)
+		writer.Write(path, std::to_string(i));
+	CHECK(!std::filesystem::exists(path));
+
+	writer.Flush();
+	CHECK(ReadFile(path) == "99");
+	CHECK(!std::filesystem::exists(path + ".tmp"));
+	auto stats = writer.GetStats();
+	CHECK(stats.requests == 100);
+	CHECK(stats.writes == 1);
+}
+
+TEST_CASE(ExpeditesWithoutWaitingForTheDelay)
+{
+	auto directory = MakeDirectory("SettingsWriterExpedite");
+	auto path = (directory / "Settings.json").string();
+
+	SettingsWriter writer{ 1h };
+	writer.Write(path, "expedited");
+	writer.Expedite();
+	for (int i = 0; i < 500 && !writer.GetStats().writes; i++)
+		std::this_thread::sleep_for(10ms);
+	CHECK(writer.GetStats().writes == 1);
+	CHECK(ReadFile(path) == "expedited");
+}
+
+TEST_CASE(FlushesOnDestruction)
+{
+	auto directory = MakeDirectory("SettingsWriterExit");
+	auto path = (directory / "Settings.json").string();
+	{
+		SettingsWriter writer{ 1h };
+		writer.Write(path, "last save");
+	}
+	CHECK(ReadFile(path) == "last save");
+}
+
+TEST_CASE(ReportsFailures)
+{
+	auto directory = MakeDirectory("SettingsWriterFailure");
+	std::string failed;
+	SettingsWriter writer{ 1h, [&](const std::string& a_path) { failed = a_path; } };
+	auto path = (directory / "Missing" / "Settings.json").string();
+	writer.Write(path, "{}");
+	writer.Flush();
+	CHECK(failed == path);
+	CHECK(writer.GetStats().failures == 1);
+}
@@ -0,0 +1,105 @@
+#include "ShaderDependencyGraph.h"
+#include "Test.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+namespace
+{
+	using Names = std::unordered_set<std::string>;
+
+	void WriteFile(const std::filesystem::path& a_path, const std::string& a_contents)
+	{
+		std::filesystem::create_directories(a_path.parent_path());
+		std::ofstream file{ a_path, std::ios::trunc };
+		file << a_contents;
+	}
+
+	// Written files get distinct write times even on file systems with coarse timestamps
+	void Touch(const std::filesystem::path& a_path, const std::string& a_contents)
+	{
+		auto previous = std::filesystem::last_write_time(a_path);
+		WriteFile(a_path, a_contents);
+		std::filesystem::last_write_time(a_path, previous + std::chrono::seconds(1));
+	}
+
+	bool Contains(const std::vector<std::string>& a_keys, const std::string& a_key)
+	{
+		return std::find(a_keys.begin(), a_keys.end(), a_key) != a_keys.end();
+	}
+
+	// Lighting and Water share Common/Color.hlsli, Lighting reaches it a second time through a local include of Shadows.
+	// Features/Wetness.hlsl is nested, so it is no top level shader even though it is a .hlsl file.
+	std::filesystem::path MakeShaderDirectory(const char* a_name)
+	{
+		auto root = std::filesystem::temp_directory_path() / "CommunityShadersTests" / a_name;
+		std::filesystem::remove_all(root);
+		WriteFile(root / "Lighting.hlsl", "#include \"Common/Color.hlsli\"\n  #include \"Common/Shadows.hlsli\"\nfloat4 main() : SV_Target { return 0; }\n");
+		WriteFile(root / "Water.hlsl", "#include \"Common/COLOR.hlsli\"\n");
+		WriteFile(root / "Utility.hlsl", "#include <d3d11.h>\n// #include is only an include at the start of a line\n");
+		WriteFile(root / "Common" / "Color.hlsli", "float3 Tint;\n");
+		WriteFile(root / "Common" / "Shadows.hlsli", "#include \"Color.hlsli\"\n#include \"Cycle.hlsli\"\n");
+		WriteFile(root / "Common" / "Cycle.hlsli", "#include \"Shadows.hlsli\"\n");
+		WriteFile(root / "Features" / "Wetness.hlsl", "#include \"Common/Color.hlsli\"\n");
+		WriteFile(root / "Readme.txt", "#include \"Common/Color.hlsli\"\n");
+		return root;
+	}
+}
+
+TEST_CASE(ParsesQuotedIncludes)
+{
+	std::istringstream source{
+		"#include \"A.hlsli\"\n"
+		"\t  #include \"Dir/B.hlsli\" // trailing comment\n"
+		"#include <System.h>\n"
+		"#include \"Unterminated\n"
+		"// #include \"Commented.hlsli\"\n"
+		"#define X #include \"Macro.hlsli\"\n"
+	};
+	auto includes = ShaderDependencyGraph::ParseIncludes(source);
+	REQUIRE(includes.size() == 2);
+	CHECK(includes[0] == "A.hlsli");
+	CHECK(includes[1] == "Dir/B.hlsli");
+}
+
+TEST_CASE(FindsShadersIncludingAFile)
+{
+	auto root = MakeShaderDirectory("ShaderDependencyGraph");
+	ShaderDependencyGraph graph{ root };
+	graph.Build();
+	CHECK(graph.GetFileCount() == 7);
+
+	CHECK((graph.GetAffectedShaders({ "common/color.hlsli" }) == Names{ "lighting", "water" }));
+	CHECK((graph.GetAffectedShaders({ "common/cycle.hlsli" }) == Names{ "lighting" }));
+	CHECK((graph.GetAffectedShaders({ "utility.hlsl" }) == Names{ "utility" }));
+	CHECK(graph.GetAffectedShaders({ "features/wetness.hlsl" }).empty());
+	CHECK(graph.GetAffectedShaders({ "unknown.hlsli" }).empty());
+
+	// nothing changed since the build
+	CHECK(graph.Refresh().empty());
+}
+
+TEST_CASE(RefreshesEditedAddedAndRemovedFiles)
+{
+	auto root = MakeShaderDirectory("ShaderDependencyGraphRefresh");
+	ShaderDependencyGraph graph{ root };
+	graph.Build();
+
+	// Utility starts including Color, Water stops
+	Touch(root / "Utility.hlsl", "#include \"Common/Color.hlsli\"\n");
+	Touch(root / "Water.hlsl", "float4 main() : SV_Target { return 0; }\n");
+	auto changed = graph.Refresh();
+	CHECK(changed.size() == 2 && Contains(changed, "utility.hlsl") && Contains(changed, "water.hlsl"));
+	CHECK((graph.GetAffectedShaders({ "common/color.hlsli" }) == Names{ "lighting", "utility" }));
+
+	WriteFile(root / "Sky.hlsl", "#include \"Common/Cycle.hlsli\"\n");
+	std::filesystem::remove(root / "Common" / "Shadows.hlsli");
+	changed = graph.Refresh();
+	CHECK(changed.size() == 2 && Contains(changed, "sky.hlsl") && Contains(changed, "common/shadows.hlsli"));
+	CHECK(graph.GetFileCount() == 7);
+
+	// Cycle no longer reaches Lighting through the removed Shadows, which Lighting and Cycle still name if it comes back
+	CHECK((graph.GetAffectedShaders({ "common/cycle.hlsli" }) == Names{ "sky" }));
+	CHECK((graph.GetAffectedShaders({ "common/shadows.hlsli" }) == Names{ "lighting", "sky" }));
+}
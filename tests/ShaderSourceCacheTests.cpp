@@ -0,0 +1,252 @@
+#include "ShaderSourceCache.h"
+#include "Test.h"
+
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <sstream>
+
+namespace
+{
+	std::filesystem::path MakeDirectory(const char* a_name)
+	{
+		auto directory = std::filesystem::temp_directory_path() / "CommunityShadersTests" / a_name;
+		std::filesystem::remove_all(directory);
+		std::filesystem::create_directories(directory);
+		return directory;
+	}
+
+	void WriteFile(const std::filesystem::path& a_path, const std::string& a_contents)
+	{
+		std::filesystem::create_directories(a_path.parent_path());
+		std::ofstream file{ a_path, std::ios::binary | std::ios::trunc };
+		file << a_contents;
+	}
+
+	// Include directive of a line, empty if there is none
+	std::string GetInclude(const std::string& a_line)
+	{
+		if (!a_line.starts_with("#include \""))
+			return {};
+		auto end = a_line.find('"', 10);
+		return end == std::string::npos ? std::string{} : a_line.substr(10, end - 10);
+	}
+
+	// Stands in for D3DPreprocess: expands includes through an open and close callback, the way the compiler drives an include handler
+	using OpenInclude = std::function<const std::string*(const std::string& a_include, const void* a_parent)>;
+	using CloseInclude = std::function<void(const void* a_data)>;
+
+	bool Expand(const std::string& a_source, const OpenInclude& a_open, const CloseInclude& a_close, std::string& a_output, int a_depth = 0)
+	{
+		if (a_depth > 16)
+			return false;
+		std::istringstream stream{ a_source };
+		std::string line;
+		while (std::getline(stream, line)) {
+			auto include = GetInclude(line);
+			if (include.empty()) {
+				a_output += line;
+				a_output += '\n';
+				continue;
+			}
+			auto contents = a_open(include, a_source.data());
+			if (!contents)
+				return false;
+			bool expanded = Expand(*contents, a_open, a_close, a_output, a_depth + 1);
+			a_close(contents->data());
+			if (!expanded)
+				return false;
+		}
+		return true;
+	}
+
+	bool FakeCompile(ShaderSourceCache& a_cache, const std::filesystem::path& a_path, std::string& a_output)
+	{
+		auto source = a_cache.Get(a_path);
+		if (!source)
+			return false;
+		ShaderSourceCache::Scope scope{ a_cache, a_path };
+		return Expand(
+			*source, [&](const std::string& a_include, const void* a_parent) { return scope.Open(a_include, a_parent == source->data() ? nullptr : a_parent); },
+			[&](const void* a_data) { scope.Close(a_data); }, a_output);
+	}
+
+	// What every compile did before the cache: check the write time and read each file again
+	struct DiskReader
+	{
+		uint64_t stats = 0;
+		uint64_t reads = 0;
+		std::vector<std::pair<std::unique_ptr<std::string>, std::filesystem::path>> open;
+
+		const std::string* Read(const std::filesystem::path& a_path)
+		{
+			std::error_code ec;
+			stats++;
+			(void)std::filesystem::last_write_time(a_path, ec);
+			if (ec)
+				return nullptr;
+			std::ifstream file{ a_path, std::ios::binary };
+			reads++;
+			open.emplace_back(std::make_unique<std::string>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()), a_path);
+			return open.back().first.get();
+		}
+
+		bool Compile(const std::filesystem::path& a_path, std::string& a_output)
+		{
+			auto source = Read(a_path);
+			if (!source)
+				return false;
+			return Expand(
+				*source, [&](const std::string& a_include, const void* a_parent) {
+					auto includer = a_path;
+					for (auto& [contents, path] : open)
+						if (contents->data() == a_parent)
+							includer = path;
+					auto contents = Read(includer.parent_path() / a_include);
+					return contents ? contents : Read(a_path.parent_path() / a_include);
+				},
+				[](const void*) {}, a_output);
+		}
+	};
+
+	// Lighting.hlsl style tree: a top level shader including a handful of headers that include each other
+	std::filesystem::path MakeShaderTree(const std::filesystem::path& a_root, int a_headers)
+	{
+		std::string lighting = "#include \"Common/Frame.hlsli\"\n";
+		WriteFile(a_root / "Common/Frame.hlsli", "cbuffer Frame {}\n");
+		for (int i = 0; i < a_headers; i++) {
+			auto name = "Feature" + std::to_string(i) + ".hlsli";
+			WriteFile(a_root / "Common" / name, "#include \"Frame.hlsli\"\nfloat Feature" + std::to_string(i) + "();\n" + std::string(2000, ' ') + "\n");
+			lighting += "#include \"Common/" + name + "\"\n";
+		}
+		lighting += "float4 main() : SV_Target { return 1; }\n";
+		WriteFile(a_root / "Lighting.hlsl", lighting);
+		return a_root / "Lighting.hlsl";
+	}
+}
+
+TEST_CASE(ResolvesIncludesLikeTheCompiler)
+{
+	auto root = MakeDirectory("SourceCacheIncludes");
+	WriteFile(root / "Shader.hlsl", "#include \"Common/A.hlsli\"\nmain\n");
+	WriteFile(root / "Common/A.hlsli", "#include \"B.hlsli\"\na\n");  // next to the includer
+	WriteFile(root / "Common/B.hlsli", "#include \"C.hlsli\"\nb\n");  // falls back to next to the source
+	WriteFile(root / "C.hlsli", "c\n");
+
+	ShaderSourceCache cache;
+	std::string output;
+	CHECK(FakeCompile(cache, root / "Shader.hlsl", output));
+	CHECK(output == "c\nb\na\nmain\n");
+}
+
+TEST_CASE(PreloadServesCompilesWithoutFileAccess)
+{
+	auto root = MakeDirectory("SourceCachePreload");
+	auto lighting = MakeShaderTree(root, 12);
+
+	ShaderSourceCache cache;
+	cache.Preload(root);
+	CHECK(cache.GetFileCount() == 14);
+	auto preloadStats = cache.GetStatCount();
+	auto preloadReads = cache.GetReadCount();
+	CHECK(preloadReads == 14);
+
+	std::string first;
+	for (int permutation = 0; permutation < 100; permutation++) {
+		std::string output;
+		CHECK(FakeCompile(cache, lighting, output));
+		if (permutation == 0)
+			first = output;
+		CHECK(output == first);
+	}
+
+	// every file was already in memory: the first lookups miss only for the include paths next to the includer that do not exist
+	auto missStats = cache.GetStatCount() - preloadStats;
+	CHECK(cache.GetReadCount() == preloadReads);
+	CHECK(missStats <= 1);
+	CHECK(cache.GetHitCount() > 100 * 13);
+}
+
+TEST_CASE(RefreshRereadsOnlyChangedFiles)
+{
+	auto root = MakeDirectory("SourceCacheRefresh");
+	auto lighting = MakeShaderTree(root, 4);
+
+	ShaderSourceCache cache;
+	cache.Preload(root);
+	std::string before;
+	CHECK(FakeCompile(cache, lighting, before));
+
+	// written without the cache noticing until Refresh
+	auto changedPath = root / "Common/Feature2.hlsli";
+	WriteFile(changedPath, "float Changed();\n");
+	std::filesystem::last_write_time(changedPath, std::filesystem::last_write_time(changedPath) + std::chrono::hours(1));
+	std::string stale;
+	CHECK(FakeCompile(cache, lighting, stale));
+	CHECK(stale == before);
+
+	auto reads = cache.GetReadCount();
+	auto changed = cache.Refresh();
+	REQUIRE(changed.size() == 1);
+	CHECK(changed[0] == changedPath.lexically_normal().generic_string());
+	CHECK(cache.GetReadCount() == reads + 1);
+
+	std::string after;
+	CHECK(FakeCompile(cache, lighting, after));
+	CHECK(after != before);
+	CHECK(after.find("float Changed();") != std::string::npos);
+
+	CHECK(cache.Refresh().empty());
+}
+
+TEST_CASE(RemembersMissingFilesUntilRefresh)
+{
+	auto root = MakeDirectory("SourceCacheMissing");
+	ShaderSourceCache cache;
+	CHECK(!cache.Get(root / "Missing.hlsli"));
+	auto stats = cache.GetStatCount();
+	CHECK(!cache.Get(root / "Missing.hlsli"));
+	CHECK(cache.GetStatCount() == stats);
+
+	WriteFile(root / "Missing.hlsli", "x\n");
+	CHECK(cache.Refresh().size() == 1);
+	auto contents = cache.Get(root / "Missing.hlsli");
+	REQUIRE(contents);
+	CHECK(*contents == "x\n");
+}
+
+TEST_CASE(MeasuresFileAccessAgainstReadingEveryCompile)
+{
+	using namespace std::chrono;
+	auto root = MakeDirectory("SourceCacheMeasure");
+	auto lighting = MakeShaderTree(root, 24);
+	constexpr int permutations = 500;
+
+	DiskReader disk;
+	auto diskStart = steady_clock::now();
+	std::string diskOutput;
+	for (int permutation = 0; permutation < permutations; permutation++) {
+		diskOutput.clear();
+		CHECK(disk.Compile(lighting, diskOutput));
+		disk.open.clear();
+	}
+	auto diskTime = duration<double, std::milli>(steady_clock::now() - diskStart).count();
+
+	ShaderSourceCache cache;
+	auto cacheStart = steady_clock::now();
+	cache.Preload(root);
+	std::string cacheOutput;
+	for (int permutation = 0; permutation < permutations; permutation++) {
+		cacheOutput.clear();
+		CHECK(FakeCompile(cache, lighting, cacheOutput));
+	}
+	auto cacheTime = duration<double, std::milli>(steady_clock::now() - cacheStart).count();
+
+	CHECK(cacheOutput == diskOutput);
+	std::printf("%d permutations of %zu files\n", permutations, cache.GetFileCount());
+	std::printf("  read every compile: %llu write time checks, %llu reads, %.1f ms\n", (unsigned long long)disk.stats, (unsigned long long)disk.reads, diskTime);
+	std::printf("  source cache:       %llu write time checks, %llu reads, %.1f ms\n", (unsigned long long)cache.GetStatCount(), (unsigned long long)cache.GetReadCount(), cacheTime);
+
+	CHECK(cache.GetReadCount() == cache.GetFileCount());
+	CHECK(cache.GetStatCount() * 100 < disk.stats);
+}
@@ -0,0 +1,104 @@
+#include "ShaderSourceGroups.h"
+#include "Test.h"
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+TEST_CASE(Sha256MatchesKnownDigests)
+{
+	CHECK(Sha256::ToString(Sha256::Hash("")) == "E3B0C44298FC1C149AFBF4C8996FB92427AE41E4649B934CA495991B7852B855");
+	CHECK(Sha256::ToString(Sha256::Hash("abc")) == "BA7816BF8F01CFEA414140DE5DAE2223B00361A396177A9CB410FF61F20015AD");
+	CHECK(Sha256::ToString(Sha256::Hash("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq")) ==
+		  "248D6A61D20638B8E5C026930C3E6039A33CE45964FF2167F6ECEDD419DB06C1");
+
+	// one million 'a' fed in uneven pieces crosses the block boundary every way
+	Sha256 sha;
+	std::string chunk(997, 'a');
+	size_t remaining = 1000000;
+	while (remaining) {
+		auto size = std::min(remaining, chunk.size());
+		sha.Update(chunk.data(), size);
+		remaining -= size;
+	}
+	CHECK(Sha256::ToString(sha.Finish()) == "CDC76E5C9914FB9281A1C7E284D73E67F1809A48A497200E046D39CCC7112CD0");
+}
+
+TEST_CASE(IgnoresLineDirectivesAndWhitespace)
+{
+	auto digest = ShaderSourceGroups::HashSource("ps_5_0", "float4 main() : SV_Target\n{\n\treturn 1;\n}\n");
+	CHECK(digest == ShaderSourceGroups::HashSource("ps_5_0", "#line 1 \"Lighting.hlsl\"\nfloat4   main() : SV_Target {\r\n  return 1;\n\n}"));
+	CHECK(digest != ShaderSourceGroups::HashSource("vs_5_0", "float4 main() : SV_Target\n{\n\treturn 1;\n}\n"));
+	CHECK(digest != ShaderSourceGroups::HashSource("ps_5_0", "float4 main() : SV_Target\n{\n\treturn 2;\n}\n"));
+
+	// whitespace separating tokens is kept
+	CHECK(ShaderSourceGroups::HashSource("ps_5_0", "a b") != ShaderSourceGroups::HashSource("ps_5_0", "ab"));
+}
+
+TEST_CASE(SharesOnlyIdenticalSources)
+{
+	ShaderSourceGroups groups;
+	auto a = ShaderSourceGroups::HashSource("ps_5_0", "return 1;");
+	auto b = ShaderSourceGroups::HashSource("ps_5_0", "return 2;");
+
+	CHECK(groups.Add(1, a, "Lighting:Pixel:1").empty());
+	CHECK(groups.Add(1, a, "Lighting:Pixel:2") == "Lighting:Pixel:1");
+	CHECK(groups.Add(1, b, "Lighting:Pixel:3").empty());
+	CHECK(groups.Add(1, a, "Lighting:Pixel:1").empty());  // the representative itself
+
+	auto stats = groups.GetStats(1);
+	CHECK(stats.permutations == 3);
+	CHECK(stats.uniqueSources == 2);
+	CHECK(groups.GetStats(2).permutations == 0);
+}
+
+TEST_CASE(DigestsDifferingInTheirHashPrefixAreSeparate)
+{
+	// equal first bytes put both in one bucket, they must still not be merged
+	ShaderSourceGroups groups;
+	ShaderSourceGroups::Digest first{};
+	auto second = first;
+	second.back() = 1;
+
+	CHECK(groups.Add(1, first, "A").empty());
+	CHECK(groups.Add(1, second, "B").empty());
+	CHECK(groups.GetStats(1).uniqueSources == 2);
+}
+
+TEST_CASE(RemovesGroupsByRepresentativePrefix)
+{
+	ShaderSourceGroups groups;
+	auto a = ShaderSourceGroups::HashSource("ps_5_0", "return 1;");
+	auto b = ShaderSourceGroups::HashSource("ps_5_0", "return 2;");
+	groups.Add(1, a, "Lighting:Pixel:1");
+	groups.Add(2, b, "Water:Pixel:1");
+
+	groups.Remove("Lighting:");
+	CHECK(groups.Add(1, a, "Lighting:Pixel:2").empty());
+	CHECK(groups.Add(2, b, "Water:Pixel:2") == "Water:Pixel:1");
+
+	groups.Clear();
+	CHECK(groups.GetStats(2).uniqueSources == 0);
+}
+
+TEST_CASE(AddsFromManyThreads)
+{
+	ShaderSourceGroups groups;
+	std::vector<ShaderSourceGroups::Digest> digests;
+	for (int i = 0; i < 16; i++)
+		digests.push_back(ShaderSourceGroups::HashSource("ps_5_0", std::to_string(i)));
+
+	std::vector<std::thread> threads;
+	for (int t = 0; t < 8; t++) {
+		threads.emplace_back([&, t] {
+			for (int i = 0; i < 256; i++)
+				groups.Add(0, digests[i % digests.size()], std::to_string(t * 256 + i));
+		});
+	}
+	for (auto& thread : threads)
+		thread.join();
+
+	auto stats = groups.GetStats(0);
+	CHECK(stats.uniqueSources == digests.size());
+	CHECK(stats.permutations == 8 * 256);
+}
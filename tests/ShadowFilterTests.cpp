@@ -0,0 +1,117 @@
+#include "Features/ScreenSpaceShadows/ShadowFilter.h"
+#include "Test.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace
+{
+	using ShadowFilter::Image;
+
+	// Terrain sloping away from the camera with a box in front of it, so both passes hit depth edges at tile borders
+	Image MakeDepth(std::uint32_t a_width, std::uint32_t a_height)
+	{
+		Image depth{ a_width, a_height };
+		for (std::uint32_t y = 0; y < a_height; y++) {
+			for (std::uint32_t x = 0; x < a_width; x++) {
+				float ground = 4000.0f - 3800.0f * y / a_height;
+				bool box = x > a_width / 3 && x < a_width / 2 && y > a_height / 4 && y < a_height * 3 / 4;
+				depth.At(x, y) = box ? 150.0f : ground;
+			}
+		}
+		return depth;
+	}
+
+	Image MakeNoise(std::uint32_t a_width, std::uint32_t a_height, std::uint32_t a_seed)
+	{
+		std::mt19937 random{ a_seed };
+		std::uniform_real_distribution<float> distribution{ 0.0f, 1.0f };
+		Image noise{ a_width, a_height };
+		for (auto& texel : noise.texels)
+			texel = distribution(random);
+		return noise;
+	}
+
+	float MaxDifference(const Image& a_left, const Image& a_right)
+	{
+		float difference = 0.0f;
+		for (std::size_t i = 0; i < a_left.texels.size(); i++)
+			difference = std::max(difference, std::abs(a_left.texels[i] - a_right.texels[i]));
+		return difference;
+	}
+}
+
+TEST_CASE(SamplesBilinearlyWithClamp)
+{
+	Image image{ 2, 1 };
+	image.At(0, 0) = 0.0f;
+	image.At(1, 0) = 1.0f;
+	CHECK(std::abs(image.Sample(0.5f, 0.5f) - 0.5f) < 1e-6f);
+	CHECK(image.Sample(0.0f, 0.5f) == 0.0f);
+	CHECK(image.Sample(1.0f, 0.5f) == 1.0f);
+	CHECK(image.Load(-3, 7) == 0.0f);
+}
+
+TEST_CASE(KeepsUniformOcclusion)
+{
+	Image occlusion{ 64, 48, 0.25f };
+	auto depth = MakeDepth(64, 48);
+	ShadowFilter::Settings settings{};
+
+	for (auto& result : { ShadowFilter::FilterTwoPass(occlusion, depth, settings), ShadowFilter::FilterFused(occlusion, depth, settings) }) {
+		REQUIRE(result.width == 32 && result.height == 24);
+		for (auto texel : result.texels)
+			CHECK(std::abs(texel - 0.25f) < 1e-5f);
+	}
+}
+
+TEST_CASE(FusedMatchesTwoPass)
+{
+	// not a multiple of the tile size, so partial tiles and the clamped apron rows at the bottom are covered
+	constexpr std::uint32_t width = 200;
+	constexpr std::uint32_t height = 146;
+	auto depth = MakeDepth(width, height);
+
+	for (std::uint32_t seed = 0; seed < 3; seed++) {
+		auto occlusion = MakeNoise(width, height, seed);
+		for (float radius : { 0.0f, 0.25f, 0.5f, 1.0f }) {
+			ShadowFilter::Settings settings{ radius, 0.01f + seed * 0.04f };
+			auto twoPass = ShadowFilter::FilterTwoPass(occlusion, depth, settings);
+			auto fused = ShadowFilter::FilterFused(occlusion, depth, settings);
+			REQUIRE(twoPass.texels.size() == fused.texels.size());
+			CHECK(MaxDifference(twoPass, fused) < 1e-4f);
+		}
+	}
+}
+
+TEST_CASE(ApronCoversLargestRadius)
+{
+	// Largest vertical reach: 6 taps at half the horizontal step at the largest radius of the settings, plus one bilinear row
+	constexpr float largestRadius = 1.0f;
+	CHECK(6.0f * 0.5f * largestRadius + 1.0f <= (float)ShadowFilter::APRON);
+}
+
+TEST_CASE(DoesNotBlurAcrossDepthEdges)
+{
+	constexpr std::uint32_t width = 64;
+	constexpr std::uint32_t height = 64;
+
+	// near wall on the left, fully shadowed background on the right
+	Image depth{ width, height };
+	Image occlusion{ width, height };
+	for (std::uint32_t y = 0; y < height; y++) {
+		for (std::uint32_t x = 0; x < width; x++) {
+			bool wall = x < width / 2;
+			depth.At(x, y) = wall ? 100.0f : 2000.0f;
+			occlusion.At(x, y) = wall ? 1.0f : 0.0f;
+		}
+	}
+
+	ShadowFilter::Settings settings{ 1.0f, 0.01f };
+	for (auto& result : { ShadowFilter::FilterTwoPass(occlusion, depth, settings), ShadowFilter::FilterFused(occlusion, depth, settings) }) {
+		// the wall pixel next to the edge keeps its value
+		CHECK(result.At(width / 4 - 2, height / 4) > 0.99f);
+		CHECK(result.At(width / 4 + 2, height / 4) < 0.01f);
+	}
+}
@@ -0,0 +1,129 @@
+#include "Features/ScreenSpaceShadows/ShadowHistory.h"
+#include "Test.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using Tracker = ShadowHistory::Tracker;
+
+namespace
+{
+	Tracker::Camera MakeCamera(float a_x, float a_yaw, std::uint32_t a_scale = 2)
+	{
+		return { { a_x, 0.0f, 0.0f }, { std::cos(a_yaw), std::sin(a_yaw), 0.0f }, 1920, 1080, a_scale };
+	}
+
+	bool Near(float a_value, float a_expected)
+	{
+		return std::abs(a_value - a_expected) < 1e-6f;
+	}
+}
+
+// The scales offered in the menu, each pixel of a block is traced once before any is traced again
+TEST_CASE(JitterVisitsEveryPixel)
+{
+	for (std::uint32_t scale : { 1u, 2u, 4u, 8u }) {
+		for (std::uint32_t start : { 0u, 5u, 1000u }) {
+			std::vector<std::uint32_t> visits(scale * scale);
+			bool inside = true;
+			for (std::uint32_t frame = start; frame < start + scale * scale; frame++) {
+				auto jitter = ShadowHistory::GetJitter(frame, scale);
+				inside = inside && jitter.x < scale && jitter.y < scale;
+				if (inside)
+					visits[jitter.y * scale + jitter.x]++;
+			}
+			CHECK(inside);
+			bool once = true;
+			for (auto count : visits)
+				once = once && count == 1;
+			CHECK(once);
+		}
+	}
+
+	// half resolution follows the 2x2 ordered dither matrix and starts over after four frames
+	const ShadowHistory::Jitter order[] = { { 0, 0 }, { 1, 0 }, { 1, 1 }, { 0, 1 } };
+	for (std::uint32_t frame = 0; frame < 8; frame++) {
+		auto jitter = ShadowHistory::GetJitter(frame, 2);
+		CHECK(jitter.x == order[frame % 4].x && jitter.y == order[frame % 4].y);
+	}
+}
+
+TEST_CASE(DispatchCoversTheTracedPixels)
+{
+	CHECK(ShadowHistory::GetDispatchSize(1920.0f, 1, 32) == 60);
+	CHECK(ShadowHistory::GetDispatchSize(1080.0f, 2, 32) == 17);  // 540 pixels
+	CHECK(ShadowHistory::GetDispatchSize(1081.0f, 4, 32) == 9);   // 271 pixels
+	CHECK(ShadowHistory::GetDispatchSize(1.0f, 4, 32) == 1);
+	CHECK(ShadowHistory::GetDispatchSize(0.0f, 2, 32) == 1);
+	CHECK(ShadowHistory::GetDispatchSize(100.0f, 0, 32) == 4);  // scale 0 is full resolution
+}
+
+TEST_CASE(WeightGrowsToTheHistoryLength)
+{
+	Tracker tracker;
+	CHECK(tracker.Update(MakeCamera(0.0f, 0.0f)) == 0.0f);
+	CHECK(tracker.GetResetCount() == 1);
+
+	// a slow pan keeps the history, the weight stops at 1 - 1 / MAX_HISTORY_FRAMES
+	for (std::uint32_t frame = 1; frame < 3 * Tracker::MAX_HISTORY_FRAMES; frame++) {
+		auto weight = tracker.Update(MakeCamera(frame * 10.0f, frame * 0.01f));
+		auto frames = std::min(frame, Tracker::MAX_HISTORY_FRAMES - 1);
+		CHECK(Near(weight, 1.0f - 1.0f / (frames + 1)));
+		CHECK(tracker.GetAccumulatedFrames() == frames);
+	}
+	CHECK(tracker.GetResetCount() == 1);
+}
+
+TEST_CASE(CutsResetTheHistory)
+{
+	struct Cut
+	{
+		Tracker::Camera camera;
+		bool reset;
+	};
+	auto base = MakeCamera(0.0f, 0.0f);
+	auto resized = base;
+	resized.width = 2560;
+	auto flipped = base;
+	flipped.forward[0] = -1.0f;
+	auto degenerate = base;
+	degenerate.forward[0] = 0.0f;
+	const Cut cuts[] = {
+		{ MakeCamera(Tracker::CUT_DISTANCE - 1.0f, 0.0f), false },
+		{ MakeCamera(Tracker::CUT_DISTANCE, 0.0f), true },
+		{ MakeCamera(0.0f, std::acos(Tracker::CUT_COS_ANGLE) - 0.01f), false },
+		{ MakeCamera(0.0f, std::acos(Tracker::CUT_COS_ANGLE) + 0.01f), true },
+		{ MakeCamera(0.0f, 0.0f, 4), true },
+		{ resized, true },
+		{ flipped, true },
+		{ degenerate, false },  // no direction to compare, the position alone decides
+	};
+
+	for (auto& cut : cuts) {
+		Tracker tracker;
+		tracker.Update(base);
+		tracker.Update(base);
+		CHECK(tracker.GetAccumulatedFrames() == 1);
+
+		auto weight = tracker.Update(cut.camera);
+		CHECK((weight == 0.0f) == cut.reset);
+		CHECK((tracker.GetAccumulatedFrames() == 0) == cut.reset);
+		CHECK(tracker.GetResetCount() == (cut.reset ? 2u : 1u));
+	}
+}
+
+TEST_CASE(InvalidateResetsOnTheNextUpdate)
+{
+	Tracker tracker;
+	auto camera = MakeCamera(0.0f, 0.0f);
+	for (int frame = 0; frame < 4; frame++)
+		tracker.Update(camera);
+	CHECK(tracker.GetAccumulatedFrames() == 3);
+
+	tracker.Invalidate();
+	CHECK(tracker.GetAccumulatedFrames() == 3);
+	CHECK(tracker.Update(camera) == 0.0f);
+	CHECK(tracker.GetResetCount() == 2);
+	CHECK(Near(tracker.Update(camera), 0.5f));
+}
@@ -0,0 +1,157 @@
+#include "Features/DynamicCubemaps/SpecularTables.h"
+#include "Test.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <numbers>
+
+namespace
+{
+	constexpr std::uint32_t LutSize = 16;
+
+	bool Near(double a_value, double a_expected, double a_tolerance)
+	{
+		return std::abs(a_value - a_expected) <= a_tolerance;
+	}
+
+	// Van der Corput sequence by reversing the binary digits one at a time
+	double RadicalInverse(std::uint32_t a_index)
+	{
+		double result = 0.0;
+		double digit = 0.5;
+		for (; a_index; a_index >>= 1, digit *= 0.5)
+			result += (a_index & 1) * digit;
+		return result;
+	}
+
+	double CosThetaGGX(double a_u, double a_alpha)
+	{
+		return std::sqrt((1.0 - a_u) / (1.0 + (a_alpha * a_alpha - 1.0) * a_u));
+	}
+
+	// The split-sum integrals in double precision on a dense midpoint grid instead of 2048 Hammersley points
+	std::pair<double, double> IntegrateDFG(double a_cosLo, double a_roughness)
+	{
+		constexpr std::uint32_t Steps = 512;
+		double alpha = a_roughness * a_roughness;
+		double k = alpha / 2.0;
+		double sinLo = std::sqrt(1.0 - a_cosLo * a_cosLo);
+		double DFG1 = 0.0;
+		double DFG2 = 0.0;
+		for (std::uint32_t i = 0; i < Steps; i++) {
+			double phi = 2.0 * std::numbers::pi * (i + 0.5) / Steps;
+			for (std::uint32_t j = 0; j < Steps; j++) {
+				double cosLh = CosThetaGGX((j + 0.5) / Steps, alpha);
+				double LoLh = sinLo * std::sqrt(1.0 - cosLh * cosLh) * std::cos(phi) + a_cosLo * cosLh;
+				double cosLi = 2.0 * LoLh * cosLh - a_cosLo;
+				if (cosLi <= 0.0)
+					continue;
+				double G = cosLi / (cosLi * (1.0 - k) + k) * a_cosLo / (a_cosLo * (1.0 - k) + k);
+				double Gv = G * std::max(LoLh, 0.0) / (cosLh * a_cosLo);
+				double Fc = std::pow(1.0 - std::max(LoLh, 0.0), 5.0);
+				DFG1 += (1.0 - Fc) * Gv;
+				DFG2 += Fc * Gv;
+			}
+		}
+		return { DFG1 / (Steps * Steps), DFG2 / (Steps * Steps) };
+	}
+}
+
+// A smooth surface reflects the view direction, leaving only the Fresnel term: 1 - (1 - cosLo)^5 and (1 - cosLo)^5
+TEST_CASE(SmoothRowIsSchlickFresnel)
+{
+	auto lut = SpecularTables::ComputeBRDFLUT(LutSize);
+	REQUIRE(lut.size() == LutSize * LutSize * 2);
+	bool matches = true;
+	for (std::uint32_t x = 0; x < LutSize; x++) {
+		double cosLo = std::max((double)x / LutSize, 0.001);
+		double Fc = std::pow(1.0 - cosLo, 5.0);
+		matches = matches && Near(lut[x * 2], 1.0 - Fc, 1e-4) && Near(lut[x * 2 + 1], Fc, 1e-4);
+	}
+	CHECK(matches);
+}
+
+TEST_CASE(MatchesTheReferenceIntegrals)
+{
+	auto lut = SpecularTables::ComputeBRDFLUT(LutSize);
+	struct Texel
+	{
+		std::uint32_t x, y;
+	};
+	for (auto [x, y] : { Texel{ 8, 8 }, Texel{ 15, 4 }, Texel{ 12, 12 }, Texel{ 4, 15 }, Texel{ 2, 6 } }) {
+		auto [DFG1, DFG2] = IntegrateDFG((double)x / LutSize, (double)y / LutSize);
+		auto texel = (y * LutSize + x) * 2;
+		CHECK(Near(lut[texel], DFG1, 0.01));
+		CHECK(Near(lut[texel + 1], DFG2, 0.01));
+	}
+
+	// no texel reflects more than the white environment it integrates
+	bool bounded = true;
+	for (std::uint32_t texel = 0; texel < LutSize * LutSize; texel++)
+		bounded = bounded && lut[texel * 2] >= 0.0f && lut[texel * 2 + 1] >= 0.0f && lut[texel * 2] + lut[texel * 2 + 1] <= 1.0f + 1e-4f;
+	CHECK(bounded);
+}
+
+TEST_CASE(FilterSamplesFollowGGX)
+{
+	constexpr std::uint32_t MipLevels = 8;
+	auto samples = SpecularTables::ComputeFilterSamples(MipLevels);
+	REQUIRE(samples.size() == MipLevels * SpecularTables::FILTER_SAMPLES * 4);
+
+	bool unfiltered = true;
+	for (std::uint32_t i = 0; i < SpecularTables::FILTER_SAMPLES * 4; i++)
+		unfiltered = unfiltered && samples[i] == 0.0f;
+	CHECK(unfiltered);
+
+	bool matches = true;
+	for (std::uint32_t mip = 1; mip < MipLevels; mip++) {
+		double alpha = std::pow((double)mip / (MipLevels - 1), 2.0);
+		for (std::uint32_t i = 0; i < SpecularTables::FILTER_SAMPLES; i++) {
+			auto sample = samples.data() + (mip * SpecularTables::FILTER_SAMPLES + i) * 4;
+			double cosTheta = CosThetaGGX(RadicalInverse(i), alpha);
+			double phi = 2.0 * std::numbers::pi * i / SpecularTables::FILTER_SAMPLES;
+			double sinTheta = std::sqrt(1.0 - cosTheta * cosTheta);
+
+			// solid angle of a sample is 1 / (N * pdf), the pdf of the reflected direction is D / 4
+			double denom = cosTheta * cosTheta * (alpha * alpha - 1.0) + 1.0;
+			double pdf = alpha * alpha / (std::numbers::pi * denom * denom) / 4.0;
+			double w = 0.5 * std::log2(1.0 / (SpecularTables::FILTER_SAMPLES * pdf));
+
+			matches = matches && Near(sample[0], sinTheta * std::cos(phi), 1e-4) && Near(sample[1], sinTheta * std::sin(phi), 1e-4);
+			matches = matches && Near(sample[2], cosTheta, 1e-4) && Near(sample[3], w, 1e-3);
+		}
+	}
+	CHECK(matches);
+
+	// the roughest mip has a uniform distribution over the hemisphere of half vectors, every sample covers pi / 4
+	auto roughest = samples.data() + (MipLevels - 1) * SpecularTables::FILTER_SAMPLES * 4;
+	CHECK(Near(roughest[3], 0.5 * std::log2(std::numbers::pi / 4.0), 1e-3));
+	CHECK(Near(roughest[4 + 2], std::sqrt(0.5), 1e-5));  // the second sample bisects u2
+	CHECK(roughest[0] == 0.0f && roughest[1] == 0.0f && roughest[2] == 1.0f);
+}
+
+TEST_CASE(LoadsTheSavedLUT)
+{
+	auto path = std::filesystem::temp_directory_path() / "CommunityShadersTests" / "SpecularTables" / "BRDFLUT.bin";
+	std::filesystem::remove_all(path.parent_path());
+	auto expected = SpecularTables::ComputeBRDFLUT(8);
+
+	CHECK(SpecularTables::LoadBRDFLUT(path, 8) == expected);
+	CHECK(std::filesystem::file_size(path) == 3 * sizeof(std::uint32_t) + expected.size() * sizeof(float));
+
+	// the saved values are returned as they are
+	{
+		std::fstream file{ path, std::ios::binary | std::ios::in | std::ios::out };
+		file.seekp(3 * sizeof(std::uint32_t));
+		float marker = 42.0f;
+		file.write(reinterpret_cast<const char*>(&marker), sizeof(marker));
+	}
+	CHECK(SpecularTables::LoadBRDFLUT(path, 8)[0] == 42.0f);
+
+	// another size or a truncated file is computed and written again
+	CHECK(SpecularTables::LoadBRDFLUT(path, 4) == SpecularTables::ComputeBRDFLUT(4));
+	std::filesystem::resize_file(path, 3 * sizeof(std::uint32_t) + 10);
+	CHECK(SpecularTables::LoadBRDFLUT(path, 4) == SpecularTables::ComputeBRDFLUT(4));
+	CHECK(std::filesystem::file_size(path) == 3 * sizeof(std::uint32_t) + 4 * 4 * 2 * sizeof(float));
+}
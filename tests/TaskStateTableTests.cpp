@@ -0,0 +1,174 @@
+#include "TaskStateTable.h"
+#include "Test.h"
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+using State = TaskStateTable::State;
+
+TEST_CASE(AddsATaskOnce)
+{
+	TaskStateTable table;
+	CHECK(!table.Get(1));
+	CHECK(table.TryAdd(1));
+	CHECK(!table.TryAdd(1));
+	CHECK(table.Get(1) == State::Queued);
+
+	table.Set(1, State::Completed);
+	CHECK(!table.TryAdd(1));
+	CHECK(table.Get(1) == State::Completed);
+
+	table.Clear();
+	CHECK(!table.Get(1));
+	CHECK(table.TryAdd(1));
+}
+
+TEST_CASE(InvalidateForgetsFinishedTasks)
+{
+	TaskStateTable table;
+	CHECK(table.Invalidate(1));  // unknown, nothing to keep
+
+	for (auto result : { State::Completed, State::Failed }) {
+		CHECK(table.TryAdd(2));
+		table.Set(2, State::InProgress);
+		CHECK(table.Finish(2, result));
+		CHECK(table.Get(2) == result);
+		CHECK(table.Invalidate(2));
+		CHECK(!table.Get(2));
+	}
+}
+
+TEST_CASE(InvalidateKeepsQueuedTasks)
+{
+	TaskStateTable table;
+	CHECK(table.TryAdd(3));
+	CHECK(!table.Invalidate(3));
+	CHECK(table.Get(3) == State::Queued);
+	CHECK(!table.TryAdd(3));
+}
+
+TEST_CASE(FinishForgetsStaleTasks)
+{
+	TaskStateTable table;
+	CHECK(table.TryAdd(4));
+	table.Set(4, State::InProgress);
+
+	// sources changed while compiling: the result is dropped and the task can be queued again
+	CHECK(!table.Invalidate(4));
+	CHECK(table.Get(4) == State::Stale);
+	CHECK(!table.TryAdd(4));
+	CHECK(!table.Invalidate(4));
+	CHECK(table.Get(4) == State::Stale);
+	CHECK(!table.Finish(4, State::Completed));
+	CHECK(!table.Get(4));
+	CHECK(table.TryAdd(4));
+
+	// a task that was not invalidated keeps its result
+	table.Set(4, State::InProgress);
+	CHECK(table.Finish(4, State::Failed));
+	CHECK(table.Get(4) == State::Failed);
+}
+
+// Draw threads queue shader tasks while compile workers run them and the file watcher invalidates tasks, on a few
+// thousand ids so the same tasks keep meeting. Every queued task is run exactly once and never by two workers at a time.
+TEST_CASE(StressesProducersAndConsumers)
+{
+	constexpr std::size_t Producers = 16;
+	constexpr std::size_t Consumers = 32;
+	constexpr std::size_t Ids = 4096;
+	constexpr std::size_t Iterations = 20000;
+
+	struct Queue
+	{
+		std::mutex mutex;
+		std::deque<std::size_t> ids;
+	};
+
+	TaskStateTable table;
+	std::vector<Queue> queues(Producers);
+	auto added = std::make_unique<std::atomic<std::uint32_t>[]>(Ids);
+	auto finished = std::make_unique<std::atomic<std::uint32_t>[]>(Ids);
+	auto running = std::make_unique<std::atomic<std::uint32_t>[]>(Ids);
+	std::atomic<std::uint64_t> operations = 0;
+	std::atomic<std::uint32_t> concurrentRuns = 0;
+	std::atomic<std::uint32_t> staleFinishes = 0;
+	std::atomic<std::size_t> producing = Producers;
+
+	auto start = std::chrono::steady_clock::now();
+	std::vector<std::jthread> threads;
+	for (std::size_t producer = 0; producer < Producers; producer++) {
+		threads.emplace_back([&, producer] {
+			std::minstd_rand random{ (unsigned)producer + 1 };
+			std::uint64_t count = 0;
+			for (std::size_t i = 0; i < Iterations; i++) {
+				auto id = random() % Ids;
+				count++;
+				if (table.TryAdd(id)) {
+					added[id]++;
+					std::scoped_lock lock{ queues[producer].mutex };
+					queues[producer].ids.push_back(id);
+				} else if (i % 16 == 0) {
+					table.Invalidate(id);
+					count++;
+				}
+			}
+			operations += count;
+			producing--;
+		});
+	}
+	for (std::size_t consumer = 0; consumer < Consumers; consumer++) {
+		threads.emplace_back([&, consumer] {
+			auto& queue = queues[consumer % Producers];
+			std::uint64_t count = 0;
+			while (true) {
+				std::optional<std::size_t> next;
+				{
+					std::scoped_lock lock{ queue.mutex };
+					if (!queue.ids.empty()) {
+						next = queue.ids.front();
+						queue.ids.pop_front();
+					}
+				}
+				if (!next) {
+					if (!producing)
+						break;
+					std::this_thread::yield();
+					continue;
+				}
+
+				auto id = *next;
+				if (++running[id] != 1)
+					concurrentRuns++;
+				table.Set(id, State::InProgress);
+				std::this_thread::yield();  // compiling, the window in which the file watcher can make the task stale
+				if (!table.Finish(id, id % 7 ? State::Completed : State::Failed))
+					staleFinishes++;
+				running[id]--;
+				finished[id]++;
+				count += 2;
+			}
+			operations += count;
+		});
+	}
+	threads.clear();
+	auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	CHECK(concurrentRuns == 0);
+	bool balanced = true;
+	bool settled = true;
+	for (std::size_t id = 0; id < Ids; id++) {
+		balanced = balanced && added[id] == finished[id];
+		auto state = table.Get(id);
+		settled = settled && (!state || state == State::Completed || state == State::Failed);
+	}
+	CHECK(balanced);
+	CHECK(settled);
+
+	std::printf("%zu producers, %zu consumers: %llu operations in %.1f ms, %.2f M ops/s, %u stale results dropped\n", Producers, Consumers,
+		(unsigned long long)operations.load(), seconds * 1e3, (double)operations / seconds / 1e6, staleFinishes.load());
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdio>
+#include <vector>
+
+// Minimal test registry for the host tests, every TEST_CASE in an executable is run by TestMain.cpp
+namespace Test
+{
+	struct Case
+	{
+		const char* name;
+		void (*function)();
+	};
+
+	std::vector<Case>& GetCases();
+	void Fail(const char* a_file, int a_line, const char* a_expression);
+
+	struct Registrar
+	{
+		Registrar(const char* a_name, void (*a_function)()) { GetCases().push_back({ a_name, a_function }); }
+	};
+}
+
+#define TEST_CASE(NAME)                                            \
+	static void NAME();                                            \
+	static const Test::Registrar NAME##_registrar{ #NAME, &NAME }; \
+	static void NAME()
+
+#define CHECK(EXPRESSION) ((EXPRESSION) ? (void)0 : Test::Fail(__FILE__, __LINE__, #EXPRESSION))
+
+#define REQUIRE(EXPRESSION)                               \
+	do {                                                  \
+		if (!(EXPRESSION)) {                              \
+			Test::Fail(__FILE__, __LINE__, #EXPRESSION); \
+			return;                                       \
+		}                                                 \
+	} while (false)
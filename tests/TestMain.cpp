@@ -0,0 +1,32 @@
+#include "Test.h"
+
+namespace
+{
+	int failures = 0;
+}
+
+std::vector<Test::Case>& Test::GetCases()
+{
+	static std::vector<Case> cases;
+	return cases;
+}
+
+void Test::Fail(const char* a_file, int a_line, const char* a_expression)
+{
+	std::fprintf(stderr, "%s(%d): check failed: %s\n", a_file, a_line, a_expression);
+	failures++;
+}
+
+int main()
+{
+	int failedCases = 0;
+	for (auto& testCase : Test::GetCases()) {
+		auto before = failures;
+		testCase.function();
+		bool passed = failures == before;
+		failedCases += passed ? 0 : 1;
+		std::printf("[%s] %s\n", passed ? "  OK  " : " FAIL ", testCase.name);
+	}
+	std::printf("%zu cases, %d failed\n", Test::GetCases().size(), failedCases);
+	return failedCases ? 1 : 0;
+}
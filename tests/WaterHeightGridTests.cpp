@@ -0,0 +1,167 @@
+#include "Test.h"
+#include "WaterHeightGrid.h"
+
+#include <map>
+#include <utility>
+
+namespace
+{
+	// Cells of a worldspace as the game would report them, counting the lookups
+	struct MockCells
+	{
+		std::map<std::pair<std::int32_t, std::int32_t>, float> loaded;
+		std::uint32_t queries = 0;
+
+		// every cell in a square around the origin has water at a height derived from its coordinates
+		void Load(std::int32_t a_radius)
+		{
+			for (std::int32_t y = -a_radius; y <= a_radius; y++)
+				for (std::int32_t x = -a_radius; x <= a_radius; x++)
+					loaded[{ x, y }] = GetHeight(x, y);
+		}
+
+		static float GetHeight(std::int32_t a_cellX, std::int32_t a_cellY) { return (float)(a_cellX * 100 + a_cellY); }
+
+		WaterHeightGrid::Provider GetProvider()
+		{
+			return [this](std::int32_t a_cellX, std::int32_t a_cellY) -> std::optional<float> {
+				queries++;
+				auto it = loaded.find({ a_cellX, a_cellY });
+				return it != loaded.end() ? std::optional<float>(it->second) : std::nullopt;
+			};
+		}
+	};
+
+	bool MatchesCells(const WaterHeightGrid& a_grid)
+	{
+		for (std::int32_t y = -WaterHeightGrid::RADIUS; y <= WaterHeightGrid::RADIUS; y++)
+			for (std::int32_t x = -WaterHeightGrid::RADIUS; x <= WaterHeightGrid::RADIUS; x++)
+				if (a_grid.Get(x, y) != MockCells::GetHeight(a_grid.GetCenterX() + x, a_grid.GetCenterY() + y))
+					return false;
+		return true;
+	}
+
+	constexpr std::uint32_t WINDOW_CELLS = WaterHeightGrid::SIZE * WaterHeightGrid::SIZE;
+}
+
+TEST_CASE(FloorsCellCoordinates)
+{
+	CHECK(WaterHeightGrid::GetCellCoord(0.0f) == 0);
+	CHECK(WaterHeightGrid::GetCellCoord(4095.0f) == 0);
+	CHECK(WaterHeightGrid::GetCellCoord(4096.0f) == 1);
+	CHECK(WaterHeightGrid::GetCellCoord(-1.0f) == -1);
+	CHECK(WaterHeightGrid::GetCellCoord(-4097.0f) == -2);
+}
+
+TEST_CASE(QueriesWholeWindowOnce)
+{
+	MockCells cells;
+	cells.Load(10);
+	WaterHeightGrid grid;
+
+	grid.Update(0, 0, 1, cells.GetProvider());
+	CHECK(cells.queries == WINDOW_CELLS);
+	CHECK(MatchesCells(grid));
+
+	grid.Update(0, 0, 1, cells.GetProvider());
+	CHECK(cells.queries == WINDOW_CELLS);
+}
+
+TEST_CASE(SlidesByOneRowOrColumn)
+{
+	MockCells cells;
+	cells.Load(10);
+	WaterHeightGrid grid;
+	grid.Update(0, 0, 1, cells.GetProvider());
+
+	// walking east, north, west and south only looks up the cells entering the window
+	const std::pair<std::int32_t, std::int32_t> path[] = { { 1, 0 }, { 1, 1 }, { 0, 1 }, { 0, 0 } };
+	for (auto [x, y] : path) {
+		auto before = cells.queries;
+		grid.Update(x, y, 1, cells.GetProvider());
+		CHECK(cells.queries - before == WaterHeightGrid::SIZE);
+		CHECK(MatchesCells(grid));
+	}
+
+	// a diagonal step enters one row and one column
+	auto before = cells.queries;
+	grid.Update(1, 1, 1, cells.GetProvider());
+	CHECK(cells.queries - before == WaterHeightGrid::SIZE * 2 - 1);
+	CHECK(MatchesCells(grid));
+}
+
+TEST_CASE(RequeriesWholeWindowOnJump)
+{
+	MockCells cells;
+	cells.Load(10);
+	WaterHeightGrid grid;
+	grid.Update(0, 0, 1, cells.GetProvider());
+
+	auto before = cells.queries;
+	grid.Update(WaterHeightGrid::SIZE, 0, 1, cells.GetProvider());
+	CHECK(cells.queries - before == WINDOW_CELLS);
+	CHECK(MatchesCells(grid));
+}
+
+TEST_CASE(RequeriesCellsNotLoadedYet)
+{
+	MockCells cells;
+	cells.Load(0);
+	WaterHeightGrid grid;
+	grid.Update(0, 0, 1, cells.GetProvider());
+	CHECK(grid.Get(0, 0) == MockCells::GetHeight(0, 0));
+	CHECK(grid.Get(1, 0) == WaterHeightGrid::NO_WATER);
+
+	// only the 24 unloaded cells are asked again, and picked up once they load
+	cells.Load(1);
+	auto before = cells.queries;
+	grid.Update(0, 0, 1, cells.GetProvider());
+	CHECK(cells.queries - before == WINDOW_CELLS - 1);
+	CHECK(grid.Get(1, 0) == MockCells::GetHeight(1, 0));
+	CHECK(grid.Get(2, 0) == WaterHeightGrid::NO_WATER);
+}
+
+TEST_CASE(DiscardsOnWorldChange)
+{
+	MockCells cells;
+	cells.Load(10);
+	WaterHeightGrid grid;
+	grid.Update(0, 0, 1, cells.GetProvider());
+
+	auto before = cells.queries;
+	grid.Update(0, 0, 2, cells.GetProvider());
+	CHECK(cells.queries - before == WINDOW_CELLS);
+}
+
+TEST_CASE(InvalidatePicksUpChangedWater)
+{
+	MockCells cells;
+	cells.Load(10);
+	WaterHeightGrid grid;
+	grid.Update(0, 0, 1, cells.GetProvider());
+
+	cells.loaded[{ 1, 1 }] = -500.0f;
+	grid.Update(0, 0, 1, cells.GetProvider());
+	CHECK(grid.Get(1, 1) == MockCells::GetHeight(1, 1));
+
+	grid.Invalidate();
+	CHECK(grid.Get(1, 1) == WaterHeightGrid::NO_WATER);
+	auto before = cells.queries;
+	grid.Update(0, 0, 1, cells.GetProvider());
+	CHECK(cells.queries - before == WINDOW_CELLS);
+	CHECK(grid.Get(1, 1) == -500.0f);
+}
+
+TEST_CASE(ReturnsNoWaterOutsideWindow)
+{
+	MockCells cells;
+	cells.Load(10);
+	WaterHeightGrid grid;
+	CHECK(grid.GetCell(0, 0) == WaterHeightGrid::NO_WATER);
+
+	grid.Update(3, -2, 1, cells.GetProvider());
+	CHECK(grid.GetCell(3, -2) == MockCells::GetHeight(3, -2));
+	CHECK(grid.GetCell(5, 0) == MockCells::GetHeight(5, 0));
+	CHECK(grid.GetCell(6, -2) == WaterHeightGrid::NO_WATER);
+	CHECK(grid.Get(WaterHeightGrid::RADIUS + 1, 0) == WaterHeightGrid::NO_WATER);
+}
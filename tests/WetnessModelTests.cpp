@@ -0,0 +1,108 @@
+#include "Features/WetnessEffects/WetnessModel.h"
+#include "Test.h"
+
+#include <cmath>
+
+namespace
+{
+	WetnessModel::Weather MakeWeather(std::uint32_t a_id, WetnessModel::Precipitation a_precipitation)
+	{
+		WetnessModel::Weather weather;
+		weather.id = a_id;
+		weather.precipitation = a_precipitation;
+		weather.rainy = a_precipitation == WetnessModel::Precipitation::Rainy;
+		return weather;
+	}
+
+	WetnessModel::Input MakeInput(float a_hours, const WetnessModel::Weather& a_weather)
+	{
+		WetnessModel::Input input;
+		input.active = true;
+		input.hasGameTime = true;
+		input.gameTime = a_hours * 3600.0f;
+		input.currentWeather = a_weather;
+		return input;
+	}
+
+	bool Near(float a_left, float a_right) { return std::abs(a_left - a_right) < 1e-3f; }
+
+	const auto rain = MakeWeather(1, WetnessModel::Precipitation::Rainy);
+	const auto clear = MakeWeather(2, WetnessModel::Precipitation::Clear);
+}
+
+TEST_CASE(RainBuildsUpAtItsRate)
+{
+	WetnessModel model;
+	model.Update(MakeInput(8.0f, rain));
+	CHECK(model.GetWetnessDepth() == 0.0f);
+
+	model.Update(MakeInput(8.25f, rain));
+	CHECK(Near(model.GetWetnessDepth(), WetnessModel::RAIN_DELTA_PER_SECOND * WetnessModel::WETNESS_SCALE * 900.0f));
+	CHECK(Near(model.GetPuddleDepth(), WetnessModel::RAIN_DELTA_PER_SECOND * WetnessModel::PUDDLE_SCALE * 900.0f));
+	CHECK(model.GetCurrentWeatherID() == rain.id);
+}
+
+TEST_CASE(DepthsAreCapped)
+{
+	WetnessModel model;
+	for (float hours = 8.0f; hours < 14.0f; hours += 0.5f)
+		model.Update(MakeInput(hours, rain));
+	CHECK(model.GetWetnessDepth() == WetnessModel::MAX_WETNESS_DEPTH);
+	CHECK(model.GetPuddleDepth() == WetnessModel::MAX_PUDDLE_DEPTH);
+	CHECK(model.GetWetness() == WetnessModel::MAX_WETNESS);
+	CHECK(model.GetPuddleWetness() == WetnessModel::MAX_PUDDLE_WETNESS);
+
+	for (float hours = 14.0f; hours < 24.0f; hours += 0.5f)
+		model.Update(MakeInput(hours, clear));
+	CHECK(model.GetWetnessDepth() == 0.0f);
+	CHECK(model.GetPuddleDepth() == 0.0f);
+}
+
+TEST_CASE(DaySkipSnapsToCurrentWeather)
+{
+	WetnessModel model;
+	model.Update(MakeInput(8.0f, clear));
+	model.Update(MakeInput(8.0f + 24.0f, rain));
+	CHECK(model.GetWetnessDepth() == WetnessModel::MAX_WETNESS_DEPTH);
+	CHECK(model.GetPuddleDepth() == WetnessModel::MAX_PUDDLE_DEPTH);
+
+	model.Update(MakeInput(8.0f + 48.0f, clear));
+	CHECK(model.GetWetnessDepth() == 0.0f);
+}
+
+TEST_CASE(InactiveReportsDryAndKeepsDepth)
+{
+	WetnessModel model;
+	model.Update(MakeInput(8.0f, rain));
+	model.Update(MakeInput(9.0f, rain));
+	auto depth = model.GetWetnessDepth();
+
+	model.Update({});
+	CHECK(model.GetWetness() == WetnessModel::DRY_WETNESS);
+	CHECK(model.GetCurrentWeatherID() == 0);
+	CHECK(model.GetWetnessDepth() == depth);
+
+	// the time spent inactive is integrated on the next active update
+	model.Update(MakeInput(9.5f, rain));
+	CHECK(Near(model.GetWetnessDepth(), std::min(depth + WetnessModel::RAIN_DELTA_PER_SECOND * WetnessModel::WETNESS_SCALE * 1800.0f, WetnessModel::MAX_WETNESS_DEPTH)));
+}
+
+TEST_CASE(TransitionWaitsForPrecipitation)
+{
+	// rain fading in over the last 32/256 of the transition
+	auto fadingRain = rain;
+	fadingRain.precipitationBeginFadeIn = 32.0f;
+	CHECK(WetnessModel::CalculateWeatherTransitionPercentage(0.5f, fadingRain.precipitationBeginFadeIn, true) == 0.0f);
+	CHECK(WetnessModel::CalculateWeatherTransitionPercentage(1.0f, fadingRain.precipitationBeginFadeIn, true) == 1.0f);
+
+	WetnessModel model;
+	auto input = MakeInput(8.0f, fadingRain);
+	input.hasLastWeather = true;
+	input.lastWeather = clear;
+	input.currentWeatherPct = 0.5f;
+	model.Update(input);
+	input.gameTime += 900.0f;
+	model.Update(input);
+	CHECK(model.GetWetnessDepth() == 0.0f);
+	CHECK(model.GetLastWeatherID() == clear.id);
+}
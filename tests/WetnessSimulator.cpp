@@ -0,0 +1,173 @@
+// Replays a weather and game time trace through WetnessModel and prints the wetness after every update as CSV.
+//
+// Trace lines, # starts a comment:
+//   weather <id> <clear|cloudy|rain|snow> <precipitationBeginFadeIn> <precipitationEndFadeOut>
+//   speed <weather transition speed>
+//   frame <game hours> <current weather id> <current weather pct> [<last weather id>]
+//   wait <from hours> <to hours> <step minutes> <current weather id> [<last weather id>]
+//   inactive <game hours>
+// Weather ids are hexadecimal like form ids, a frame with an unknown weather id is an error.
+
+#include "Features/WetnessEffects/WetnessModel.h"
+
+#include <charconv>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+
+namespace
+{
+	struct Simulator
+	{
+		WetnessModel model;
+		std::map<std::uint32_t, WetnessModel::Weather> weathers;
+		float transitionSpeed = 1.0f;
+
+		void Update(float a_hours, const WetnessModel::Input& a_input)
+		{
+			model.Update(a_input);
+			std::printf("%.4f,%X,%X,%.4f,%.4f,%.4f,%.4f\n", a_hours, model.GetCurrentWeatherID(), model.GetLastWeatherID(),
+				model.GetWetness(), model.GetPuddleWetness(), model.GetWetnessDepth(), model.GetPuddleDepth());
+		}
+
+		bool MakeInput(float a_hours, std::uint32_t a_current, float a_currentPct, std::uint32_t a_last, WetnessModel::Input& a_input) const
+		{
+			auto current = weathers.find(a_current);
+			if (current == weathers.end())
+				return false;
+
+			a_input.active = true;
+			a_input.hasGameTime = true;
+			a_input.gameTime = a_hours * 3600.0f;
+			a_input.transitionSpeed = transitionSpeed;
+			a_input.currentWeather = current->second;
+			a_input.currentWeatherPct = a_currentPct;
+			if (a_last) {
+				auto last = weathers.find(a_last);
+				if (last == weathers.end())
+					return false;
+				a_input.hasLastWeather = true;
+				a_input.lastWeather = last->second;
+			}
+			return true;
+		}
+	};
+
+	bool ParseID(const std::string& a_text, std::uint32_t& a_id)
+	{
+		auto result = std::from_chars(a_text.data(), a_text.data() + a_text.size(), a_id, 16);
+		return result.ec == std::errc() && result.ptr == a_text.data() + a_text.size();
+	}
+
+	bool ParsePrecipitation(const std::string& a_text, WetnessModel::Weather& a_weather)
+	{
+		if (a_text == "clear") {
+			a_weather.precipitation = WetnessModel::Precipitation::Clear;
+		} else if (a_text == "cloudy") {
+			a_weather.precipitation = WetnessModel::Precipitation::Cloudy;
+		} else if (a_text == "rain") {
+			a_weather.precipitation = WetnessModel::Precipitation::Rainy;
+			a_weather.rainy = true;
+		} else if (a_text == "snow") {
+			a_weather.precipitation = WetnessModel::Precipitation::Snowy;
+		} else {
+			return false;
+		}
+		return true;
+	}
+
+	bool ParseLine(Simulator& a_simulator, const std::string& a_line)
+	{
+		std::istringstream stream{ a_line.substr(0, a_line.find('#')) };
+		std::string command;
+		if (!(stream >> command))
+			return true;
+
+		if (command == "weather") {
+			std::string id, type;
+			WetnessModel::Weather weather;
+			if (!(stream >> id >> type >> weather.precipitationBeginFadeIn >> weather.precipitationEndFadeOut) || !ParseID(id, weather.id) || !ParsePrecipitation(type, weather))
+				return false;
+			a_simulator.weathers[weather.id] = weather;
+			return true;
+		}
+
+		if (command == "speed")
+			return (bool)(stream >> a_simulator.transitionSpeed);
+
+		if (command == "inactive") {
+			float hours = 0.0f;
+			if (!(stream >> hours))
+				return false;
+			a_simulator.Update(hours, {});
+			return true;
+		}
+
+		std::string current, last;
+		std::uint32_t currentID = 0;
+		std::uint32_t lastID = 0;
+
+		if (command == "frame") {
+			float hours = 0.0f;
+			float pct = 1.0f;
+			if (!(stream >> hours >> current >> pct) || !ParseID(current, currentID))
+				return false;
+			if (stream >> last && !ParseID(last, lastID))
+				return false;
+
+			WetnessModel::Input input;
+			if (!a_simulator.MakeInput(hours, currentID, pct, lastID, input))
+				return false;
+			a_simulator.Update(hours, input);
+			return true;
+		}
+
+		if (command == "wait") {
+			float from = 0.0f;
+			float to = 0.0f;
+			float stepMinutes = 0.0f;
+			if (!(stream >> from >> to >> stepMinutes >> current) || stepMinutes <= 0.0f || !ParseID(current, currentID))
+				return false;
+			if (stream >> last && !ParseID(last, lastID))
+				return false;
+
+			for (float hours = from; hours <= to; hours += stepMinutes / 60.0f) {
+				WetnessModel::Input input;
+				if (!a_simulator.MakeInput(hours, currentID, 1.0f, lastID, input))
+					return false;
+				a_simulator.Update(hours, input);
+			}
+			return true;
+		}
+
+		return false;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	if (argc != 2) {
+		std::fprintf(stderr, "usage: %s <trace>\n", argv[0]);
+		return 2;
+	}
+
+	std::ifstream file{ argv[1] };
+	if (!file) {
+		std::fprintf(stderr, "cannot open %s\n", argv[1]);
+		return 2;
+	}
+
+	Simulator simulator;
+	std::printf("hours,current,last,wetness,puddleWetness,wetnessDepth,puddleDepth\n");
+
+	std::string line;
+	for (std::uint32_t lineNumber = 1; std::getline(file, line); lineNumber++) {
+		if (!ParseLine(simulator, line)) {
+			std::fprintf(stderr, "%s(%u): cannot parse \"%s\"\n", argv[1], lineNumber, line.c_str());
+			return 1;
+		}
+	}
+	return 0;
+}